@@ -19,12 +19,30 @@ g++ -std=c++17 -I./src -I./include -c src/Trie.cpp -o Trie.o
 g++ -std=c++17 -I./src -I./include -c src/SearchEngine.cpp -o SearchEngine.o
 g++ -std=c++17 -I./src -I./include -c src/JsonHandler.cpp -o JsonHandler.o
 g++ -std=c++17 -I./src -I./include -c src/ConsoleInterface.cpp -o ConsoleInterface.o
+g++ -std=c++17 -I./src -I./include -c src/NodeReclaimer.cpp -o NodeReclaimer.o
+g++ -std=c++17 -I./src -I./include -c src/PathCache.cpp -o PathCache.o
+g++ -std=c++17 -I./src -I./include -c src/BufferedOutput.cpp -o BufferedOutput.o
+g++ -std=c++17 -I./src -I./include -c src/DaemonServer.cpp -o DaemonServer.o
+g++ -std=c++17 -I./src -I./include -c src/JobManager.cpp -o JobManager.o
+g++ -std=c++17 -I./src -I./include -c src/TrashBin.cpp -o TrashBin.o
+g++ -std=c++17 -I./src -I./include -c src/OrderLabels.cpp -o OrderLabels.o
+g++ -std=c++17 -I./src -I./include -c src/FuzzyMatcher.cpp -o FuzzyMatcher.o
+g++ -std=c++17 -I./src -I./include -c src/GlobMatcher.cpp -o GlobMatcher.o
+g++ -std=c++17 -I./src -I./include -c src/ContentIndex.cpp -o ContentIndex.o
+g++ -std=c++17 -I./src -I./include -c src/ContentScanner.cpp -o ContentScanner.o
+g++ -std=c++17 -I./src -I./include -c src/SimdSearch.cpp -o SimdSearch.o
+g++ -std=c++17 -I./src -I./include -c src/NameBuffer.cpp -o NameBuffer.o
+g++ -std=c++17 -I./src -I./include -c src/NamePool.cpp -o NamePool.o
+g++ -std=c++17 -I./src -I./include -c src/TreeSnapshot.cpp -o TreeSnapshot.o
+g++ -std=c++17 -I./src -I./include -c src/TreeValidator.cpp -o TreeValidator.o
+g++ -std=c++17 -I./src -I./include -c src/NodeRegistry.cpp -o NodeRegistry.o
+g++ -std=c++17 -I./src -I./include -c src/PathImporter.cpp -o PathImporter.o
 
 echo "Compilando aplicación principal..."
 g++ -std=c++17 -I./src -I./include \
     src/main.cpp \
-    TreeNode.o FileSystemTree.o Trie.o SearchEngine.o JsonHandler.o ConsoleInterface.o \
-    -o arboles_archivados
+    TreeNode.o FileSystemTree.o Trie.o SearchEngine.o JsonHandler.o ConsoleInterface.o NodeReclaimer.o PathCache.o BufferedOutput.o DaemonServer.o JobManager.o TrashBin.o OrderLabels.o FuzzyMatcher.o GlobMatcher.o ContentIndex.o ContentScanner.o SimdSearch.o NameBuffer.o NamePool.o TreeSnapshot.o TreeValidator.o NodeRegistry.o PathImporter.o \
+    -pthread -o arboles_archivados
 
 if [ -f "arboles_archivados" ]; then
     echo "✓ Aplicación principal compilada: arboles_archivados"
@@ -35,8 +53,8 @@ fi
 echo "Compilando pruebas días 5-6..."
 g++ -std=c++17 -I./src -I./include \
     src/main_dia5_6.cpp \
-    TreeNode.o FileSystemTree.o Trie.o SearchEngine.o JsonHandler.o ConsoleInterface.o \
-    -o prueba_dia5_6
+    TreeNode.o FileSystemTree.o Trie.o SearchEngine.o JsonHandler.o ConsoleInterface.o NodeReclaimer.o PathCache.o BufferedOutput.o DaemonServer.o JobManager.o TrashBin.o OrderLabels.o FuzzyMatcher.o GlobMatcher.o ContentIndex.o ContentScanner.o SimdSearch.o NameBuffer.o NamePool.o TreeSnapshot.o TreeValidator.o NodeRegistry.o PathImporter.o \
+    -pthread -o prueba_dia5_6
 
 if [ -f "prueba_dia5_6" ]; then
     echo "✓ Pruebas días 5-6 compiladas: prueba_dia5_6"
@@ -0,0 +1,50 @@
+#include "BufferedOutput.hpp"
+
+using namespace std;
+
+BufferedOutput::BufferedOutput(ostream& out, size_t capacity)
+    : stream(out), target(out.rdbuf()), buffer(capacity > 0 ? capacity : 1), installed(true) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+    stream.rdbuf(this);
+}
+
+BufferedOutput::~BufferedOutput() {
+    release();
+}
+
+// Escribir el contenido acumulado en el destino original
+bool BufferedOutput::writePending() {
+    streamsize pending = pptr() - pbase();
+    if (pending > 0 && target->sputn(pbase(), pending) != pending) {
+        return false;
+    }
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return true;
+}
+
+// Búfer lleno: volcarlo y seguir acumulando
+BufferedOutput::int_type BufferedOutput::overflow(int_type ch) {
+    if (!writePending()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+// endl/flush llegan aquí: se ignoran a propósito hasta release()
+int BufferedOutput::sync() {
+    return 0;
+}
+
+// Vaciar el búfer y devolver el streambuf original al stream
+void BufferedOutput::release() {
+    if (!installed) return;
+
+    writePending();
+    target->pubsync();
+    stream.rdbuf(target);
+    installed = false;
+}
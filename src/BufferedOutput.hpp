@@ -0,0 +1,39 @@
+#ifndef BUFFEREDOUTPUT_HPP
+#define BUFFEREDOUTPUT_HPP
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+using namespace std;
+
+// Salida con búfer grande para el modo por lotes.
+// Se instala sobre un ostream (normalmente cout) y hace que los endl
+// dejen de vaciar la salida: solo se escribe cuando el búfer se llena
+// o cuando se libera explícitamente.
+class BufferedOutput : public streambuf {
+private:
+    ostream& stream;
+    streambuf* target;
+    vector<char> buffer;
+    bool installed;
+
+    // Escribir el contenido acumulado en el destino original
+    bool writePending();
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+public:
+    BufferedOutput(ostream& out, size_t capacity = 1 << 16);
+    ~BufferedOutput();
+
+    BufferedOutput(const BufferedOutput&) = delete;
+    BufferedOutput& operator=(const BufferedOutput&) = delete;
+
+    // Vaciar el búfer y devolver el streambuf original al stream
+    void release();
+};
+
+#endif // BUFFEREDOUTPUT_HPP
@@ -1,4 +1,14 @@
 #include "ConsoleInterface.hpp"
+#include "NodeReclaimer.hpp"
+#include "NamePool.hpp"
+#include "NodeRegistry.hpp"
+#include "BufferedOutput.hpp"
+#include "FuzzyMatcher.hpp"
+#include "GlobMatcher.hpp"
+#include "ContentScanner.hpp"
+#include "SimdSearch.hpp"
+#include "PathImporter.hpp"
+#include "TreeValidator.hpp"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -6,15 +16,27 @@
 #include <chrono>
 #include <random>
 #include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+#include <thread>
+#include <filesystem>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 using namespace std;
 using namespace chrono;
 
 ConsoleInterface::ConsoleInterface() 
-    : fileSystem(make_shared<FileSystemTree>()), 
-      currentPath("/root") {
+    : fileSystem(make_shared<FileSystemTree>()), trashPurged(false),
+      quiet(false), input(&cin), silent(nullptr), asyncJobs(true) {
+    currentDirectory = fileSystem->getRoot();
     searchEngine = make_shared<SearchEngine>(fileSystem);
-    // papelera inicia vacía
+    // papelera inicia vacía; sus purgas se compactan en el índice al
+    // siguiente comando (el aviso llega desde el hilo de la papelera)
+    trash.setPurgeListener([this](size_t) { trashPurged = true; });
 }
 
 void ConsoleInterface::run() {
@@ -25,8 +47,12 @@ void ConsoleInterface::run() {
     
     string command;
     while (true) {
-        cout << currentPath << "> ";
-        getline(cin, command);
+        jobs.reapFinished(cout);
+        ensureCurrentDirectory();
+        cout << fileSystem->getFullPath(currentDirectory) << "> ";
+        if (!getline(*input, command)) {
+            break;
+        }
         
         if (command == "exit" || command == "quit") {
             break;
@@ -37,16 +63,143 @@ void ConsoleInterface::run() {
         }
     }
     
+    size_t running = jobs.runningCount();
+    if (running > 0) {
+        cout << "Cancelando " << running << " trabajo(s) en segundo plano..." << endl;
+        jobs.cancelAll();
+    }
+    
     cout << "Saliendo del sistema..." << endl;
 }
 
+// Modo por lotes: ejecutar comandos seguidos sin prompt y con salida en búfer
+void ConsoleInterface::runScript(istream& script, bool quietMode) {
+    // Al terminar (también ante una excepción) se vuelve al modo anterior
+    struct PreviousMode {
+        ConsoleInterface& console;
+        bool quiet;
+        bool asyncJobs;
+        istream* input;
+        
+        ~PreviousMode() {
+            console.quiet = quiet;
+            console.fileSystem->setVerbose(!quiet);
+            console.asyncJobs = asyncJobs;
+            console.input = input;
+        }
+    } previous = {*this, quiet, asyncJobs, input};
+    
+    quiet = quietMode;
+    fileSystem->setVerbose(!quiet);
+    input = &script;
+    asyncJobs = false;  // Salida determinista: cada comando termina antes del siguiente
+    
+    long long commandCount = 0;
+    auto start = high_resolution_clock::now();
+    
+    {
+        BufferedOutput buffered(cout);
+        
+        string line;
+        while (getline(script, line)) {
+            string command = trim(line);
+            
+            // Líneas vacías y comentarios
+            if (command.empty() || command[0] == '#') {
+                continue;
+            }
+            
+            if (command == "exit" || command == "quit") {
+                break;
+            }
+            
+            processCommand(command);
+            commandCount++;
+        }
+    }
+    
+    auto end = high_resolution_clock::now();
+    duration<double> elapsed = end - start;
+    
+    cout << "\n=== RESUMEN DEL LOTE ===" << endl;
+    cout << "Comandos ejecutados: " << commandCount << endl;
+    cout << "Tiempo total: " << elapsed.count() * 1000 << " ms" << endl;
+    if (elapsed.count() > 0) {
+        cout << "Rendimiento: " << commandCount / elapsed.count() << " comandos/s" << endl;
+    }
+}
+
+// Modo servidor: ejecutar un comando en la sesión indicada y capturar su salida
+string ConsoleInterface::executeCommand(const string& command, int session, shared_ptr<TreeNode>& sessionDirectory,
+                                        PagedSearch& sessionSearch, PendingBatch& sessionBatch) {
+    ostringstream captured;
+    istringstream noInput;  // Sin confirmaciones interactivas en sesiones remotas
+    
+    streambuf* previousOut = cout.rdbuf(captured.rdbuf());
+    streambuf* previousErr = cerr.rdbuf(captured.rdbuf());
+    istream* previousInput = input;
+    input = &noInput;
+    
+    currentDirectory = sessionDirectory;
+    swap(pagedSearch, sessionSearch);
+    swap(pendingBatch, sessionBatch);
+    jobs.setSession(session);
+    
+    try {
+        processCommand(command);
+    } catch (...) {
+        cout << "Error: excepción no controlada" << endl;
+    }
+    
+    jobs.setSession(0);
+    ensureCurrentDirectory();
+    sessionDirectory = currentDirectory;
+    swap(pagedSearch, sessionSearch);
+    swap(pendingBatch, sessionBatch);
+    
+    input = previousInput;
+    cout.rdbuf(previousOut);
+    cerr.rdbuf(previousErr);
+    
+    return captured.str();
+}
+
+void ConsoleInterface::endSession(int session) {
+    jobs.endSession(session);
+}
+
+// Salida de mensajes por operación (se descarta en modo silencioso)
+ostream& ConsoleInterface::chatter() {
+    return quiet ? silent : cout;
+}
+
 void ConsoleInterface::processCommand(const string& command) {
     vector<string> args = parseArguments(command);
     
     if (args.empty()) return;
     
+    jobs.reapFinished(cout);
+    ensureCurrentDirectory();
+    if (trashPurged.exchange(false)) {
+        searchEngine->scheduleCompaction();
+    }
+    
     string cmd = args[0];
     
+    // Con una transacción abierta las modificaciones se encolan
+    if (pendingBatch.open && queueBatchOperation(args)) {
+        return;
+    }
+    
+    // Un trabajo que lee el árbol en vivo (save) impide modificarlo
+    static const vector<string> mutating = {
+        "mkdir", "touch", "mv", "rm", "rename", "restore", "emptytrash",
+        "test-integration", "test-edge"
+    };
+    if (find(mutating.begin(), mutating.end(), cmd) != mutating.end() && treeLockedByJob()) {
+        return;
+    }
+    
     try {
         if (cmd == "help") {
             showHelp();
@@ -70,9 +223,10 @@ void ConsoleInterface::processCommand(const string& command) {
             }
         } else if (cmd == "touch") {
             if (args.size() > 1) {
+                // El contenido es el resto de la línea (varias palabras)
                 string content = "";
-                if (args.size() > 2) {
-                    content = args[2];
+                for (size_t i = 2; i < args.size(); i++) {
+                    content += (i > 2 ? " " : "") + args[i];
                 }
                 createFile(args[1], content);
             } else {
@@ -97,7 +251,11 @@ void ConsoleInterface::processCommand(const string& command) {
                 cout << "Uso: rename <ruta> <nuevo_nombre>" << endl;
             }
         } else if (cmd == "trash") {
-            listTrash();
+            if (args.size() > 1) {
+                configureTrash(args);
+            } else {
+                listTrash();
+            }
         } else if (cmd == "restore") {
             if (args.size() > 1) {
                 restoreFromTrash(args[1]);
@@ -105,13 +263,19 @@ void ConsoleInterface::processCommand(const string& command) {
                 cout << "Uso: restore <nombre>" << endl;
             }
         } else if (cmd == "emptytrash") {
-            emptyTrash();
+            emptyTrash(args.size() > 1 && (args[1] == "-f" || args[1] == "--force"));
+        } else if (cmd == "batch") {
+            batchCommand(args);
         } else if (cmd == "search") {
-            if (args.size() > 1) {
-                searchNodes(args[1]);
-            } else {
-                cout << "Uso: search <consulta>" << endl;
-            }
+            searchCommand(args);
+        } else if (cmd == "find") {
+            findCommand(args);
+        } else if (cmd == "grep") {
+            // Se analiza la línea original: las frases van entre comillas
+            grepCommand(trim(command.substr(command.find("grep") + 4)));
+        } else if (cmd == "scan") {
+            // Los patrones pueden llevar espacios entre comillas
+            scanCommand(trim(command.substr(command.find("scan") + 4)));
         } else if (cmd == "autocomplete") {
             if (args.size() > 1) {
                 autocompleteSuggestions(args[1]);
@@ -129,13 +293,21 @@ void ConsoleInterface::processCommand(const string& command) {
             if (args.size() > 1) {
                 filename = args[1];
             }
-            saveState(filename);
+            saveState(filename, asyncJobs);
         } else if (cmd == "load") {
             string filename = "filesystem.json";
             if (args.size() > 1) {
                 filename = args[1];
             }
-            loadState(filename);
+            loadState(filename, asyncJobs);
+        } else if (cmd == "import") {
+            if (args.size() == 2) {
+                importPaths(args[1], "", asyncJobs);
+            } else if (args.size() == 4 && args[2] == "under") {
+                importPaths(args[1], args[3], asyncJobs);
+            } else {
+                cout << "Uso: import <archivo> [under <ruta>]" << endl;
+            }
         } else if (cmd == "tree") {
             showTree();
         } else if (cmd == "pwd") {
@@ -147,23 +319,62 @@ void ConsoleInterface::processCommand(const string& command) {
         } else if (cmd == "test-integration") {
             runIntegrationTests();
         } else if (cmd == "test-performance") {
-            runPerformanceTests();
+            runPerformanceTests(asyncJobs);
         } else if (cmd == "test-edge") {
             runEdgeCaseTests();
         } else if (cmd == "stats") {
             showSystemStats();
         } else if (cmd == "validate") {
             validateSystem();
+        } else if (cmd == "leaks") {
+            showLeaks();
+        } else if (cmd == "orphans") {
+            if (args.size() > 1 && args[1] != "reclaim") {
+                cout << "Uso: orphans [reclaim]" << endl;
+            } else {
+                showOrphans(args.size() > 1);
+            }
         } else if (cmd == "generate") {
             if (args.size() > 2) {
                 int levels = stoi(args[1]);
                 int children = stoi(args[2]);
-                generateTestTree(levels, children);
+                generateTestTree(levels, children, asyncJobs);
             } else {
                 cout << "Uso: generate <niveles> <hijos_por_nivel>" << endl;
             }
         } else if (cmd == "benchmark") {
-            benchmarkOperations();
+            if (args.size() > 1 && args[1] == "fuzzy") {
+                benchmarkFuzzy(asyncJobs);
+            } else if (args.size() > 1 && args[1] == "grep") {
+                benchmarkGrep(asyncJobs);
+            } else if (args.size() > 1 && args[1] == "scan") {
+                benchmarkScan(asyncJobs);
+            } else if (args.size() > 1 && args[1] == "contains") {
+                benchmarkContains(asyncJobs);
+            } else if (args.size() > 1 && args[1] == "memory") {
+                benchmarkMemory(asyncJobs);
+            } else if (args.size() > 1 && args[1] == "snapshot") {
+                benchmarkSnapshot(asyncJobs);
+            } else {
+                benchmarkOperations(asyncJobs);
+            }
+        } else if (cmd == "jobs") {
+            listJobs();
+        } else if (cmd == "cancel") {
+            if (args.size() > 1) {
+                cancelJob(args[1]);
+            } else {
+                cout << "Uso: cancel <id>" << endl;
+            }
+        } else if (cmd == "wait") {
+            waitJobs(args.size() > 1 ? args[1] : "");
+        } else if (cmd == "echo") {
+            // Útil en scripts: imprimir el resto de la línea sin comillas
+            string text = trim(command.substr(command.find("echo") + 4));
+            if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+                text = text.substr(1, text.size() - 2);
+            }
+            cout << text << endl;
         } else {
             cout << "Comando no reconocido: " << cmd << endl;
             cout << "Escriba 'help' para ver los comandos disponibles." << endl;
@@ -184,17 +395,34 @@ void ConsoleInterface::showHelp() {
     cout << "  rm <ruta>            - Eliminar nodo (mueve a papelera)" << endl;
     cout << "  rename <ruta> <nuevo> - Renombrar nodo" << endl;
     cout << "  search <consulta>    - Buscar nodos por nombre" << endl;
+    cout << "  search <c> under <ruta> - Buscar solo dentro de un directorio" << endl;
+    cout << "  search <c> --limit N [--offset N] - Paginar resultados" << endl;
+    cout << "  search --next        - Siguiente página de la última búsqueda" << endl;
+    cout << "  search ~<nombre> [--distance 1|2] - Búsqueda tolerante a errores" << endl;
+    cout << "  search <patrón>      - Comodines: '*' cualquier texto, '?' un carácter" << endl;
+    cout << "  search *<texto>* [--ignore-case] - Nombres que contienen el texto" << endl;
+    cout << "  find <patrón> [--limit N] - Rutas con comodines (*, ?, **)" << endl;
+    cout << "  grep <consulta> [under <ruta>] [--limit N] - Buscar en el contenido" << endl;
+    cout << "                       (palabras = AND, \"frase exacta\", OR)" << endl;
+    cout << "  scan <patrón>... [under <ruta>] [--limit N] [--threads N] - Buscar texto" << endl;
+    cout << "                       literal en el contenido sin índice (en paralelo)" << endl;
     cout << "  autocomplete <prefijo> - Sugerencias de autocompletado" << endl;
     cout << "  export <archivo>     - Exportar recorrido preorden" << endl;
     cout << "  save [archivo]       - Guardar estado en JSON" << endl;
     cout << "  load [archivo]       - Cargar estado desde JSON" << endl;
+    cout << "  import <archivo> [under <ruta>] - Crear el árbol desde una lista de rutas" << endl;
+    cout << "                       (una por línea; under: añadirlas a un directorio)" << endl;
     cout << "  tree                 - Mostrar estructura completa" << endl;
     cout << "  pwd                  - Mostrar ruta actual" << endl;
     
     cout << "\nPapelera:" << endl;
     cout << "  trash                - Mostrar papelera temporal" << endl;
-    cout << "  restore <nombre>     - Restaurar elemento de papelera" << endl;
-    cout << "  emptytrash           - Vaciar papelera permanentemente" << endl;
+    cout << "  trash stats          - Estadísticas, cuotas y caducidad de la papelera" << endl;
+    cout << "  trash ttl <seg>      - Caducidad de los elementos (0 = nunca)" << endl;
+    cout << "  trash quota <n> <MB> - Máximo de elementos y de memoria residente" << endl;
+    cout << "  trash spill <nodos>  - Volcar a disco subárboles desde ese tamaño (0 = no)" << endl;
+    cout << "  restore <nombre|#id> - Restaurar elemento de papelera" << endl;
+    cout << "  emptytrash [-f]      - Vaciar papelera permanentemente (-f sin confirmar)" << endl;
     
     cout << "\nPruebas (Días 10-11):" << endl;
     cout << "  test-integration     - Ejecutar pruebas de integración" << endl;
@@ -202,14 +430,58 @@ void ConsoleInterface::showHelp() {
     cout << "  test-edge            - Ejecutar pruebas de casos límite" << endl;
     cout << "  stats                - Mostrar estadísticas del sistema" << endl;
     cout << "  validate             - Validar consistencia del sistema" << endl;
+    cout << "  leaks                - Memoria retenida por nodos fuera del árbol y de la papelera" << endl;
+    cout << "  orphans [reclaim]    - Subárboles desconectados (reclaim: liberarlos)" << endl;
     cout << "  generate <n> <h>     - Generar árbol de prueba" << endl;
     cout << "  benchmark            - Medir rendimiento de operaciones" << endl;
+    cout << "  benchmark fuzzy      - Medir la búsqueda aproximada sobre 1M de nombres" << endl;
+    cout << "  benchmark grep       - Medir la búsqueda en contenido sobre 1M de archivos" << endl;
+    cout << "  benchmark scan       - Medir el escaneo en paralelo sobre 256 MB de contenido" << endl;
+    cout << "  benchmark contains   - Medir la búsqueda de subcadenas sobre 1M de nombres" << endl;
+    cout << "  benchmark memory     - Medir los bytes por nodo en un árbol con muchos archivos" << endl;
+    cout << "  benchmark snapshot   - Comparar estadísticas sobre la instantánea plana y sobre punteros" << endl;
+    cout << "  echo <texto>         - Imprimir texto (útil en scripts)" << endl;
+    
+    cout << "\nTransacciones:" << endl;
+    cout << "  batch begin          - Encolar mkdir, touch, mv, rm y rename en lugar de aplicarlos" << endl;
+    cout << "  batch [status]       - Mostrar las operaciones encoladas" << endl;
+    cout << "  batch commit         - Aplicarlas todas o ninguna (un solo cambio de índice)" << endl;
+    cout << "  batch abort          - Descartar la transacción" << endl;
+    
+    cout << "\nTrabajos en segundo plano (generate, save, load, test-performance, benchmark):" << endl;
+    cout << "  jobs                 - Listar trabajos y su progreso" << endl;
+    cout << "  cancel <id>          - Cancelar un trabajo" << endl;
+    cout << "  wait [id]            - Esperar a un trabajo (o a todos)" << endl;
     
     cout << "\nSistema:" << endl;
     cout << "  help                 - Mostrar esta ayuda" << endl;
     cout << "  exit                 - Salir del sistema" << endl;
     cout << "=========================\n" << endl;
 }
+namespace {
+    // Comprobación de las pruebas: muestra el resultado y cuenta los fallos
+    void check(bool ok, const string& description, int& failures) {
+        cout << (ok ? "   ✓ " : "   ✗ FALLO: ") << description << endl;
+        if (!ok) failures++;
+    }
+    
+    // Rutas e IDs del árbol en preorden, para comparar dos estados
+    vector<string> describeTree(FileSystemTree& tree) {
+        vector<string> lines;
+        vector<shared_ptr<TreeNode>> pending = {tree.getRoot()};
+        while (!pending.empty()) {
+            auto node = pending.back();
+            pending.pop_back();
+            lines.push_back(tree.getFullPath(node) + "#" + to_string(node->id));
+            const auto& children = node->getChildren();
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                pending.push_back(*it);
+            }
+        }
+        return lines;
+    }
+}
+
 void ConsoleInterface::runIntegrationTests() {
     cout << "\n=== PRUEBAS DE INTEGRACIÓN ===" << endl;
     
@@ -257,55 +529,322 @@ void ConsoleInterface::runIntegrationTests() {
     restoreFromTrash("test1.txt");
     cout << "✓ Papelera funcionando correctamente." << endl;
     
-    cout << "\n=== PRUEBAS DE INTEGRACIÓN COMPLETADAS ===" << endl;
-}
-
-void ConsoleInterface::runPerformanceTests() {
-    cout << "\n=== PRUEBAS DE RENDIMIENTO ===" << endl;
-    
-    // Guardar estado actual
-    auto originalTree = fileSystem;
-    auto originalSearch = searchEngine;
-    
-    // Crear árbol grande
-    cout << "1. Generando árbol grande para pruebas..." << endl;
-    fileSystem = make_shared<FileSystemTree>();
-    searchEngine = make_shared<SearchEngine>(fileSystem);
-    
-    fileSystem->generateLargeTree(4, 3); // 4 niveles, 3 hijos por nivel
-    int totalNodes = fileSystem->calculateSize();
-    cout << "   Árbol creado con " << totalNodes << " nodos." << endl;
-    
-    // Medir recorrido
-    cout << "\n2. Mediendo tiempo de recorrido..." << endl;
-    double traversalTime = fileSystem->measureTraversalTime();
-    cout << "   Tiempo de recorrido preorden: " << traversalTime * 1000 << " ms" << endl;
-    cout << "   Tiempo por nodo: " << (traversalTime / totalNodes) * 1000000 << " μs" << endl;
+    int failures = 0;
     
-    // Medir búsqueda
-    cout << "\n3. Mediendo tiempo de búsqueda..." << endl;
-    double searchTime = fileSystem->measureSearchTime("nodo");
-    cout << "   Tiempo de búsqueda: " << searchTime * 1000 << " ms" << endl;
+    // Test 8: Importar rutas bajo una carpeta que no es la raíz
+    cout << "\n8. Probando importación de rutas desordenadas y repetidas..." << endl;
+    {
+        FileSystemTree tree;
+        tree.setVerbose(false);
+        auto project = tree.createNode(tree.getRoot(), "proj", NodeType::FOLDER);
+        tree.createNode(project, "readme", NodeType::FILE, "no es una carpeta");
+        
+        istringstream list(
+            "src/b.txt\n"
+            "src/a.txt\n"
+            "lib/\n"
+            "src/a.txt\n"        // Repetida
+            "docs/guia.txt\n"
+            "src/\n"             // Carpeta que ya existe
+            "readme/x.txt\n"     // Atraviesa un archivo previo: rechazada
+            "z/y\n"
+            "z\n"
+            "tmp\n"
+            "otro.txt\n"
+            "tmp/dentro.txt\n"   // tmp se creó como archivo: se convierte en carpeta
+            "../fuera.txt\n");   // Rechazada
+        auto stats = PathImporter::import(tree, project, list);
+        
+        vector<string> paths;
+        for (const string& line : describeTree(tree)) {
+            paths.push_back(line.substr(0, line.find('#')));
+        }
+        sort(paths.begin(), paths.end());
+        vector<string> expected = {
+            "/root", "/root/proj", "/root/proj/docs", "/root/proj/docs/guia.txt", "/root/proj/lib",
+            "/root/proj/otro.txt", "/root/proj/readme", "/root/proj/src", "/root/proj/src/a.txt",
+            "/root/proj/src/b.txt", "/root/proj/tmp", "/root/proj/tmp/dentro.txt", "/root/proj/z",
+            "/root/proj/z/y"
+        };
+        check(paths == expected, "Rutas importadas bajo /root/proj", failures);
+        check(stats.rejected == 2 && stats.existing == 3 && stats.promoted == 1,
+              "Rechazadas " + to_string(stats.rejected) + ", existentes " + to_string(stats.existing) +
+              ", convertidas " + to_string(stats.promoted), failures);
+        
+        auto report = TreeValidator::validate(tree.getRoot(), tree.getNextId());
+        check(report.valid() && report.count(TreeValidator::IssueType::DUPLICATE_NAME) == 0,
+              "Sin nombres repetidos y con etiquetas válidas", failures);
+        auto tmp = tree.findNodeByPath("/root/proj/tmp");
+        auto y = tree.findNodeByPath("/root/proj/z/y");
+        auto readme = tree.findNodeByPath("/root/proj/readme");
+        check(tmp && tmp->isFolder() && y && y->isFile() && readme && readme->isFile(),
+              "Tipos de nodo según la lista", failures);
+        
+        // En una carpeta nueva que recibe los hijos en orden no se buscan duplicados
+        istringstream sorted("m/a\nm/b\nm/c\n");
+        auto sortedStats = PathImporter::import(tree, project, sorted);
+        check(sortedStats.created() == 4 && sortedStats.uncheckedCreates == 3 && sortedStats.reusedComponents == 2,
+              "Lista ordenada resuelta con la pila de la línea anterior", failures);
+    }
     
-    // Medir operaciones de creación
-    cout << "\n4. Mediendo operaciones de creación..." << endl;
-    auto start = high_resolution_clock::now();
+    // Test 9: Búsqueda paginada con cambios y compactación entre páginas
+    cout << "\n9. Probando búsqueda paginada con cambios entre páginas..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        vector<shared_ptr<TreeNode>> folders;
+        for (int d = 0; d < 30; d++) {
+            folders.push_back(tree->createNode(tree->getRoot(), "d" + to_string(d), NodeType::FOLDER));
+        }
+        // Cada nombre se repite en las 30 carpetas
+        set<int> initial;
+        for (int i = 0; i < 3000; i++) {
+            initial.insert(tree->createNode(folders[i % 30], "file" + to_string(i / 30), NodeType::FILE)->id);
+        }
+        SearchEngine engine(tree);
+        
+        SearchEngine::Cursor cursor;
+        vector<int> returned;
+        set<int> deleted;
+        set<int> expectedNew;
+        bool stale = false;
+        for (int page = 0; !cursor.exhausted; page++) {
+            for (const auto& node : engine.searchByPrefixPage("file", 50, cursor)) {
+                returned.push_back(node->id);
+                if (deleted.count(node->id)) stale = true;
+            }
+            if (page >= 10 || cursor.exhausted) continue;
+            
+            // Eliminar una carpeta y liberarla: la compactación purga sus IDs
+            // de las listas que recorre el cursor
+            for (const auto& child : folders[page]->getChildren()) {
+                deleted.insert(child->id);
+            }
+            tree->deleteNode(folders[page]);
+            engine.markDeleted(folders[page]);
+            folders[page].reset();
+            NodeReclaimer::instance().drain();
+            engine.scheduleCompaction();
+            engine.drainCompaction();
+            
+            // Un nombre nuevo que aún no se ha recorrido debe aparecer
+            string name = "file" + to_string((page * 37) % 100);
+            auto created = tree->createNode(folders[29], name + "_" + to_string(page), NodeType::FILE);
+            engine.indexNode(created);
+            if (created->getName() > cursor.name) expectedNew.insert(created->id);
+        }
+        
+        set<int> unique(returned.begin(), returned.end());
+        size_t skipped = 0;
+        for (int id : initial) {
+            if (!deleted.count(id) && !unique.count(id)) skipped++;
+        }
+        for (int id : expectedNew) {
+            if (!unique.count(id)) skipped++;
+        }
+        check(unique.size() == returned.size(), "Sin resultados repetidos (" + to_string(returned.size()) + ")",
+              failures);
+        check(skipped == 0, "Sin resultados saltados", failures);
+        check(!stale, "Ningún resultado de una carpeta ya eliminada", failures);
+    }
     
-    for (int i = 0; i < 100; i++) {
-        string name = "perf_test_" + to_string(i);
-        fileSystem->createNode("/root", name, NodeType::FILE);
+    // Test 10: Papelera volcada a disco, restaurada y caducada
+    cout << "\n10. Probando volcado de la papelera a disco..." << endl;
+    {
+        FileSystemTree tree;
+        tree.setVerbose(false);
+        auto build = [&tree](const string& name) {
+            auto folder = tree.createNode(tree.getRoot(), name, NodeType::FOLDER);
+            tree.createNode(folder, "a.txt", NodeType::FILE, "uno");
+            auto sub = tree.createNode(folder, "sub", NodeType::FOLDER);
+            tree.createNode(sub, "b.txt", NodeType::FILE, "dos\ncon salto de línea");
+            tree.createNode(sub, "vacia", NodeType::FOLDER);
+            return folder;
+        };
+        // Nombres, IDs, tipos y contenido del subárbol en preorden
+        auto contents = [](shared_ptr<TreeNode> root) {
+            vector<string> lines;
+            vector<shared_ptr<TreeNode>> pending = {root};
+            while (!pending.empty()) {
+                auto node = pending.back();
+                pending.pop_back();
+                lines.push_back(node->getName() + "#" + to_string(node->id) + (node->isFolder() ? "/" : ":") +
+                                node->getContent());
+                const auto& children = node->getChildren();
+                for (auto it = children.rbegin(); it != children.rend(); ++it) pending.push_back(*it);
+            }
+            return lines;
+        };
+        
+        TrashBin bin;
+        atomic<size_t> purgedItems(0);
+        bin.setPurgeListener([&purgedItems](size_t count) { purgedItems += count; });
+        bin.setSpillThreshold(1);
+        
+        // El hilo de la papelera vuelca en segundo plano: esperar a que lo haga
+        auto waitFor = [](const function<bool()>& done) {
+            for (int i = 0; i < 500 && !done(); i++) this_thread::sleep_for(milliseconds(10));
+            return done();
+        };
+        auto spilled = [&bin]() {
+            auto items = bin.items();
+            return all_of(items.begin(), items.end(), [](const TrashBin::ItemInfo& item) { return item.spilled; });
+        };
+        
+        auto first = build("guardada");
+        auto expected = contents(first);
+        int firstId = first->id;
+        tree.deleteNode(first);
+        bin.add(first, tree.getRoot(), "/root/guardada");
+        first.reset();
+        check(waitFor(spilled), "Subárbol volcado a disco", failures);
+        
+        auto restored = bin.take(firstId);
+        check(restored && contents(restored) == expected, "Restaurado con nombres, IDs y contenido", failures);
+        
+        auto second = build("caduca");
+        int secondId = second->id;
+        tree.deleteNode(second);
+        bin.add(second, tree.getRoot(), "/root/caduca");
+        second.reset();
+        string spillFile = (filesystem::temp_directory_path() /
+                            ("arboles_papelera_" + to_string(getpid())) / (to_string(secondId) + ".bin")).string();
+        bool secondSpilled = waitFor(spilled) && filesystem::exists(spillFile);
+        bin.setTtl(1);
+        check(secondSpilled && waitFor([&bin]() { return bin.empty(); }) && purgedItems == 1,
+              "Elemento volcado caducado y purgado", failures);
+        check(!filesystem::exists(spillFile), "Archivo de volcado borrado", failures);
     }
     
-    auto end = high_resolution_clock::now();
-    duration<double> elapsed = end - start;
-    cout << "   Tiempo para crear 100 archivos: " << elapsed.count() * 1000 << " ms" << endl;
-    cout << "   Tiempo por operación: " << (elapsed.count() / 100) * 1000 << " ms" << endl;
+    // Test 11: Búsqueda tolerante a errores
+    cout << "\n11. Probando búsqueda aproximada..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        auto docs = tree->createNode(tree->getRoot(), "docs", NodeType::FOLDER);
+        auto others = tree->createNode(tree->getRoot(), "otros", NodeType::FOLDER);
+        for (const char* name : {"informe.txt", "xinforme.txt", "infrme.txt", "informa.txt", "inform.txt",
+                                 "nforme.tx", "infrma.txt", "memoria.txt"}) {
+            tree->createNode(docs, name, NodeType::FILE);
+        }
+        tree->createNode(others, "informe.txt", NodeType::FILE);
+        SearchEngine engine(tree);
+        
+        // Nombre y distancia de cada resultado
+        auto describe = [](const vector<SearchEngine::FuzzyMatch>& matches) {
+            vector<string> lines;
+            for (const auto& match : matches) {
+                lines.push_back(match.node->getName() + ":" + to_string(match.distance));
+            }
+            return lines;
+        };
+        
+        vector<string> expected = {"informe.txt:0", "informe.txt:0", "inform.txt:1", "informa.txt:1",
+                                   "infrme.txt:1", "xinforme.txt:1", "infrma.txt:2", "nforme.tx:2"};
+        check(describe(engine.searchFuzzy("informe.txt", 2)) == expected,
+              "Distancia 2: por distancia y, a igual distancia, por nombre", failures);
+        expected.resize(6);
+        check(describe(engine.searchFuzzy("informe.txt", 1)) == expected,
+              "Distancia 1: sin los nombres a distancia 2", failures);
+        auto scoped = engine.searchFuzzy("informe.txt", 1, docs);
+        check(scoped.size() == 5 && all_of(scoped.begin(), scoped.end(), [&](const SearchEngine::FuzzyMatch& match) {
+                  return match.node->parent.lock() == docs;
+              }), "Con scope solo resultados bajo /root/docs", failures);
+    }
     
-    // Restaurar estado original
-    fileSystem = originalTree;
-    searchEngine = originalSearch;
+    // Test 12: Búsqueda con comodines por el prefijo y por el sufijo
+    cout << "\n12. Probando búsqueda con comodines..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        auto docs = tree->createNode(tree->getRoot(), "docs", NodeType::FOLDER);
+        auto others = tree->createNode(tree->getRoot(), "otros", NodeType::FOLDER);
+        for (const char* name : {"reporte.docx", "resumen.docx", "repaso.txt", "notas.docx", "rep.docx",
+                                 "reportes.pdf"}) {
+            tree->createNode(docs, name, NodeType::FILE);
+        }
+        tree->createNode(others, "report.docx", NodeType::FILE);
+        SearchEngine engine(tree);
+        
+        auto names = [](const vector<shared_ptr<TreeNode>>& nodes) {
+            vector<string> result;
+            for (const auto& node : nodes) result.push_back(node->getName());
+            return result;
+        };
+        
+        check(names(engine.searchGlob("*.docx")) ==
+              vector<string>({"notas.docx", "rep.docx", "report.docx", "reporte.docx", "resumen.docx"}),
+              "Por el sufijo (*.docx), en orden de nombre", failures);
+        check(names(engine.searchGlob("rep*")) ==
+              vector<string>({"rep.docx", "repaso.txt", "report.docx", "reporte.docx", "reportes.pdf"}),
+              "Por el prefijo (rep*), en orden de nombre", failures);
+        check(names(engine.searchGlob("r?p*.docx")) == vector<string>({"rep.docx", "report.docx", "reporte.docx"}),
+              "Sufijo con '?' en el prefijo (r?p*.docx)", failures);
+        check(names(engine.searchGlob("repo*x")) == vector<string>({"report.docx", "reporte.docx"}),
+              "Prefijo con texto fijo al final (repo*x)", failures);
+        check(names(engine.searchGlob("*.docx", docs)) ==
+              vector<string>({"notas.docx", "rep.docx", "reporte.docx", "resumen.docx"}),
+              "Con scope solo resultados bajo /root/docs", failures);
+    }
     
-    cout << "\n=== PRUEBAS DE RENDIMIENTO COMPLETADAS ===" << endl;
+    if (failures > 0) {
+        cout << "\n✗ " << failures << " comprobación(es) fallida(s)" << endl;
+    }
+    cout << "\n=== PRUEBAS DE INTEGRACIÓN COMPLETADAS ===" << endl;
+}
+
+void ConsoleInterface::runPerformanceTests(bool background) {
+    // Se mide sobre un árbol propio: el trabajo no toca el estado de la consola
+    jobs.submit("test-performance", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== PRUEBAS DE RENDIMIENTO ===" << endl;
+        
+        auto perfTree = make_shared<FileSystemTree>();
+        perfTree->setVerbose(false);
+        
+        // Crear árbol grande
+        out << "1. Generando árbol grande para pruebas..." << endl;
+        control.setPhase("generando");
+        perfTree->generateLargeTree(4, 3, &control); // 4 niveles, 3 hijos por nivel
+        int totalNodes = perfTree->calculateSize();
+        out << "   Árbol creado con " << totalNodes << " nodos." << endl;
+        
+        // Medir recorrido
+        out << "\n2. Mediendo tiempo de recorrido..." << endl;
+        control.setPhase("recorrido");
+        control.setTotal(totalNodes);
+        double traversalTime = perfTree->measureTraversalTime(&control);
+        out << "   Tiempo de recorrido preorden: " << traversalTime * 1000 << " ms" << endl;
+        out << "   Tiempo por nodo: " << (traversalTime / totalNodes) * 1000000 << " μs" << endl;
+        
+        // Medir búsqueda
+        out << "\n3. Mediendo tiempo de búsqueda..." << endl;
+        control.setPhase("búsqueda");
+        control.setTotal(totalNodes);
+        double searchTime = perfTree->measureSearchTime("nodo", &control);
+        out << "   Tiempo de búsqueda: " << searchTime * 1000 << " ms" << endl;
+        
+        // Medir operaciones de creación
+        out << "\n4. Mediendo operaciones de creación..." << endl;
+        control.setPhase("creación");
+        control.setTotal(100);
+        auto start = high_resolution_clock::now();
+        
+        for (int i = 0; i < 100; i++) {
+            control.checkpoint();
+            string name = "perf_test_" + to_string(i);
+            perfTree->createNode("/root", name, NodeType::FILE);
+            control.advance();
+        }
+        
+        auto end = high_resolution_clock::now();
+        duration<double> elapsed = end - start;
+        out << "   Tiempo para crear 100 archivos: " << elapsed.count() * 1000 << " ms" << endl;
+        out << "   Tiempo por operación: " << (elapsed.count() / 100) * 1000 << " ms" << endl;
+        
+        out << "\n=== PRUEBAS DE RENDIMIENTO COMPLETADAS ===" << endl;
+        return nullptr;
+    }, background);
 }
 
 void ConsoleInterface::runEdgeCaseTests() {
@@ -359,6 +898,143 @@ void ConsoleInterface::runEdgeCaseTests() {
         cout << "   ✓ Correctamente manejado: " << e.what() << endl;
     }
     
+    int failures = 0;
+    
+    cout << "\n8. Añadiendo documentos entre tramos de una purga de contenido..." << endl;
+    {
+        ContentIndex index;
+        for (int id = 0; id < 10; id++) {
+            index.addDocument(id, "alfa beta doc" + to_string(id));
+        }
+        index.removeDocument(3);
+        index.beginPurge([](int) { return false; });
+        
+        // El ID nuevo queda fuera de las marcas de la purga en curso
+        bool added = false;
+        while (!index.purgeStep(1)) {
+            if (!added) {
+                index.addDocument(5000, "alfa nuevo");
+                added = true;
+            }
+        }
+        
+        vector<int> expected = {0, 1, 2, 4, 5, 6, 7, 8, 9, 5000};
+        check(index.search(ContentIndex::parseQuery("alfa")) == expected,
+              "La purga conserva el documento añadido entre tramos", failures);
+        check(index.search(ContentIndex::parseQuery("doc3")).empty(), "El documento retirado se purgó", failures);
+        check(index.documents() == expected.size(), "Documentos indexados: " + to_string(index.documents()),
+              failures);
+    }
+    
+    cout << "\n9. Transacción cuya última operación falla..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        auto docs = tree->createNode(tree->getRoot(), "docs", NodeType::FOLDER);
+        auto a = tree->createNode(docs, "a.txt", NodeType::FILE, "alfa");
+        auto b = tree->createNode(docs, "b.txt", NodeType::FILE, "beta");
+        auto old = tree->createNode(tree->getRoot(), "old", NodeType::FOLDER);
+        auto x = tree->createNode(tree->getRoot(), "x.txt", NodeType::FILE);
+        SearchEngine engine(tree);
+        
+        // Con la caché de rutas ya poblada
+        for (const char* path : {"/root/docs/a.txt", "/root/docs/b.txt", "/root/old", "/root/x.txt"}) {
+            tree->findNodeByPath(path);
+        }
+        auto before = describeTree(*tree);
+        int nextId = tree->getNextId();
+        
+        FileSystemTree::Batch batch;
+        batch.create("/root/docs", "nuevo.txt", NodeType::FILE);
+        batch.rename("/root/docs/a.txt", "c.txt");
+        batch.move("/root/x.txt", "/root/old");
+        batch.remove("/root/docs/b.txt");
+        batch.move("/root/no_existe", "/root/old");
+        bool rejected = false;
+        try {
+            tree->commit(batch);
+        } catch (const invalid_argument& e) {
+            rejected = true;
+            cout << "   Rechazada: " << e.what() << endl;
+        }
+        
+        check(rejected, "La transacción se rechaza", failures);
+        check(describeTree(*tree) == before && tree->getNextId() == nextId,
+              "Árbol e IDs como antes de la transacción", failures);
+        check(TreeValidator::validate(tree->getRoot(), tree->getNextId()).valid(),
+              "Estructura y etiquetas válidas", failures);
+        check(tree->findNodeByPath("/root/docs/a.txt") == a && tree->findNodeByPath("/root/docs/b.txt") == b &&
+              tree->findNodeByPath("/root/x.txt") == x && tree->findNodeByPath("/root/old") == old,
+              "La caché de rutas resuelve los nodos originales", failures);
+        check(!tree->findNodeByPath("/root/docs/c.txt") && !tree->findNodeByPath("/root/old/x.txt") &&
+              !tree->findNodeByPath("/root/docs/nuevo.txt"),
+              "Las rutas de la transacción no existen", failures);
+        check(engine.searchExact("a.txt").size() == 1 && engine.searchExact("b.txt").size() == 1 &&
+              engine.searchExact("c.txt").empty() && engine.searchExact("nuevo.txt").empty() &&
+              engine.searchByPrefix("x", old).empty(),
+              "El índice de búsqueda no cambia", failures);
+    }
+    
+    cout << "\n10. find desde una carpeta ya eliminada..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        auto gone = tree->createNode(tree->getRoot(), "gone", NodeType::FOLDER);
+        // Más nodos de los que explora la sonda descendente
+        for (int i = 0; i < 1100; i++) {
+            tree->createNode(gone, "f" + to_string(i) + ".dat", NodeType::FILE);
+        }
+        auto sub = tree->createNode(gone, "sub", NodeType::FOLDER);
+        auto kept = tree->createNode(sub, "k.pdf", NodeType::FILE);
+        SearchEngine engine(tree);
+        tree->deleteNode(gone);
+        
+        // Nodos nuevos que pueden recibir etiquetas dentro del rango viejo
+        vector<shared_ptr<TreeNode>> fresh;
+        for (int i = 0; i < 8; i++) {
+            fresh.push_back(tree->createNode(tree->getRoot(), "n" + to_string(i) + ".pdf", NodeType::FILE));
+        }
+        
+        FileSystemTree::PatternStats stats;
+        auto results = tree->findByPattern("**/*.pdf", gone,
+            [&fresh](const string&) { return fresh; }, &stats);
+        check(results.size() == 1 && results[0] == kept, "Solo el PDF del subárbol eliminado", failures);
+        check(!stats.bottomUp, "No se usan las etiquetas de una base separada", failures);
+    }
+    
+    cout << "\n11. Generación de árbol cancelada a medias..." << endl;
+    {
+        auto tree = make_shared<FileSystemTree>();
+        tree->setVerbose(false);
+        auto docs = tree->createNode(tree->getRoot(), "docs", NodeType::FOLDER);
+        tree->createNode(docs, "a.txt", NodeType::FILE);
+        tree->calculateSize();  // Instantánea del árbol anterior ya construida
+        
+        // Cancelar en cuanto haya nodos generados
+        JobControl control;
+        thread canceller([&control]() {
+            while (control.getCompleted() < 1000) this_thread::yield();
+            control.requestCancel();
+        });
+        bool cancelled = false;
+        try {
+            tree->generateLargeTree(6, 10, &control);
+        } catch (const JobCancelled&) {
+            cancelled = true;
+        }
+        canceller.join();
+        
+        size_t generated = describeTree(*tree).size();
+        check(cancelled && generated > 1000, "La generación se interrumpe a medias", failures);
+        check(TreeValidator::validate(tree->getRoot(), tree->getNextId()).valid(),
+              "Lo generado queda con etiquetas válidas", failures);
+        check(static_cast<size_t>(tree->calculateSize()) == generated,
+              "La instantánea refleja el árbol interrumpido", failures);
+    }
+    
+    if (failures > 0) {
+        cout << "\n✗ " << failures << " comprobación(es) fallida(s)" << endl;
+    }
     cout << "\n=== PRUEBAS DE CASOS LÍMITE COMPLETADAS ===" << endl;
 }
 
@@ -372,7 +1048,19 @@ void ConsoleInterface::showSystemStats() {
     searchEngine->printIndexStats();
     
     // Estadísticas de la papelera
-    cout << "Papelera: " << trashBin.size() << " elementos" << endl;
+    trash.printStats();
+    
+    // Estadísticas de la caché de rutas
+    fileSystem->printPathCacheStats();
+    
+    // Estadísticas del recolector diferido
+    NodeReclaimer::instance().printStats();
+    
+    // Nombres compartidos por todos los árboles del proceso
+    NamePool::instance().printStats();
+    
+    // Nodos vivos de todo el proceso
+    NodeRegistry::instance().printStats();
     
     // Memoria aproximada
     int totalNodes = fileSystem->calculateSize();
@@ -401,217 +1089,1305 @@ void ConsoleInterface::validateSystem() {
     cout << "\n=== VALIDACIÓN COMPLETADA ===" << endl;
 }
 
-void ConsoleInterface::generateTestTree(int levels, int children) {
-    cout << "\nGenerando árbol de prueba..." << endl;
-    cout << "Niveles: " << levels << ", Hijos por nivel: " << children << endl;
-    
-    fileSystem->generateLargeTree(levels, children);
-    
-    cout << "Árbol generado exitosamente." << endl;
-    showSystemStats();
+// Helper: censo del registro con el árbol actual y la papelera residente
+NodeRegistry::Census ConsoleInterface::takeCensus() {
+    // Lo que espera en el recolector ya está en camino de liberarse
+    NodeReclaimer::instance().drain();
+    return NodeRegistry::instance().census({fileSystem->getRoot()}, trash.residentRoots());
 }
 
-void ConsoleInterface::benchmarkOperations() {
-    cout << "\n=== BENCHMARK DE OPERACIONES ===" << endl;
-    
-    vector<pair<string, std::function<void()>>> operations;
-    
-    // Agregar operaciones al vector
-    operations.push_back({"Crear 100 archivos", [&]() {
-        for (int i = 0; i < 100; i++) {
-            createFile("bench_" + to_string(i) + ".txt", "contenido");
-        }
-    }});
-    
-    operations.push_back({"Crear 50 carpetas", [&]() {
-        for (int i = 0; i < 50; i++) {
-            makeDirectory("bench_dir_" + to_string(i));
-        }
-    }});
-    
-    operations.push_back({"Listar directorio", [&]() {
-        listDirectory();
-    }});
-    
-    operations.push_back({"Búsqueda por prefijo", [&]() {
-        searchNodes("bench");
-    }});
-    
-    operations.push_back({"Recorrido completo", [&]() {
-        fileSystem->preorderTraversal();
-    }});
-    
-    for (auto& operation : operations) {
-        auto start = high_resolution_clock::now();
-        
-        try {
-            operation.second();  // Ejecutar la función
-        } catch (const exception& e) {
-            cout << "Error durante " << operation.first << ": " << e.what() << endl;
-        }
-        
-        auto end = high_resolution_clock::now();
-        duration<double> elapsed = end - start;
-        
-        cout << operation.first << ": " << elapsed.count() * 1000 << " ms" << endl;
+void ConsoleInterface::showLeaks() {
+    // Los trabajos llenan sus árboles a medio construir en otro hilo: el
+    // censo no puede recorrerlos mientras tanto
+    if (jobs.runningCount() > 0) {
+        cout << "Error: hay trabajos en curso; espere con 'wait' antes de hacer el censo." << endl;
+        return;
     }
     
-    cout << "\n=== BENCHMARK COMPLETADO ===" << endl;
-}
-void ConsoleInterface::changeDirectory(const string& path) {
-    string absPath = getAbsolutePath(path);
-    auto node = fileSystem->findNodeByPath(absPath);
-    
-    if (node && node->isFolder()) {
-        currentPath = absPath;
-        cout << "Directorio cambiado a: " << currentPath << endl;
-    } else {
-        cout << "Error: Directorio no encontrado o no es una carpeta" << endl;
+    auto census = takeCensus();
+    auto kib = [](long long bytes) { return to_string(bytes >> 10) + " KiB"; };
+    int tree = static_cast<int>(NodeRegistry::State::TREE);
+    int inTrash = static_cast<int>(NodeRegistry::State::TRASH);
+    int detached = static_cast<int>(NodeRegistry::State::DETACHED);
+    
+    cout << "\n=== MEMORIA RETENIDA ===" << endl;
+    cout << "Nodos vivos: " << census.live << endl;
+    cout << "  En el árbol:     " << census.counts[tree] << " (~" << kib(census.bytes[tree]) << ")" << endl;
+    cout << "  En la papelera:  " << census.counts[inTrash] << " (~" << kib(census.bytes[inTrash]) << ")" << endl;
+    cout << "  Desconectados:   " << census.counts[detached] << " (~" << kib(census.bytes[detached])
+         << ") en " << census.orphans.size() << " subárbol(es)" << endl;
+    cout << "Bloques de nodos ya liberados retenidos por weak_ptr: " << census.zombieBlocks
+         << " (~" << kib(census.zombieBytes) << ")" << endl;
+    cout << "Censo en " << census.seconds * 1000 << " ms" << endl;
+    
+    if (!census.orphans.empty()) {
+        cout << "Use 'orphans' para verlos y 'orphans reclaim' para liberarlos." << endl;
     }
 }
 
-void ConsoleInterface::listDirectory(const string& path) {
-    string absPath = path.empty() ? currentPath : getAbsolutePath(path);
+void ConsoleInterface::showOrphans(bool reclaim) {
+    const size_t MAX_LISTED = 20;
     
-    try {
-        auto children = fileSystem->listChildren(absPath);
-        
-        if (children.empty()) {
-            cout << "Directorio vacío" << endl;
-        } else {
-            cout << "Contenido de " << absPath << ":" << endl;
-            for (const auto& child : children) {
-                cout << "  " << child << endl;
-            }
-        }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
+    if (jobs.runningCount() > 0) {
+        cout << "Error: hay trabajos en curso; espere con 'wait' antes de hacer el censo." << endl;
+        return;
     }
-}
-
-void ConsoleInterface::makeDirectory(const string& path) {
-    string absPath = currentPath;
-    string dirName = path;
     
-    // Si la ruta contiene '/', separar
-    size_t lastSlash = path.find_last_of('/');
-    if (lastSlash != string::npos) {
-        absPath = getAbsolutePath(path.substr(0, lastSlash));
-        dirName = path.substr(lastSlash + 1);
+    auto census = takeCensus();
+    if (census.orphans.empty()) {
+        cout << "No hay subárboles desconectados." << endl;
+        return;
     }
     
-    try {
-        fileSystem->createNode(absPath, dirName, NodeType::FOLDER);
-        searchEngine->rebuildIndex(); // Reindexar después de crear
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
+    cout << "\n=== SUBÁRBOLES DESCONECTADOS ===" << endl;
+    for (size_t i = 0; i < census.orphans.size() && i < MAX_LISTED; i++) {
+        const auto& orphan = census.orphans[i];
+        cout << i + 1 << ". " << (orphan.node->isFolder() ? "[CARPETA] " : "[ARCHIVO] ")
+             << orphan.node->getName() << " (ID: " << orphan.node->id << ") - "
+             << orphan.nodes << " nodos, ~" << (orphan.bytes >> 10) << " KiB, "
+             << orphan.holders << " referencia(s)" << endl;
     }
-}
-
-void ConsoleInterface::createFile(const string& path, const string& content) {
-    string absPath = currentPath;
-    string fileName = path;
-    
-    // Si la ruta contiene '/', separar
-    size_t lastSlash = path.find_last_of('/');
-    if (lastSlash != string::npos) {
-        absPath = getAbsolutePath(path.substr(0, lastSlash));
-        fileName = path.substr(lastSlash + 1);
+    if (census.orphans.size() > MAX_LISTED) {
+        cout << "... y " << census.orphans.size() - MAX_LISTED << " más" << endl;
     }
     
-    try {
-        fileSystem->createNode(absPath, fileName, NodeType::FILE, content);
-        searchEngine->rebuildIndex(); // Reindexar después de crear
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
-    }
-}
-
-void ConsoleInterface::moveNode(const string& source, const string& dest) {
-    string absSource = getAbsolutePath(source);
-    string absDest = getAbsolutePath(dest);
+    if (!reclaim) return;
     
-    try {
-        if (fileSystem->moveNode(absSource, absDest)) {
-            searchEngine->rebuildIndex(); // Reindexar después de mover
-        }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
-    }
+    // Las raíces las sujeta otra referencia; se libera lo que cuelga de ellas
+    long long handed = NodeRegistry::reclaim(census);
+    size_t roots = census.orphans.size();
+    census = NodeRegistry::Census();
+    NodeReclaimer::instance().drain();
+    cout << "Entregados al recolector " << handed << " nodos. Las raíces (" << roots
+         << ") siguen vivas mientras las sujeten sus referencias." << endl;
 }
 
-void ConsoleInterface::removeNode(const string& path) {
-    string absPath = getAbsolutePath(path);
-    
-    try {
-        auto node = fileSystem->findNodeByPath(absPath);
-        if (!node) {
-            cout << "Error: Nodo no encontrado: " << path << endl;
-            return;
-        }
+void ConsoleInterface::generateTestTree(int levels, int children, bool background) {
+    string description = "generate " + to_string(levels) + " " + to_string(children);
+    
+    // El árbol nuevo se construye e indexa aparte y se instala al terminar
+    jobs.submit(description, false, [this, levels, children](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\nGenerando árbol de prueba..." << endl;
+        out << "Niveles: " << levels << ", Hijos por nivel: " << children << endl;
         
-        // Guardar información para posible restauración
-        TrashItem item;
-        item.node = node;
-        item.originalPath = absPath;
-        // CORRECCIÓN: Usamos .lock() para obtener shared_ptr del weak_ptr
-        item.parent = node->parent.lock();
+        auto stagedTree = make_shared<FileSystemTree>();
+        stagedTree->setVerbose(false);
+        control.setPhase("generando");
+        stagedTree->generateLargeTree(levels, children, &control);
         
-        // guardar en papelera
-        trashBin.push_back(item);
+        control.setPhase("indexando");
+        auto stagedEngine = make_shared<SearchEngine>(stagedTree);
+        control.checkpoint();
         
-        // eliminar del índice de búsqueda
-        searchEngine->removeNodeFromIndex(node);
+        out << "Árbol generado exitosamente. Total de nodos: " << stagedTree->getNextId() << endl;
         
-        // eliminar del árbol
-        if (fileSystem->deleteNode(absPath)) {
-            cout << "Nodo '" << node->name << "' movido a la papelera." << endl;
-            cout << "Usa 'trash' para ver la papelera." << endl;
-            cout << "Usa 'restore " << node->name << "' para recuperarlo." << endl;
-        }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
-    }
+        return [this, stagedTree, stagedEngine]() {
+            installTree(stagedTree, stagedEngine);
+        };
+    }, background);
 }
 
-
-void ConsoleInterface::renameNode(const string& path, const string& newName) {
-    string absPath = getAbsolutePath(path);
-    
-    try {
-        // Primero remover del índice
-        auto node = fileSystem->findNodeByPath(absPath);
-        if (node) {
-            searchEngine->removeNodeFromIndex(node);
-        }
+void ConsoleInterface::benchmarkOperations(bool background) {
+    // Se mide sobre un árbol de trabajo propio para no llenar el directorio actual
+    jobs.submit("benchmark", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE OPERACIONES ===" << endl;
         
-        // Renombrar
-        if (fileSystem->renameNode(absPath, newName)) {
-            // Reindexar con el nuevo nombre
-            searchEngine->rebuildIndex();
-        }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
-    }
-}
-
-void ConsoleInterface::searchNodes(const string& query) {
-    cout << "Resultados de búsqueda para '" << query << "':" << endl;
-    
-    // Búsqueda por prefijo
-    auto results = searchEngine->searchByPrefix(query);
-    
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        auto benchEngine = make_shared<SearchEngine>(benchTree);
+        auto benchRoot = benchTree->getRoot();
+        
+        vector<pair<string, std::function<void()>>> operations;
+        
+        // Agregar operaciones al vector
+        operations.push_back({"Crear 100 archivos", [&]() {
+            for (int i = 0; i < 100; i++) {
+                auto node = benchTree->createNode(benchRoot, "bench_" + to_string(i) + ".txt",
+                                                  NodeType::FILE, "contenido");
+                benchEngine->indexNode(node);
+            }
+        }});
+        
+        operations.push_back({"Crear 50 carpetas", [&]() {
+            for (int i = 0; i < 50; i++) {
+                auto node = benchTree->createNode(benchRoot, "bench_dir_" + to_string(i),
+                                                  NodeType::FOLDER);
+                benchEngine->indexNode(node);
+            }
+        }});
+        
+        operations.push_back({"Listar directorio", [&]() {
+            benchTree->listChildren(benchRoot);
+        }});
+        
+        operations.push_back({"Búsqueda por prefijo", [&]() {
+            benchEngine->searchByPrefix("bench");
+        }});
+        
+        operations.push_back({"Búsqueda con comodines (*_9.txt)", [&]() {
+            benchEngine->searchGlob("*_9.txt");
+        }});
+        
+        operations.push_back({"Recorrido completo", [&]() {
+            benchTree->preorderTraversal();
+        }});
+        
+        // Reorganización en un árbol profundo: comprobar ancestros y
+        // conexión no debe recorrer la cadena de padres
+        const int chainDepth = 10000;
+        vector<shared_ptr<TreeNode>> chain;
+        operations.push_back({"Crear cadena de " + to_string(chainDepth) + " carpetas", [&]() {
+            chain.push_back(benchTree->createNode(benchRoot, "bench_chain", NodeType::FOLDER));
+            for (int i = 1; i < chainDepth; i++) {
+                chain.push_back(benchTree->createNode(chain.back(), "c" + to_string(i), NodeType::FOLDER));
+            }
+        }});
+        
+        operations.push_back({"Mover 1000 veces a " + to_string(chainDepth) + " niveles", [&]() {
+            auto file = benchTree->createNode(chain.back(), "bench_move.txt", NodeType::FILE);
+            for (int i = 0; i < 1000; i++) {
+                control.checkpoint();
+                benchTree->moveNode(file, chain[i % 2 ? chainDepth - 1 : chainDepth / 2]);
+                benchTree->moveNode(chain[chainDepth - 10], chain[i % 2 ? chainDepth - 20 : chainDepth - 30]);
+            }
+        }});
+        
+        operations.push_back({"Rechazar 1000 ciclos a " + to_string(chainDepth) + " niveles", [&]() {
+            for (int i = 0; i < 1000; i++) {
+                try {
+                    benchTree->moveNode(chain[i % 100], chain[chainDepth - 40]);
+                } catch (const invalid_argument&) {
+                    // Esperado: el destino es descendiente del origen
+                }
+            }
+        }});
+        
+        control.setTotal(operations.size());
+        for (auto& operation : operations) {
+            control.checkpoint();
+            control.setPhase(operation.first);
+            auto start = high_resolution_clock::now();
+            
+            try {
+                operation.second();  // Ejecutar la función
+            } catch (const JobCancelled&) {
+                throw;
+            } catch (const exception& e) {
+                out << "Error durante " << operation.first << ": " << e.what() << endl;
+            }
+            
+            auto end = high_resolution_clock::now();
+            duration<double> elapsed = end - start;
+            
+            out << operation.first << ": " << elapsed.count() * 1000 << " ms" << endl;
+            control.advance();
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::benchmarkFuzzy(bool background) {
+    // Autómata sobre el Trie frente a calcular la distancia con cada nombre
+    jobs.submit("benchmark fuzzy", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE BÚSQUEDA APROXIMADA ===" << endl;
+        
+        control.setPhase("Generando árbol");
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        benchTree->generateLargeTree(6, 10, &control);
+        auto benchEngine = make_shared<SearchEngine>(benchTree);
+        out << "Nombres indexados: " << benchTree->getNextId() << endl;
+        
+        // Consultas con un borrado, una trasposición y dos ediciones
+        vector<pair<string, int>> queries = {
+            {"nodo_L6_P1234_H7", 1},
+            {"nodo_L6_P12345_H7", 1},
+            {"nodo_L6_P21345_H7", 1},
+            {"nodo_L6_P2134_H", 2},
+            {"nodo_L5_P999_H3", 2}
+        };
+        
+        control.setTotal(queries.size() * 2);
+        for (const auto& query : queries) {
+            control.checkpoint();
+            control.setPhase("Consulta " + query.first);
+            
+            auto start = high_resolution_clock::now();
+            auto results = benchEngine->searchFuzzy(query.first, query.second);
+            duration<double> automaton = high_resolution_clock::now() - start;
+            control.advance();
+            
+            // Referencia: distancia completa con cada nombre indexado
+            size_t expected = 0;
+            start = high_resolution_clock::now();
+            for (const auto& name : benchEngine->autocomplete("", numeric_limits<int>::max())) {
+                if (FuzzyMatcher::editDistance(query.first, name) <= query.second) {
+                    expected += benchEngine->searchExact(name).size();
+                }
+            }
+            duration<double> bruteForce = high_resolution_clock::now() - start;
+            control.advance();
+            
+            out << "'" << query.first << "' (d<=" << query.second << "): "
+                << results.size() << " resultados, autómata " << automaton.count() * 1000
+                << " ms, recorrido completo " << bruteForce.count() * 1000 << " ms"
+                << (results.size() == expected ? "" : " [DISCREPANCIA]") << endl;
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::benchmarkGrep(bool background) {
+    // Índice invertido frente a recorrer el contenido de cada archivo
+    jobs.submit("benchmark grep", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE BÚSQUEDA EN CONTENIDO ===" << endl;
+        
+        // 1000 carpetas x 1000 archivos con 8 palabras de un vocabulario de
+        // 5000 ("termino0" es la más frecuente)
+        const int folders = 1000, filesPerFolder = 1000, vocabulary = 5000;
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        auto benchRoot = benchTree->getRoot();
+        mt19937 rng(42);
+        
+        control.setPhase("Generando archivos");
+        control.setTotal(folders);
+        for (int f = 0; f < folders; f++) {
+            control.checkpoint();
+            auto folder = benchTree->createNode(benchRoot, "carpeta_" + to_string(f), NodeType::FOLDER);
+            for (int i = 0; i < filesPerFolder; i++) {
+                string content;
+                for (int w = 0; w < 8; w++) {
+                    int word = static_cast<int>(rng() % vocabulary);
+                    if (rng() % 4 == 0) word %= 50;  // Algunas palabras mucho más comunes
+                    content += (w ? " termino" : "termino") + to_string(word);
+                }
+                benchTree->createNode(folder, "archivo_" + to_string(i) + ".txt", NodeType::FILE, content);
+            }
+            control.advance();
+        }
+        
+        control.setPhase("Indexando");
+        auto start = high_resolution_clock::now();
+        auto benchEngine = make_shared<SearchEngine>(benchTree);
+        benchEngine->searchContent("termino0");  // Fusiona las listas pendientes
+        duration<double> indexing = high_resolution_clock::now() - start;
+        out << "Archivos: " << folders * filesPerFolder << ", indexados en "
+            << indexing.count() * 1000 << " ms" << endl;
+        
+        vector<string> queries = {
+            "termino4321",
+            "termino7 termino12",
+            "termino4321 OR termino1234",
+            "\"termino7 termino12\"",
+            "termino4321 termino7"
+        };
+        
+        control.setTotal(queries.size());
+        for (const auto& query : queries) {
+            control.checkpoint();
+            control.setPhase("Consulta " + query);
+            
+            start = high_resolution_clock::now();
+            auto results = benchEngine->searchContent(query);
+            duration<double> indexed = high_resolution_clock::now() - start;
+            
+            // Referencia: tokenizar cada archivo y evaluar la consulta
+            auto parsed = ContentIndex::parseQuery(query);
+            size_t expected = 0;
+            start = high_resolution_clock::now();
+            vector<shared_ptr<TreeNode>> pending = {benchRoot};
+            while (!pending.empty()) {
+                auto node = pending.back();
+                pending.pop_back();
+                for (auto& child : node->getChildren()) pending.push_back(child);
+                if (!node->isFile()) continue;
+                
+                string tokens = " ";
+                for (const auto& token : ContentIndex::tokenize(node->getContent())) {
+                    tokens += token + " ";
+                }
+                bool any = false;
+                for (const auto& group : parsed.groups) {
+                    bool all = true;
+                    for (const auto& phrase : group) {
+                        string needle = " ";
+                        for (const auto& word : phrase) needle += word + " ";
+                        all = all && tokens.find(needle) != string::npos;
+                    }
+                    any = any || all;
+                }
+                if (any) expected++;
+            }
+            duration<double> scan = high_resolution_clock::now() - start;
+            
+            out << query << ": " << results.size() << " resultados, índice "
+                << indexed.count() * 1000 << " ms, recorrido completo " << scan.count() * 1000 << " ms"
+                << (results.size() == expected ? "" : " [DISCREPANCIA]") << endl;
+            control.advance();
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::benchmarkScan(bool background) {
+    // Escaneo en paralelo con SIMD frente a string::find en un solo hilo
+    jobs.submit("benchmark scan", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE ESCANEO DE CONTENIDO ===" << endl;
+        
+        // 4096 archivos de 64 KB con texto de palabras aleatorias
+        const int fileCount = 4096, fileSize = 64 * 1024;
+        const vector<string> words = {"informe", "datos", "sistema", "archivo", "proyecto", "versión",
+                                      "usuario", "error", "fecha", "límite", "revisar", "total"};
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        auto benchRoot = benchTree->getRoot();
+        mt19937 rng(42);
+        
+        control.setPhase("Generando archivos");
+        control.setTotal(fileCount);
+        size_t totalBytes = 0;
+        for (int f = 0; f < fileCount; f++) {
+            control.checkpoint();
+            string content;
+            content.reserve(fileSize + 16);
+            while (content.size() < static_cast<size_t>(fileSize)) {
+                content += words[rng() % words.size()];
+                content += (rng() % 12 == 0) ? '\n' : ' ';
+            }
+            if (rng() % 64 == 0) content += " TODO pendiente";
+            totalBytes += content.size();
+            benchTree->createNode(benchRoot, "archivo_" + to_string(f) + ".txt", NodeType::FILE, content);
+            control.advance();
+        }
+        out << "Archivos: " << fileCount << ", " << totalBytes / (1024 * 1024) << " MB, "
+            << SimdSearch::instructionSet() << endl;
+        
+        vector<vector<string>> queries = {
+            {"TODO"},
+            {"fecha límite"},
+            {"TODO", "revisar total", "FIXME"}
+        };
+        
+        control.setTotal(queries.size());
+        for (const auto& patterns : queries) {
+            control.checkpoint();
+            string label;
+            for (const auto& pattern : patterns) label += (label.empty() ? "" : " | ") + pattern;
+            control.setPhase("Patrón " + label);
+            
+            ContentScanner scanner(patterns);
+            size_t matches = 0;
+            auto stats = scanner.scan(benchRoot, [&](const ContentScanner::FileHit& hit) {
+                matches += hit.matches;
+                return true;
+            });
+            
+            // Referencia: string::find patrón a patrón en un solo hilo
+            size_t expected = 0;
+            auto start = high_resolution_clock::now();
+            for (const auto& child : benchRoot->getChildren()) {
+                for (const auto& pattern : patterns) {
+                    for (size_t pos = child->getContent().find(pattern); pos != string::npos;
+                         pos = child->getContent().find(pattern, pos + 1)) {
+                        expected++;
+                    }
+                }
+            }
+            duration<double> reference = high_resolution_clock::now() - start;
+            
+            out << label << ": " << matches << " coincidencias, escaneo " << stats.seconds * 1000 << " ms ("
+                << stats.bytes / 1e9 / stats.seconds << " GB/s, " << stats.threads << " hilos), string::find "
+                << reference.count() * 1000 << " ms (" << totalBytes / 1e9 / reference.count() << " GB/s)"
+                << (matches == expected ? "" : " [DISCREPANCIA]") << endl;
+            control.advance();
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::benchmarkContains(bool background) {
+    // Bloque de nombres empaquetado frente a recorrer el árbol nodo a nodo
+    jobs.submit("benchmark contains", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE BÚSQUEDA DE SUBCADENAS ===" << endl;
+        
+        control.setPhase("Generando árbol");
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        benchTree->generateLargeTree(6, 10, &control);
+        auto benchEngine = make_shared<SearchEngine>(benchTree, false);
+        out << "Nombres indexados: " << benchTree->getNextId() << ", " << SimdSearch::instructionSet() << endl;
+        
+        vector<pair<string, bool>> queries = {
+            {"P1234_", false},
+            {"_H7", false},
+            {"l6_p99", true},
+            {"inexistente", false}
+        };
+        
+        control.setTotal(queries.size());
+        for (const auto& query : queries) {
+            control.checkpoint();
+            control.setPhase("Consulta " + query.first);
+            
+            auto start = high_resolution_clock::now();
+            auto results = benchEngine->searchContains(query.first, query.second);
+            duration<double> packed = high_resolution_clock::now() - start;
+            
+            // Referencia: recorrer el árbol comparando cada nombre
+            string needle = query.second ? SimdSearch::toLowerAscii(query.first) : query.first;
+            size_t expected = 0, bytes = 0;
+            start = high_resolution_clock::now();
+            queue<shared_ptr<TreeNode>> pending;
+            pending.push(benchTree->getRoot());
+            while (!pending.empty()) {
+                auto node = pending.front();
+                pending.pop();
+                bytes += node->getName().size() + 1;
+                bool found = query.second ? SimdSearch::toLowerAscii(node->getName()).find(needle) != string::npos
+                                          : node->getName().find(needle) != string::npos;
+                if (found) expected++;
+                for (auto& child : node->getChildren()) pending.push(child);
+            }
+            duration<double> traversal = high_resolution_clock::now() - start;
+            
+            out << "'" << query.first << "'" << (query.second ? " (sin mayúsculas)" : "") << ": "
+                << results.size() << " resultados, bloque de nombres " << packed.count() * 1000 << " ms ("
+                << bytes / 1e9 / packed.count() << " GB/s), recorrido del árbol " << traversal.count() * 1000
+                << " ms" << (results.size() == expected ? "" : " [DISCREPANCIA]") << endl;
+            control.advance();
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+namespace {
+    // Disposición anterior: un único tipo de nodo con los campos de
+    // carpeta y de archivo (solo para comparar tamaños)
+    struct SingleLayoutNode : public enable_shared_from_this<SingleLayoutNode> {
+        int id;
+        uint32_t nameId;
+        NodeType type;
+        string content;
+        vector<shared_ptr<TreeNode>> children;
+        weak_ptr<TreeNode> parent;
+        OrderTag enter;
+        OrderTag exit;
+        uint64_t attachedEpoch;
+        unique_ptr<unordered_map<string_view, TreeNode*>> childIndex;
+    };
+    
+    // Bytes en uso del montón (0 si la biblioteca no lo informa)
+    size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+#else
+        return 0;
+#endif
+    }
+    
+    // Bytes reales de montón por nodo creado con make, redondeo del
+    // asignador y bloque de control incluidos (0 si no se puede medir)
+    template <typename Make>
+    size_t allocationBytes(Make make) {
+        const size_t samples = 4096;
+        vector<decltype(make())> blocks;
+        blocks.reserve(samples);
+        size_t before = heapInUse();
+        for (size_t i = 0; i < samples; i++) {
+            blocks.push_back(make());
+        }
+        size_t after = heapInUse();
+        return after > before ? (after - before) / samples : 0;
+    }
+}
+
+void ConsoleInterface::benchmarkMemory(bool background) {
+    // Nodos de carpeta y de archivo separados frente a un solo tipo de nodo
+    jobs.submit("benchmark memory", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE MEMORIA POR NODO ===" << endl;
+        
+        const int folders = 2000;
+        const int filesPerFolder = 250;
+        control.setTotal(folders);
+        control.setPhase("Generando árbol");
+        
+        size_t heapBefore = heapInUse();
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        auto benchRoot = benchTree->getRoot();
+        for (int d = 0; d < folders; d++) {
+            control.checkpoint();
+            auto folder = benchTree->createNode(benchRoot, "carpeta_" + to_string(d), NodeType::FOLDER);
+            for (int f = 0; f < filesPerFolder; f++) {
+                benchTree->createNode(folder, "archivo_" + to_string(f) + ".txt", NodeType::FILE);
+            }
+            control.advance();
+        }
+        size_t heapAfter = heapInUse();
+        
+        size_t folderCount = folders + 1;
+        size_t fileCount = static_cast<size_t>(folders) * filesPerFolder;
+        size_t nodes = folderCount + fileCount;
+        
+        out << "Nodos: " << nodes << " (" << folderCount << " carpetas, " << fileCount << " archivos)" << endl;
+        out << "Tamaño del nodo: carpeta " << sizeof(FolderNode) << " B, archivo " << sizeof(FileNode)
+            << " B (un solo tipo de nodo: " << sizeof(SingleLayoutNode) << " B)" << endl;
+        
+        // El ahorro se mide con lo que el asignador reserva para cada nodo
+        size_t singleBlock = allocationBytes([]() { return make_shared<SingleLayoutNode>(); });
+        size_t folderBlock = allocationBytes([]() { return TreeNode::create(0, "x", NodeType::FOLDER); });
+        size_t fileBlock = allocationBytes([]() { return TreeNode::create(0, "x", NodeType::FILE); });
+        // El montón es de todo el proceso: si otros hilos reservan durante la
+        // medición un bloque separado puede salir mayor y el ahorro negativo
+        bool measured = singleBlock > 0 && folderBlock > 0 && fileBlock > 0;
+        long long single = static_cast<long long>(singleBlock);
+        long long saved = static_cast<long long>(folderCount) * (single - static_cast<long long>(folderBlock)) +
+                          static_cast<long long>(fileCount) * (single - static_cast<long long>(fileBlock));
+        
+        if (heapAfter > heapBefore && measured) {
+            long long used = static_cast<long long>(heapAfter - heapBefore);
+            long long count = static_cast<long long>(nodes);
+            out << "Montón del árbol: " << used / 1024 << " KiB, " << used / count << " bytes por nodo"
+                << " (con un solo tipo de nodo: " << (used + saved) / count << ")" << endl;
+        }
+        if (!measured) {
+            out << "Ahorro por la disposición separada: n/a (el montón no se pudo medir)" << endl;
+        } else {
+            out << "Ahorro por la disposición separada: " << saved / 1024 << " KiB";
+            if (saved < 0) out << " (medición alterada por otros hilos)";
+            out << endl;
+        }
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::benchmarkSnapshot(bool background) {
+    // Recorridos lineales sobre la instantánea frente a seguir punteros
+    jobs.submit("benchmark snapshot", false, [](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        out << "\n=== BENCHMARK DE INSTANTÁNEA PLANA ===" << endl;
+        
+        control.setPhase("Generando árbol");
+        auto benchTree = make_shared<FileSystemTree>();
+        benchTree->setVerbose(false);
+        benchTree->generateLargeTree(6, 10, &control);
+        
+        const int rounds = 10;
+        control.setTotal(rounds * 2);
+        
+        // Referencia: recorrido en profundidad por los hijos de cada nodo
+        size_t nodes = 0, folders = 0, leaves = 0;
+        uint64_t leafDepthSum = 0;
+        uint32_t height = 0;
+        auto start = high_resolution_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            control.checkpoint();
+            control.setPhase("Recorrido por punteros");
+            nodes = folders = leaves = 0;
+            leafDepthSum = 0;
+            height = 0;
+            vector<pair<const TreeNode*, uint32_t>> pending = {{benchTree->getRoot().get(), 0}};
+            while (!pending.empty()) {
+                const TreeNode* node = pending.back().first;
+                uint32_t depth = pending.back().second;
+                pending.pop_back();
+                nodes++;
+                folders += node->isFolder();
+                height = max(height, depth);
+                if (node->getChildren().empty()) {
+                    leaves++;
+                    leafDepthSum += depth;
+                }
+                for (const auto& child : node->getChildren()) {
+                    pending.push_back({child.get(), depth + 1});
+                }
+            }
+            control.advance();
+        }
+        duration<double> pointerTime = high_resolution_clock::now() - start;
+        
+        control.setPhase("Construyendo instantánea");
+        start = high_resolution_clock::now();
+        auto frozen = benchTree->freeze();
+        duration<double> buildTime = high_resolution_clock::now() - start;
+        
+        TreeSnapshot::LeafDepths leafStats = {0, 0, 0};
+        size_t frozenFolders = 0;
+        uint32_t frozenHeight = 0;
+        start = high_resolution_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            control.checkpoint();
+            control.setPhase("Recorrido de la instantánea");
+            frozenFolders = frozen->folderCount();
+            frozenHeight = frozen->maxDepth();
+            leafStats = frozen->leafDepths();
+            control.advance();
+        }
+        duration<double> snapshotTime = high_resolution_clock::now() - start;
+        
+        bool consistent = frozen->size() == nodes && frozenFolders == folders && frozenHeight == height &&
+                          leafStats.leaves == leaves && leafStats.totalDepth == leafDepthSum;
+        
+        out << "Nodos: " << nodes << ", instantánea de " << frozen->byteSize() / 1024 << " KiB" << endl;
+        out << "Estadísticas por punteros: " << pointerTime.count() * 1000 / rounds << " ms por recorrido" << endl;
+        out << "Construir la instantánea: " << buildTime.count() * 1000 << " ms (una vez por cambio)" << endl;
+        out << "Estadísticas sobre la instantánea: " << snapshotTime.count() * 1000 / rounds << " ms por recorrido ("
+            << pointerTime.count() / max(snapshotTime.count(), 1e-9) << "x)"
+            << (consistent ? "" : " [DISCREPANCIA]") << endl;
+        
+        out << "\n=== BENCHMARK COMPLETADO ===" << endl;
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::changeDirectory(const string& path) {
+    auto node = resolvePath(path);
+    
+    if (node && node->isFolder()) {
+        currentDirectory = node;
+        chatter() << "Directorio cambiado a: " << fileSystem->getFullPath(currentDirectory) << endl;
+    } else {
+        cout << "Error: Directorio no encontrado o no es una carpeta" << endl;
+    }
+}
+
+void ConsoleInterface::listDirectory(const string& path) {
+    auto node = path.empty() ? currentDirectory : resolvePath(path);
+    if (!node) {
+        cout << "Error: Nodo no encontrado: " << path << endl;
+        return;
+    }
+    
+    try {
+        auto children = fileSystem->listChildren(node);
+        
+        if (children.empty()) {
+            cout << "Directorio vacío" << endl;
+        } else {
+            cout << "Contenido de " << fileSystem->getFullPath(node) << ":" << endl;
+            for (const auto& child : children) {
+                cout << "  " << child << endl;
+            }
+        }
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+void ConsoleInterface::makeDirectory(const string& path) {
+    string dirName;
+    auto parentNode = resolveParent(path, dirName);
+    if (!parentNode) {
+        cout << "Error: Ruta no encontrada: " << path << endl;
+        return;
+    }
+    
+    try {
+        auto node = fileSystem->createNode(parentNode, dirName, NodeType::FOLDER);
+        printCreated(node);
+        searchEngine->indexNode(node); // Indexar solo el nodo nuevo
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+void ConsoleInterface::createFile(const string& path, const string& content) {
+    string fileName;
+    auto parentNode = resolveParent(path, fileName);
+    if (!parentNode) {
+        cout << "Error: Ruta no encontrada: " << path << endl;
+        return;
+    }
+    
+    try {
+        auto node = fileSystem->createNode(parentNode, fileName, NodeType::FILE, content);
+        printCreated(node);
+        searchEngine->indexNode(node); // Indexar solo el nodo nuevo
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+void ConsoleInterface::moveNode(const string& source, const string& dest) {
+    auto sourceNode = resolvePath(source);
+    if (!sourceNode) {
+        cout << "Error: Nodo origen no encontrado: " << source << endl;
+        return;
+    }
+    
+    auto destNode = resolvePath(dest);
+    if (!destNode) {
+        cout << "Error: Ruta destino no encontrada: " << dest << endl;
+        return;
+    }
+    
+    try {
+        if (fileSystem->moveNode(sourceNode, destNode)) {
+            // Los nombres no cambian: el índice sigue siendo válido
+            chatter() << "Nodo movido: " << source << " -> " << dest << endl;
+        }
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+void ConsoleInterface::removeNode(const string& path) {
+    try {
+        auto node = resolvePath(path);
+        if (!node) {
+            cout << "Error: Nodo no encontrado: " << path << endl;
+            return;
+        }
+        
+        if (node == fileSystem->getRoot()) {
+            cout << "Error: No se puede eliminar la raíz" << endl;
+            return;
+        }
+        
+        // Guardar información para posible restauración
+        string originalPath = fileSystem->getFullPath(node);
+        auto parent = node->parent.lock();
+        
+        // eliminar del árbol y guardar en papelera; en el índice basta
+        // una lápida (el compactador limpia cuando se purga)
+        if (fileSystem->deleteNode(node)) {
+            searchEngine->markDeleted(node);
+            trash.add(node, parent, originalPath);
+            chatter() << "Nodo eliminado: " << originalPath << " (ID=" << node->id << ")" << endl;
+            chatter() << "Nodo '" << node->getName() << "' movido a la papelera." << endl;
+            chatter() << "Usa 'trash' para ver la papelera." << endl;
+            chatter() << "Usa 'restore " << node->getName() << "' para recuperarlo." << endl;
+        }
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+
+void ConsoleInterface::renameNode(const string& path, const string& newName) {
+    try {
+        auto node = resolvePath(path);
+        if (!node) {
+            cout << "Error: Nodo no encontrado: " << path << endl;
+            return;
+        }
+        
+        // Renombrar y actualizar solo la entrada de este nodo
+        string oldName = node->getName();
+        if (fileSystem->renameNode(node, newName)) {
+            searchEngine->renameNode(node, oldName);
+            chatter() << "Nodo renombrado: " << oldName << " -> " << newName << endl;
+        }
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+    }
+}
+
+// batch begin | status | commit | abort
+void ConsoleInterface::batchCommand(const vector<string>& args) {
+    const size_t MAX_LISTED = 20;
+    string option = args.size() > 1 ? args[1] : "status";
+    auto& batch = pendingBatch.batch;
+    
+    if (option != "begin" && option != "status" && option != "commit" && option != "abort") {
+        cout << "Uso: batch [begin | status | commit | abort]" << endl;
+        return;
+    }
+    
+    if (option == "begin") {
+        if (pendingBatch.open) {
+            cout << "Ya hay una transacción abierta (" << batch.size() << " operaciones)." << endl;
+            return;
+        }
+        pendingBatch.open = true;
+        cout << "Transacción abierta: mkdir, touch, mv, rm y rename se encolan hasta 'batch commit'." << endl;
+        return;
+    }
+    
+    if (!pendingBatch.open) {
+        cout << "No hay ninguna transacción abierta. Use 'batch begin'." << endl;
+        return;
+    }
+    
+    if (option == "status") {
+        cout << "Transacción abierta: " << batch.size() << " operaciones" << endl;
+        const auto& ops = batch.operations();
+        for (size_t i = 0; i < ops.size() && i < MAX_LISTED; i++) {
+            cout << "  " << i + 1 << ". " << FileSystemTree::Batch::describe(ops[i]) << endl;
+        }
+        if (ops.size() > MAX_LISTED) {
+            cout << "  ... y " << ops.size() - MAX_LISTED << " más" << endl;
+        }
+    } else if (option == "abort") {
+        cout << "Transacción descartada (" << batch.size() << " operaciones)." << endl;
+        pendingBatch = PendingBatch();
+    } else {
+        if (treeLockedByJob()) return;
+        
+        FileSystemTree::Batch committed = std::move(batch);
+        pendingBatch = PendingBatch();
+        auto start = high_resolution_clock::now();
+        try {
+            auto result = fileSystem->commit(committed);
+            
+            // Un solo cambio de índice para toda la transacción
+            searchEngine->applyBatch(result);
+            for (auto& removal : result.removed) {
+                trash.add(removal.node, removal.parent, removal.originalPath);
+            }
+            
+            auto end = high_resolution_clock::now();
+            const auto& ops = committed.operations();
+            auto renames = count_if(ops.begin(), ops.end(), [](const FileSystemTree::Batch::Op& op) {
+                return op.type == FileSystemTree::Batch::OpType::RENAME;
+            });
+            cout << "Transacción aplicada: " << ops.size() << " operaciones en "
+                 << duration<double, milli>(end - start).count() << " ms ("
+                 << result.created.size() << " creados, " << result.moved << " movidos, "
+                 << renames << " renombrados, " << result.removed.size() << " eliminados)" << endl;
+        } catch (const exception& e) {
+            cout << "Error: " << e.what() << endl;
+            cout << "Transacción revertida: no se aplicó ninguna de las "
+                 << committed.size() << " operaciones." << endl;
+        }
+    }
+}
+
+// Helper: encolar una modificación en la transacción abierta. false si el
+// comando no se encola (no modifica o le faltan argumentos: se ejecuta
+// como siempre y muestra su uso)
+bool ConsoleInterface::queueBatchOperation(const vector<string>& args) {
+    const string& cmd = args[0];
+    auto& batch = pendingBatch.batch;
+    
+    if ((cmd == "mkdir" || cmd == "touch") && args.size() > 1) {
+        string path = absolutePath(args[1]);
+        size_t lastSlash = path.rfind('/');
+        string content;
+        for (size_t i = 2; i < args.size(); i++) {
+            content += (i > 2 ? " " : "") + args[i];
+        }
+        batch.create(lastSlash == 0 ? "/" : path.substr(0, lastSlash), path.substr(lastSlash + 1),
+                     cmd == "mkdir" ? NodeType::FOLDER : NodeType::FILE, content);
+    } else if (cmd == "mv" && args.size() > 2) {
+        batch.move(absolutePath(args[1]), absolutePath(args[2]));
+    } else if (cmd == "rename" && args.size() > 2) {
+        batch.rename(absolutePath(args[1]), args[2]);
+    } else if (cmd == "rm" && args.size() > 1) {
+        batch.remove(absolutePath(args[1]));
+    } else {
+        return false;
+    }
+    
+    chatter() << "En transacción (" << batch.size() << "): "
+              << FileSystemTree::Batch::describe(batch.operations().back()) << endl;
+    return true;
+}
+
+// search <consulta> [under <ruta>] [--limit N] [--offset N] | search --next
+// search <patrón con * o ?> [under <ruta>] [--limit N] [--offset N]
+// search ~<nombre> [under <ruta>] [--distance 1|2] [--limit N] [--offset N]
+void ConsoleInterface::searchCommand(const vector<string>& args) {
+    string query, scopePath;
+    size_t limit = 0, offset = 0;
+    int distance = -1;
+    bool ignoreCase = false;
+    bool valid = args.size() > 1;
+    
+    for (size_t i = 1; i < args.size() && valid; i++) {
+        if (args[i] == "--next" && args.size() == 2) {
+            printSearchPage();
+            return;
+        } else if (args[i] == "--limit" && i + 1 < args.size()) {
+            limit = stoul(args[++i]);
+        } else if (args[i] == "--offset" && i + 1 < args.size()) {
+            offset = stoul(args[++i]);
+        } else if (args[i] == "--distance" && i + 1 < args.size()) {
+            distance = stoi(args[++i]);
+            valid = distance >= 1 && distance <= 2;
+        } else if (args[i] == "--ignore-case") {
+            ignoreCase = true;
+        } else if (args[i] == "under" && i + 1 < args.size() && !query.empty()) {
+            scopePath = args[++i];
+        } else if (query.empty() && args[i].compare(0, 2, "--") != 0) {
+            query = args[i];
+        } else {
+            valid = false;
+        }
+    }
+    
+    bool fuzzy = !query.empty() && query[0] == '~';
+    string literal;
+    if (ignoreCase && !GlobMatcher::containsLiteral(query, literal)) {
+        valid = false;
+    }
+    if (!valid || query.empty() || (fuzzy && query.size() == 1) || (!fuzzy && distance >= 0)) {
+        cout << "Uso: search <consulta> [under <ruta>] [--limit N] [--offset N]" << endl;
+        cout << "     search ~<nombre> [under <ruta>] [--distance 1|2] [--limit N] [--offset N]" << endl;
+        cout << "     search *<texto>* [under <ruta>] [--ignore-case] [--limit N] [--offset N]" << endl;
+        cout << "     search --next" << endl;
+        return;
+    }
+    
+    if (fuzzy) {
+        // Por defecto 1 edición en nombres cortos y 2 en el resto
+        string name = query.substr(1);
+        if (distance < 0) {
+            distance = FuzzyMatcher::decodeUtf8(name).size() <= 4 ? 1 : 2;
+        }
+        fuzzySearchNodes(name, scopePath, distance, limit, offset);
+        return;
+    }
+    
+    if (GlobMatcher::hasWildcards(query)) {
+        globSearchNodes(query, scopePath, limit, offset, ignoreCase);
+        return;
+    }
+    
+    searchNodes(query, scopePath, limit, offset);
+}
+
+// Resolver el directorio de "under <ruta>" (vacío = todo el árbol)
+bool ConsoleInterface::resolveSearchScope(const string& scopePath, shared_ptr<TreeNode>& scope) {
+    scope = nullptr;
+    if (scopePath.empty()) return true;
+    
+    scope = resolvePath(scopePath);
+    if (!scope) {
+        cout << "Error: Ruta no encontrada: " << scopePath << endl;
+        return false;
+    }
+    return true;
+}
+
+void ConsoleInterface::searchNodes(const string& query, const string& scopePath, size_t limit, size_t offset) {
+    // Restringir a un subárbol si se indicó "under <ruta>"
+    shared_ptr<TreeNode> scope;
+    if (!resolveSearchScope(scopePath, scope)) return;
+    
+    cout << "Resultados de búsqueda para '" << query << "'";
+    if (scope) {
+        cout << " bajo " << fileSystem->getFullPath(scope);
+    }
+    cout << ":" << endl;
+    
+    // Con --limit/--offset se recorre solo la primera página
+    if (limit > 0 || offset > 0) {
+        pagedSearch = PagedSearch();
+        pagedSearch.query = query;
+        pagedSearch.scope = scope;
+        pagedSearch.scoped = scope != nullptr;
+        pagedSearch.limit = limit > 0 ? limit : 20;
+        pagedSearch.shown = offset;
+        pagedSearch.active = true;
+        printSearchPage(offset);
+        return;
+    }
+    
+    // Búsqueda por prefijo
+    auto results = searchEngine->searchByPrefix(query, scope);
+    
     if (results.empty()) {
         cout << "No se encontraron resultados" << endl;
     } else {
         for (const auto& node : results) {
-            cout << "  - " << node->name << " (ID: " << node->id 
+            cout << "  - " << node->getName() << " (ID: " << node->id 
                  << ") - Ruta: " << fileSystem->getFullPath(node) << endl;
         }
         cout << "Total: " << results.size() << " resultados" << endl;
     }
 }
 
+// Búsqueda aproximada: los resultados ya vienen ordenados por distancia,
+// --limit/--offset recortan la lista
+void ConsoleInterface::fuzzySearchNodes(const string& name, const string& scopePath, int distance,
+                                        size_t limit, size_t offset) {
+    shared_ptr<TreeNode> scope;
+    if (!resolveSearchScope(scopePath, scope)) return;
+    
+    cout << "Resultados aproximados para '" << name << "' (distancia <= " << distance << ")";
+    if (scope) {
+        cout << " bajo " << fileSystem->getFullPath(scope);
+    }
+    cout << ":" << endl;
+    
+    auto results = searchEngine->searchFuzzy(name, distance, scope);
+    if (results.empty()) {
+        cout << "No se encontraron resultados" << endl;
+        return;
+    }
+    
+    size_t first = min(offset, results.size());
+    size_t last = limit > 0 ? min(results.size(), first + limit) : results.size();
+    for (size_t i = first; i < last; i++) {
+        const auto& match = results[i];
+        cout << "  - " << match.node->getName() << " (ID: " << match.node->id
+             << ", distancia " << match.distance << ") - Ruta: "
+             << fileSystem->getFullPath(match.node) << endl;
+    }
+    
+    if (last - first < results.size()) {
+        cout << "Mostrando " << last - first << " de " << results.size() << " resultados" << endl;
+    } else {
+        cout << "Total: " << results.size() << " resultados" << endl;
+    }
+}
+
+// Búsqueda con comodines: --limit/--offset recortan la lista ordenada
+void ConsoleInterface::globSearchNodes(const string& pattern, const string& scopePath,
+                                       size_t limit, size_t offset, bool ignoreCase) {
+    shared_ptr<TreeNode> scope;
+    if (!resolveSearchScope(scopePath, scope)) return;
+    
+    cout << "Resultados para el patrón '" << pattern << "'";
+    if (scope) {
+        cout << " bajo " << fileSystem->getFullPath(scope);
+    }
+    cout << ":" << endl;
+    
+    // "*texto*" sin distinguir mayúsculas: búsqueda de subcadena directa
+    string literal;
+    auto results = ignoreCase && GlobMatcher::containsLiteral(pattern, literal)
+                       ? searchEngine->searchContains(literal, true, scope)
+                       : searchEngine->searchGlob(pattern, scope);
+    if (results.empty()) {
+        cout << "No se encontraron resultados" << endl;
+        return;
+    }
+    
+    size_t first = min(offset, results.size());
+    size_t last = limit > 0 ? min(results.size(), first + limit) : results.size();
+    for (size_t i = first; i < last; i++) {
+        cout << "  - " << results[i]->getName() << " (ID: " << results[i]->id
+             << ") - Ruta: " << fileSystem->getFullPath(results[i]) << endl;
+    }
+    
+    if (last - first < results.size()) {
+        cout << "Mostrando " << last - first << " de " << results.size() << " resultados" << endl;
+    } else {
+        cout << "Total: " << results.size() << " resultados" << endl;
+    }
+}
+
+// Mostrar la siguiente página de la búsqueda paginada de la sesión
+void ConsoleInterface::printSearchPage(size_t offset) {
+    if (!pagedSearch.active) {
+        cout << "No hay una búsqueda paginada en curso" << endl;
+        return;
+    }
+    
+    auto scope = pagedSearch.scope.lock();
+    if (pagedSearch.scoped && !fileSystem->isAttached(scope)) {
+        cout << "Error: El directorio de la búsqueda ya no existe" << endl;
+        pagedSearch.active = false;
+        return;
+    }
+    
+    auto results = searchEngine->searchByPrefixPage(pagedSearch.query, pagedSearch.limit,
+                                                    pagedSearch.cursor, offset, scope);
+    
+    size_t first = pagedSearch.shown + 1;
+    for (const auto& node : results) {
+        cout << "  - " << node->getName() << " (ID: " << node->id 
+             << ") - Ruta: " << fileSystem->getFullPath(node) << endl;
+    }
+    pagedSearch.shown += results.size();
+    
+    if (!pagedSearch.cursor.exhausted) {
+        cout << "Resultados " << first << "-" << pagedSearch.shown
+             << ". Use 'search --next' para ver más." << endl;
+    } else {
+        if (pagedSearch.shown == 0) {
+            cout << "No se encontraron resultados" << endl;
+        } else {
+            cout << "Fin de los resultados (" << pagedSearch.shown << " en total)" << endl;
+        }
+        pagedSearch.active = false;
+    }
+}
+
+// find <patrón de ruta> [--limit N]
+void ConsoleInterface::findCommand(const vector<string>& args) {
+    string pattern;
+    size_t limit = 0;
+    bool valid = args.size() > 1;
+    
+    for (size_t i = 1; i < args.size() && valid; i++) {
+        if (args[i] == "--limit" && i + 1 < args.size()) {
+            limit = stoul(args[++i]);
+        } else if (pattern.empty()) {
+            pattern = args[i];
+        } else {
+            valid = false;
+        }
+    }
+    
+    if (!valid || pattern.empty()) {
+        cout << "Uso: find <patrón> [--limit N]   (ej: find /root/docs/*/trabajo/**/*.pdf)" << endl;
+        return;
+    }
+    
+    // El último segmento puede resolverse con el índice de nombres
+    FileSystemTree::PatternStats stats;
+    auto results = fileSystem->findByPattern(pattern, currentDirectory,
+        [this](const string& leaf) { return searchEngine->searchGlob(leaf); }, &stats);
+    
+    if (results.empty()) {
+        cout << "No se encontraron resultados" << endl;
+        return;
+    }
+    
+    size_t shown = limit > 0 ? min(limit, results.size()) : results.size();
+    for (size_t i = 0; i < shown; i++) {
+        cout << "  " << fileSystem->getFullPath(results[i]) << endl;
+    }
+    
+    if (shown < results.size()) {
+        cout << "Mostrando " << shown << " de " << results.size() << " resultados" << endl;
+    } else {
+        cout << "Total: " << results.size() << " resultados" << endl;
+    }
+    chatter() << "(" << (stats.bottomUp ? "filtrado ascendente de " + to_string(stats.candidates) + " candidatos"
+                                       : "recorrido descendente, " + to_string(stats.visited) + " estados")
+              << ")" << endl;
+}
+
+// grep <consulta> [under <ruta>] [--limit N]
+void ConsoleInterface::grepCommand(const string& text) {
+    // Separar las opciones de la consulta respetando las comillas
+    vector<string> words = splitQuoted(text);
+    
+    string query, scopePath;
+    size_t limit = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i] == "--limit" && i + 1 < words.size()) {
+            limit = stoul(words[++i]);
+        } else if (words[i] == "under" && i + 1 < words.size()) {
+            scopePath = words[++i];
+        } else {
+            query += (query.empty() ? "" : " ") + words[i];
+        }
+    }
+    
+    if (ContentIndex::parseQuery(query).groups.empty()) {
+        cout << "Uso: grep <consulta> [under <ruta>] [--limit N]" << endl;
+        cout << "     grep informe anual          (ambas palabras)" << endl;
+        cout << "     grep \"informe anual\"        (frase exacta)" << endl;
+        cout << "     grep informe OR memoria     (cualquiera)" << endl;
+        return;
+    }
+    
+    shared_ptr<TreeNode> scope;
+    if (!resolveSearchScope(scopePath, scope)) return;
+    
+    auto results = searchEngine->searchContent(query, scope);
+    if (results.empty()) {
+        cout << "No se encontraron resultados" << endl;
+        return;
+    }
+    
+    size_t shown = limit > 0 ? min(limit, results.size()) : results.size();
+    for (size_t i = 0; i < shown; i++) {
+        cout << "  - " << fileSystem->getFullPath(results[i]) << " (ID: " << results[i]->id << ")" << endl;
+    }
+    
+    if (shown < results.size()) {
+        cout << "Mostrando " << shown << " de " << results.size() << " resultados" << endl;
+    } else {
+        cout << "Total: " << results.size() << " resultados" << endl;
+    }
+}
+
+// scan <patrón>... [under <ruta>] [--limit N] [--threads N]
+void ConsoleInterface::scanCommand(const string& text) {
+    vector<string> patterns;
+    string scopePath;
+    size_t limit = 0;
+    unsigned threads = 0;
+    
+    auto words = splitQuoted(text);
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i] == "--limit" && i + 1 < words.size()) {
+            limit = stoul(words[++i]);
+        } else if (words[i] == "--threads" && i + 1 < words.size()) {
+            threads = static_cast<unsigned>(stoul(words[++i]));
+        } else if (words[i] == "under" && i + 1 < words.size()) {
+            scopePath = words[++i];
+        } else {
+            string pattern = words[i];
+            if (pattern.size() >= 2 && pattern.front() == '"' && pattern.back() == '"') {
+                pattern = pattern.substr(1, pattern.size() - 2);
+            }
+            patterns.push_back(pattern);
+        }
+    }
+    
+    ContentScanner scanner(patterns);
+    if (scanner.empty()) {
+        cout << "Uso: scan <patrón> [<patrón>...] [under <ruta>] [--limit N] [--threads N]" << endl;
+        cout << "     scan TODO                   (texto literal, distingue mayúsculas)" << endl;
+        cout << "     scan \"fecha límite\" ERROR   (cualquiera de los patrones)" << endl;
+        return;
+    }
+    
+    shared_ptr<TreeNode> scope;
+    if (!resolveSearchScope(scopePath, scope)) return;
+    if (!scope) scope = fileSystem->getRoot();
+    
+    // Los resultados se imprimen a medida que llegan, en preorden
+    size_t shown = 0;
+    bool several = scanner.getPatterns().size() > 1;
+    auto stats = scanner.scan(scope, [&](const ContentScanner::FileHit& hit) {
+        cout << "  - " << fileSystem->getFullPath(hit.node->shared_from_this()) << " (ID: " << hit.node->id
+             << "): " << hit.matches << (hit.matches == 1 ? " coincidencia" : " coincidencias")
+             << ", primera en el byte " << hit.firstOffset;
+        if (several) {
+            string separator = " [";
+            for (size_t p = 0; p < hit.perPattern.size(); p++) {
+                if (hit.perPattern[p] == 0) continue;
+                cout << separator << scanner.getPatterns()[p] << " x" << hit.perPattern[p];
+                separator = ", ";
+            }
+            cout << "]";
+        }
+        cout << endl;
+        return limit == 0 || ++shown < limit;
+    }, threads);
+    
+    if (stats.matchedFiles == 0) {
+        cout << "No se encontraron resultados" << endl;
+    } else if (stats.stopped) {
+        cout << "Mostrando " << stats.matchedFiles << " archivos (límite alcanzado)" << endl;
+    } else {
+        cout << "Total: " << stats.matchedFiles << " archivos, " << stats.matches << " coincidencias" << endl;
+    }
+    
+    double gigabytesPerSecond = stats.seconds > 0 ? stats.bytes / 1e9 / stats.seconds : 0.0;
+    cout << "Escaneados " << stats.files << " archivos (" << stats.bytes << " bytes) en "
+         << stats.seconds * 1000 << " ms: " << gigabytesPerSecond << " GB/s, " << stats.threads
+         << " hilos, " << SimdSearch::instructionSet() << endl;
+}
+
 void ConsoleInterface::autocompleteSuggestions(const string& prefix) {
     cout << "Sugerencias para '" << prefix << "':" << endl;
     
@@ -655,65 +2431,130 @@ void ConsoleInterface::exportPreorder(const string& filename) {
     }
 }
 
-void ConsoleInterface::saveState(const string& filename) {
-    try {
-        string finalFilename = filename;
+void ConsoleInterface::saveState(const string& filename, bool background) {
+    string finalFilename = filename;
+    
+    // Asegurar que tenga extensión .json
+    if (finalFilename.find(".json") == string::npos) {
+        finalFilename += ".json";
+    }
+    
+    // Lee el árbol en vivo: mientras dure, las modificaciones quedan bloqueadas
+    auto tree = fileSystem;
+    auto engine = searchEngine;
+    jobs.submit("save " + finalFilename, true, [tree, engine, finalFilename](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        if (JsonHandler::saveTree(tree, finalFilename, &control)) {
+            // El índice de contenido se guarda al lado, ligado a este JSON
+            control.setPhase("índice de contenido");
+            if (!engine->saveContentIndex(finalFilename)) {
+                out << "Aviso: no se pudo guardar el índice de contenido" << endl;
+            }
+            out << "Estado guardado exitosamente en " << finalFilename << endl;
+        } else {
+            out << "Error al guardar el estado" << endl;
+        }
+        return nullptr;
+    }, background);
+}
+
+void ConsoleInterface::loadState(const string& filename, bool background) {
+    string finalFilename = filename;
+    
+    // Intentar con .json si no tiene extensión
+    if (finalFilename.find(".") == string::npos) {
+        finalFilename += ".json";
+    }
+    
+    // Se carga en un árbol aparte; el actual sigue disponible hasta terminar
+    jobs.submit("load " + finalFilename, false, [this, filename, finalFilename](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        auto stagedTree = make_shared<FileSystemTree>();
+        stagedTree->setVerbose(false);
+        
+        string loadedFrom = finalFilename;
+        bool loaded = JsonHandler::loadTree(stagedTree, finalFilename, &control);
+        
+        // Si falla, intentar sin extensión
+        if (!loaded && filename.find(".json") != string::npos && filename != finalFilename) {
+            loadedFrom = filename;
+            loaded = JsonHandler::loadTree(stagedTree, filename, &control);
+        }
         
-        // Asegurar que tenga extensión .json
-        if (finalFilename.find(".json") == string::npos) {
-            finalFilename += ".json";
+        if (!loaded) {
+            out << "Error: No se pudo cargar el archivo " << loadedFrom << endl;
+            return nullptr;
         }
         
-        if (JsonHandler::saveTree(fileSystem, finalFilename)) {
-            cout << "Estado guardado exitosamente en " << finalFilename << endl;
+        // Recrear motor de búsqueda; el contenido se lee del índice guardado
+        control.setPhase("indexando");
+        auto stagedEngine = make_shared<SearchEngine>(stagedTree, false);
+        control.checkpoint();
+        if (stagedEngine->loadContentIndex(loadedFrom)) {
+            out << "Índice de contenido leído de " << loadedFrom << ".cidx" << endl;
         } else {
-            cout << "Error al guardar el estado" << endl;
+            out << "Índice de contenido reconstruido" << endl;
         }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
-    }
+        control.checkpoint();
+        
+        out << "Estado cargado exitosamente desde " << loadedFrom << endl;
+        
+        // Mostrar árbol cargado
+        out << "\nEstructura cargada:\n";
+        stagedTree->printTree(out);
+        
+        return [this, stagedTree, stagedEngine]() {
+            installTree(stagedTree, stagedEngine);
+        };
+    }, background);
 }
 
-void ConsoleInterface::loadState(const string& filename) {
-    try {
-        string finalFilename = filename;
+// Importar una lista de rutas. Sin destino se construye un árbol nuevo
+// aparte, como load; con destino se añaden al árbol actual
+void ConsoleInterface::importPaths(const string& filename, const string& under, bool background) {
+    if (!under.empty()) {
+        if (treeLockedByJob()) return;
         
-        // Intentar con .json si no tiene extensión
-        if (finalFilename.find(".") == string::npos) {
-            finalFilename += ".json";
+        auto base = resolvePath(under);
+        if (!base || !base->isFolder()) {
+            cout << "Error: Directorio no encontrado: " << under << endl;
+            return;
         }
-        
-        // Primero intentar cargar directamente
-        if (JsonHandler::loadTree(fileSystem, finalFilename)) {
-            // Recrear motor de búsqueda
-            searchEngine = make_shared<SearchEngine>(fileSystem);
-            currentPath = "/root";
-            trashBin.clear();
-            cout << "Estado cargado exitosamente desde " << finalFilename << endl;
-            
-            // Mostrar árbol cargado
-            cout << "\nEstructura cargada:\n";
-            fileSystem->printTree();
-        } else {
-            // Si falla, intentar sin extensión
-            if (filename.find(".json") != string::npos) {
-                // Ya intentamos con .json, probar sin extensión
-                if (JsonHandler::loadTree(fileSystem, filename)) {
-                    searchEngine = make_shared<SearchEngine>(fileSystem);
-                    currentPath = "/root";
-                    trashBin.clear();
-                    cout << "Estado cargado exitosamente desde " << filename << endl;
-                    fileSystem->printTree();
-                } else {
-                    cout << "Error: No se pudo cargar el archivo " << filename << endl;
-                }
-            } else {
-                cout << "Error: No se pudo cargar el archivo " << finalFilename << endl;
-            }
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cout << "Error: No se pudo abrir el archivo " << filename << endl;
+            return;
         }
-    } catch (const exception& e) {
-        cout << "Error: " << e.what() << endl;
+        
+        auto stats = PathImporter::import(*fileSystem, base, file);
+        searchEngine->indexNewNodes(stats.createdRoots);
+        PathImporter::printStats(stats);
+        return;
     }
+    
+    jobs.submit("import " + filename, false, [this, filename](JobControl& control) -> JobManager::Completion {
+        ostream& out = control.output();
+        ifstream file(filename);
+        if (!file.is_open()) {
+            out << "Error: No se pudo abrir el archivo " << filename << endl;
+            return nullptr;
+        }
+        
+        auto stagedTree = make_shared<FileSystemTree>();
+        stagedTree->setVerbose(false);
+        auto stats = PathImporter::import(*stagedTree, stagedTree->getRoot(), file, &control);
+        
+        // Índice de búsqueda en bloque sobre el árbol terminado
+        control.setPhase("indexando");
+        auto stagedEngine = make_shared<SearchEngine>(stagedTree);
+        control.checkpoint();
+        
+        PathImporter::printStats(stats, out);
+        
+        return [this, stagedTree, stagedEngine]() {
+            installTree(stagedTree, stagedEngine);
+        };
+    }, background);
 }
 
 void ConsoleInterface::showTree() {
@@ -721,7 +2562,7 @@ void ConsoleInterface::showTree() {
 }
 
 void ConsoleInterface::showPath() {
-    cout << "Ruta actual: " << currentPath << endl;
+    cout << "Ruta actual: " << fileSystem->getFullPath(currentDirectory) << endl;
 }
 
 // Helper para parsear argumentos
@@ -737,6 +2578,24 @@ vector<string> ConsoleInterface::parseArguments(const string& input) {
     return args;
 }
 
+// Helper: separar por espacios salvo dentro de comillas (que se conservan)
+vector<string> ConsoleInterface::splitQuoted(const string& input) {
+    vector<string> words;
+    string current;
+    bool quoted = false;
+    for (char c : input) {
+        if (c == '"') quoted = !quoted;
+        if (c == ' ' && !quoted) {
+            if (!current.empty()) words.push_back(current);
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) words.push_back(current);
+    return words;
+}
+
 // Helper para trim de strings
 string ConsoleInterface::trim(const string& str) {
     size_t first = str.find_first_not_of(' ');
@@ -747,36 +2606,113 @@ string ConsoleInterface::trim(const string& str) {
     return str.substr(first, (last - first + 1));
 }
 
-// Helper para convertir ruta relativa a absoluta
-string ConsoleInterface::getAbsolutePath(const string& relativePath) {
-    if (relativePath.empty()) return currentPath;
+// Helper: resolver una ruta absoluta o relativa caminando desde el directorio actual
+shared_ptr<TreeNode> ConsoleInterface::resolvePath(const string& path) {
+    if (path.empty() || path == ".") {
+        return currentDirectory;
+    }
     
-    if (relativePath[0] == '/') {
-        // Ruta absoluta
-        return relativePath;
+    bool absolute = path[0] == '/';
+    
+    // Las rutas absolutas sin '.' ni '..' aprovechan la caché del árbol
+    if (absolute && path.find("/.") == string::npos) {
+        return fileSystem->findNodeByPath(path);
     }
     
-    // Ruta relativa
-    if (relativePath == "..") {
-        // Subir un nivel
-        size_t lastSlash = currentPath.find_last_of('/');
-        if (lastSlash != string::npos && lastSlash > 0) {
-            return currentPath.substr(0, lastSlash);
+    shared_ptr<TreeNode> current = absolute ? fileSystem->getRoot() : currentDirectory;
+    bool firstComponent = true;
+    size_t start = 0;
+    
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == string::npos) {
+            end = path.size();
         }
-        return "/root";
+        
+        if (end > start) {
+            string component = path.substr(start, end - start);
+            
+            if (component == "..") {
+                // Subir un nivel; en la raíz se queda en la raíz
+                if (auto parent = current->parent.lock()) {
+                    current = parent;
+                }
+            } else if (component == "." || (absolute && firstComponent && component == "root")) {
+                // Directorio actual o nombre explícito de la raíz
+            } else {
+                current = current->findChild(component);
+                if (!current) {
+                    return nullptr;
+                }
+            }
+            firstComponent = false;
+        }
+        
+        start = end + 1;
     }
     
-    if (relativePath == ".") {
-        // Directorio actual
-        return currentPath;
+    return current;
+}
+
+// Helper: resolver el directorio padre de una ruta y separar el último nombre
+shared_ptr<TreeNode> ConsoleInterface::resolveParent(const string& path, string& name) {
+    size_t lastSlash = path.find_last_of('/');
+    if (lastSlash == string::npos) {
+        name = path;
+        return currentDirectory;
     }
     
-    // Concatenar con directorio actual
-    if (currentPath == "/") {
-        return currentPath + relativePath;
-    } else {
-        return currentPath + "/" + relativePath;
+    name = path.substr(lastSlash + 1);
+    return resolvePath(lastSlash == 0 ? "/" : path.substr(0, lastSlash));
+}
+
+// Helper: ruta absoluta sin '.' ni '..'. Las transacciones guardan rutas y
+// las resuelven al aplicarse, cuando el directorio actual puede ser otro
+string ConsoleInterface::absolutePath(const string& path) {
+    bool absolute = !path.empty() && path[0] == '/';
+    string full = absolute ? path : fileSystem->getFullPath(currentDirectory) + "/" + path;
+    
+    vector<string> components;
+    bool firstComponent = true;
+    size_t start = 0;
+    while (start < full.size()) {
+        size_t end = full.find('/', start);
+        if (end == string::npos) {
+            end = full.size();
+        }
+        
+        if (end > start) {
+            string component = full.substr(start, end - start);
+            if (component == "..") {
+                if (!components.empty()) components.pop_back();
+            } else if (component != "." && !(firstComponent && component == "root")) {
+                components.push_back(component);
+            }
+            firstComponent = false;
+        }
+        start = end + 1;
+    }
+    
+    string result = "/root";
+    for (const auto& component : components) {
+        result += "/" + component;
     }
+    return result;
+}
+
+// Helper: si el directorio actual fue eliminado o el árbol cambió, volver a la raíz
+void ConsoleInterface::ensureCurrentDirectory() {
+    if (!fileSystem->isAttached(currentDirectory)) {
+        currentDirectory = fileSystem->getRoot();
+    }
+}
+
+// Helper: mensaje de creación de nodo
+void ConsoleInterface::printCreated(shared_ptr<TreeNode> node) {
+    chatter() << "Nodo creado: ID=" << node->id 
+         << ", Nombre=" << node->getName() 
+         << ", Tipo=" << (node->isFolder() ? "CARPETA" : "ARCHIVO")
+         << endl;
 }
 
 // ============================================
@@ -784,118 +2720,167 @@ string ConsoleInterface::getAbsolutePath(const string& relativePath) {
 // ============================================
 
 void ConsoleInterface::listTrash() {
-    if (trashBin.empty()) {
+    auto items = trash.items();
+    if (items.empty()) {
         cout << "La papelera está vacía." << endl;
         return;
     }
     
     cout << "\n=== PAPELERA TEMPORAL ===" << endl;
-    cout << "Elementos: " << trashBin.size() << endl;
+    cout << "Elementos: " << items.size() << endl;
     cout << "==========================" << endl;
     
-    for (size_t i = 0; i < trashBin.size(); ++i) {
-        auto& item = trashBin[i];
-        auto node = item.node;
-        string tipo = node->isFolder() ? "[CARPETA]" : "[ARCHIVO]";
-        cout << i+1 << ". " << tipo << " " << node->name 
-             << " (ID: " << node->id << ")" << endl;
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto& item = items[i];
+        string tipo = item.folder ? "[CARPETA]" : "[ARCHIVO]";
+        cout << i+1 << ". " << tipo << " " << item.name 
+             << " (ID: " << item.id << ")";
+        if (item.folder && item.nodeCount > 0) {
+            cout << " - " << item.nodeCount << " nodos";
+        }
+        if (item.spilled) {
+            cout << " [en disco]";
+        }
+        cout << endl;
         cout << "    Ruta original: " << item.originalPath << endl;
     }
 }
 
+void ConsoleInterface::configureTrash(const vector<string>& args) {
+    const string& option = args[1];
+    
+    if (option == "stats") {
+        trash.printStats();
+    } else if (option == "ttl" && args.size() > 2) {
+        trash.setTtl(stoll(args[2]));
+        cout << "Caducidad de la papelera: " << args[2] << " s" << endl;
+    } else if (option == "quota" && args.size() > 3) {
+        trash.setQuota(stoul(args[2]), stoll(args[3]) << 20);
+        cout << "Cuota de la papelera: " << args[2] << " elementos, " << args[3] << " MB" << endl;
+    } else if (option == "spill" && args.size() > 2) {
+        trash.setSpillThreshold(stoll(args[2]));
+        cout << "Volcado a disco desde " << args[2] << " nodos" << endl;
+    } else {
+        cout << "Uso: trash [stats | ttl <seg> | quota <elementos> <MB> | spill <nodos>]" << endl;
+    }
+}
+
 void ConsoleInterface::restoreFromTrash(const string& name) {
-    // Buscar nodo en la papelera
-    for (auto it = trashBin.begin(); it != trashBin.end(); ++it) {
-        if (it->node->name == name) {
-            auto& item = *it;
-            
-            try {
-                // Determinar dónde restaurar el nodo
-                shared_ptr<TreeNode> parentNode = nullptr;
-                
-                if (item.parent) {
-                    // Intentar restaurar en el padre original
-                    parentNode = item.parent;
-                    
-                    // Verificar que el padre todavía existe en el árbol
-                    // Si no existe, restaurar en /root
-                    if (!fileSystem->isNodeInTree(parentNode)) {
-                        parentNode = fileSystem->findNodeByPath("/root");
-                        if (!parentNode) {
-                            cout << "Error: El padre original ya no existe y no se encontró /root" << endl;
-                            return;
-                        }
-                        cout << "Nota: El padre original ya no existe, restaurando en /root" << endl;
-                    } else {
-                        cout << "Restaurando en el directorio original." << endl;
-                    }
-                } else {
-                    // Si no hay padre original, restaurar en /root
-                    parentNode = fileSystem->findNodeByPath("/root");
-                    if (!parentNode) {
-                        cout << "Error: No se encontró el directorio raíz (/root)" << endl;
-                        return;
-                    }
-                    cout << "Nota: Restaurando en el directorio raíz (/root)" << endl;
-                }
-                
-                // Verificar si ya existe un nodo con el mismo nombre en el directorio destino
-                bool nameExists = false;
-                for (const auto& child : parentNode->children) {
-                    if (child->name == name) {
-                        nameExists = true;
-                        break;
-                    }
-                }
-                
-                if (nameExists) {
-                    cout << "Error: Ya existe un nodo con el nombre '" << name 
-                         << "' en el directorio de destino." << endl;
-                    return;
-                }
-                
-                // Restaurar el nodo al árbol
-                item.node->parent = parentNode;
-                parentNode->children.push_back(item.node);
-                
-                // Reindexar el nodo en el motor de búsqueda
-                searchEngine->indexNode(item.node);
-                
-                // Remover de la papelera
-                trashBin.erase(it);
-                
-                cout << "Nodo '" << name << "' restaurado exitosamente en: " 
-                     << fileSystem->getFullPath(parentNode) << endl;
-                
-                return;
-                
-            } catch (const exception& e) {
-                cout << "Error al restaurar: " << e.what() << endl;
-                return;
-            }
-        }
+    TrashBin::ItemInfo item;
+    shared_ptr<TreeNode> parentNode;
+    if (!trash.lookup(name, item, parentNode)) {
+        cout << "Error: No se encontró '" << name << "' en la papelera." << endl;
+        return;
     }
     
-    cout << "Error: No se encontró '" << name << "' en la papelera." << endl;
+    try {
+        // Restaurar en el padre original si sigue conectado al árbol;
+        // si no, restaurar en /root
+        if (parentNode && fileSystem->isAttached(parentNode)) {
+            cout << "Restaurando en el directorio original." << endl;
+        } else {
+            parentNode = fileSystem->getRoot();
+            cout << "Nota: El padre original ya no existe, restaurando en /root" << endl;
+        }
+        
+        // Verificar si ya existe un nodo con el mismo nombre en el directorio destino
+        if (parentNode->findChild(item.name)) {
+            cout << "Error: Ya existe un nodo con el nombre '" << item.name 
+                 << "' en el directorio de destino." << endl;
+            return;
+        }
+        
+        // Sacar de la papelera (se lee de disco si fue volcado)
+        auto node = trash.take(item.id);
+        if (!node) {
+            cout << "Error: '" << name << "' ya no está en la papelera." << endl;
+            return;
+        }
+        
+        // Restaurar el nodo al árbol
+        fileSystem->restoreNode(parentNode, node);
+        
+        // Quitar la lápida (o reindexar si se leyó de disco)
+        searchEngine->restoreNode(node);
+        
+        cout << "Nodo '" << item.name << "' restaurado exitosamente en: " 
+             << fileSystem->getFullPath(parentNode) << endl;
+        
+    } catch (const exception& e) {
+        cout << "Error al restaurar: " << e.what() << endl;
+    }
 }
 
-void ConsoleInterface::emptyTrash() {
-    if (trashBin.empty()) {
+void ConsoleInterface::emptyTrash(bool force) {
+    size_t items = trash.size();
+    if (items == 0) {
         cout << "La papelera ya está vacía." << endl;
         return;
     }
     
-    cout << "¿Está seguro de vaciar la papelera? (" << trashBin.size() 
-         << " elementos) [s/N]: ";
-    
-    string respuesta;
-    getline(cin, respuesta);
+    string respuesta = "s";
+    if (!force) {
+        cout << "¿Está seguro de vaciar la papelera? (" << items 
+             << " elementos) [s/N]: ";
+        if (!getline(*input, respuesta)) {
+            cout << endl << "Sin confirmación; use 'emptytrash -f' en modo no interactivo." << endl;
+        }
+    }
     
     if (respuesta == "s" || respuesta == "S") {
         cout << "Vaciando papelera..." << endl;
-        trashBin.clear();
+        discardTrash();
+        searchEngine->scheduleCompaction();
         cout << "Papelera vaciada permanentemente." << endl;
     } else {
         cout << "Operación cancelada." << endl;
     }
-}
\ No newline at end of file
+}
+
+// Entregar los elementos de la papelera al recolector diferido
+void ConsoleInterface::discardTrash() {
+    trash.clear();
+}
+
+// Instalar un árbol ya construido (generate/load) con su índice
+void ConsoleInterface::installTree(shared_ptr<FileSystemTree> tree, shared_ptr<SearchEngine> engine) {
+    tree->setVerbose(!quiet);
+    fileSystem = tree;
+    searchEngine = engine;
+    currentDirectory = fileSystem->getRoot();
+    discardTrash();
+    trashPurged = false;  // El índice nuevo no tiene lápidas
+    pagedSearch = PagedSearch();
+}
+
+// Trabajos en segundo plano
+void ConsoleInterface::listJobs() {
+    jobs.list(cout);
+}
+
+void ConsoleInterface::cancelJob(const string& id) {
+    int jobId = atoi(id.c_str());
+    if (jobs.cancel(jobId)) {
+        cout << "Cancelación solicitada para el trabajo [" << jobId << "]" << endl;
+    } else {
+        cout << "Error: No hay un trabajo en curso con id " << id << endl;
+    }
+}
+
+void ConsoleInterface::waitJobs(const string& id) {
+    int jobId = id.empty() ? 0 : atoi(id.c_str());
+    if (!jobs.wait(jobId, cout)) {
+        cout << "Error: No existe el trabajo " << id << endl;
+    }
+}
+
+// Comprobar si un trabajo está leyendo el árbol en vivo
+bool ConsoleInterface::treeLockedByJob() {
+    string description;
+    if (!jobs.treeReaderActive(description)) {
+        return false;
+    }
+    cout << "Error: El árbol está en uso por el trabajo " << description
+         << "; use 'wait' o 'cancel' antes de modificarlo." << endl;
+    return true;
+}
@@ -4,23 +4,56 @@
 #include "FileSystemTree.hpp"
 #include "SearchEngine.hpp"
 #include "JsonHandler.hpp"
+#include "JobManager.hpp"
+#include "TrashBin.hpp"
+#include "NodeRegistry.hpp"
 #include <memory>
+#include <iostream>
 #include <string>
 #include <vector>
+#include <atomic>
 using namespace std;
 
 class ConsoleInterface {
-private:
-    struct TrashItem {
-        shared_ptr<TreeNode> node;
-        string originalPath;
-        shared_ptr<TreeNode> parent;
+public:
+    // Búsqueda paginada en curso de una sesión (search --limit / --next)
+    struct PagedSearch {
+        string query;
+        weak_ptr<TreeNode> scope;
+        bool scoped;
+        size_t limit;
+        size_t shown;
+        SearchEngine::Cursor cursor;
+        bool active;
+        
+        PagedSearch() : scoped(false), limit(0), shown(0), active(false) {}
+    };
+    
+    // Transacción abierta de una sesión (batch begin / commit)
+    struct PendingBatch {
+        FileSystemTree::Batch batch;
+        bool open;
+        
+        PendingBatch() : open(false) {}
     };
     
+private:
     shared_ptr<FileSystemTree> fileSystem;
     shared_ptr<SearchEngine> searchEngine;
-    string currentPath;
-    vector<TrashItem> trashBin;
+    shared_ptr<TreeNode> currentDirectory;  // Sesión: carpeta actual como referencia al nodo
+    PagedSearch pagedSearch;                // Sesión: página de búsqueda pendiente
+    PendingBatch pendingBatch;              // Sesión: transacción abierta
+    atomic<bool> trashPurged;  // La papelera purgó: compactar el índice
+    TrashBin trash;            // Después del aviso: su hilo lo usa hasta el final
+    
+    // Modo por lotes
+    bool quiet;          // Silenciar mensajes por operación
+    istream* input;      // Origen de comandos y confirmaciones
+    ostream silent;      // Stream sin destino para el modo silencioso
+    
+    // Trabajos largos en segundo plano (generate, save, load, ...)
+    bool asyncJobs;      // En scripts se ejecutan en el hilo de la consola
+    JobManager jobs;     // Último miembro: se detiene antes que el resto
     
     // Comandos internos
     void processCommand(const string& command);
@@ -32,35 +65,84 @@ private:
     void moveNode(const string& source, const string& dest);
     void removeNode(const string& path);
     void renameNode(const string& path, const string& newName);
-    void searchNodes(const string& query);
+    void searchCommand(const vector<string>& args);
+    void searchNodes(const string& query, const string& scopePath = "", size_t limit = 0, size_t offset = 0);
+    void printSearchPage(size_t offset = 0);
+    void fuzzySearchNodes(const string& name, const string& scopePath, int distance,
+                          size_t limit = 0, size_t offset = 0);
+    void globSearchNodes(const string& pattern, const string& scopePath,
+                         size_t limit = 0, size_t offset = 0, bool ignoreCase = false);
+    bool resolveSearchScope(const string& scopePath, shared_ptr<TreeNode>& scope);
+    void batchCommand(const vector<string>& args);
+    bool queueBatchOperation(const vector<string>& args);
+    void findCommand(const vector<string>& args);
+    void grepCommand(const string& text);
+    void scanCommand(const string& text);
     void autocompleteSuggestions(const string& prefix);
     void exportPreorder(const string& filename);
-    void saveState(const string& filename);
-    void loadState(const string& filename);
+    void saveState(const string& filename, bool background = false);
+    void loadState(const string& filename, bool background = false);
+    void importPaths(const string& filename, const string& under, bool background = false);
     void showTree();
     void showPath();
 
     void listTrash();
+    void configureTrash(const vector<string>& args);
     void restoreFromTrash(const string& name);
-    void emptyTrash();
+    void emptyTrash(bool force = false);
+    void discardTrash();
     
     // Días 10-11: Pruebas de integración y rendimiento
     void runIntegrationTests();
-    void runPerformanceTests();
+    void runPerformanceTests(bool background = false);
     void runEdgeCaseTests();
     void showSystemStats();
     void validateSystem();
-    void generateTestTree(int levels, int children);
-    void benchmarkOperations();
+    void showLeaks();
+    void showOrphans(bool reclaim = false);
+    void generateTestTree(int levels, int children, bool background = false);
+    void benchmarkOperations(bool background = false);
+    void benchmarkFuzzy(bool background = false);
+    void benchmarkGrep(bool background = false);
+    void benchmarkScan(bool background = false);
+    void benchmarkContains(bool background = false);
+    void benchmarkMemory(bool background = false);
+    void benchmarkSnapshot(bool background = false);
+    
+    // Trabajos en segundo plano
+    void listJobs();
+    void cancelJob(const string& id);
+    void waitJobs(const string& id);
+    bool treeLockedByJob();
     
     // Helpers
     vector<string> parseArguments(const string& input);
+    vector<string> splitQuoted(const string& input);
     string trim(const string& str);
-    string getAbsolutePath(const string& relativePath);
+    shared_ptr<TreeNode> resolvePath(const string& path);
+    shared_ptr<TreeNode> resolveParent(const string& path, string& name);
+    string absolutePath(const string& path);
+    void ensureCurrentDirectory();
+    void printCreated(shared_ptr<TreeNode> node);
+    void installTree(shared_ptr<FileSystemTree> tree, shared_ptr<SearchEngine> engine);
+    NodeRegistry::Census takeCensus();
+    ostream& chatter();
 
 public:
     ConsoleInterface();
     void run();
+    
+    // Ejecutar comandos desde un archivo o stdin sin interacción
+    void runScript(istream& script, bool quietMode = false);
+    
+    // Ejecutar un comando para una sesión remota (modo servidor).
+    // sessionDirectory, sessionSearch y sessionBatch son el estado de esa
+    // sesión y se actualizan; session (> 0) identifica sus trabajos.
+    string executeCommand(const string& command, int session, shared_ptr<TreeNode>& sessionDirectory,
+                          PagedSearch& sessionSearch, PendingBatch& sessionBatch);
+    
+    // Cerrar una sesión remota: sus trabajos se cancelan
+    void endSession(int session);
 };
 
 #endif // CONSOLEINTERFACE_HPP
\ No newline at end of file
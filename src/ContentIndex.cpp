@@ -0,0 +1,589 @@
+#include "ContentIndex.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+using namespace std;
+
+namespace {
+    const char MAGIC[4] = {'C', 'I', 'D', 'X'};
+    const uint32_t FORMAT_VERSION = 1;
+
+    void writeVarint(vector<uint8_t>& bytes, uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t readVarint(const vector<uint8_t>& bytes, size_t& offset) {
+        uint64_t value = 0;
+        int shift = 0;
+        while (offset < bytes.size()) {
+            uint8_t byte = bytes[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+        return value;
+    }
+
+    bool isTokenByte(unsigned char c) {
+        return isalnum(c) || c == '_' || c >= 0x80;
+    }
+
+    // Escritura binaria (mismo orden de bytes que la máquina)
+    template<typename T>
+    void writeValue(ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool readValue(istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    void writeBytes(ostream& out, const void* data, uint64_t size) {
+        writeValue(out, size);
+        out.write(static_cast<const char*>(data), size);
+    }
+
+    template<typename T>
+    bool readVector(istream& in, vector<T>& data, uint64_t limit) {
+        uint64_t size;
+        if (!readValue(in, size) || size % sizeof(T) != 0 || size / sizeof(T) > limit) return false;
+        data.resize(size / sizeof(T));
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(data.data()), size));
+    }
+}
+
+// Lector secuencial
+ContentIndex::Cursor::Cursor(const PostingList* list)
+    : list(list), offset(0), index(0), doc(-1), finished(false) {
+    next();
+}
+
+void ContentIndex::Cursor::next() {
+    if (index >= list->docCount) {
+        finished = true;
+        return;
+    }
+
+    doc += static_cast<int>(readVarint(list->bytes, offset));
+    size_t count = readVarint(list->bytes, offset);
+    positions.resize(count);
+    uint32_t position = 0;
+    for (size_t i = 0; i < count; i++) {
+        position += static_cast<uint32_t>(readVarint(list->bytes, offset));
+        positions[i] = position;
+    }
+    index++;
+}
+
+void ContentIndex::Cursor::advanceTo(int target) {
+    if (finished || doc >= target) return;
+
+    // Último bloque que empieza antes de target, si queda por delante
+    auto it = lower_bound(list->skips.begin(), list->skips.end(), target,
+        [](const pair<int, uint32_t>& skip, int value) { return skip.first < value; });
+    if (it != list->skips.begin()) {
+        --it;
+        size_t block = static_cast<size_t>(it - list->skips.begin()) * SKIP_INTERVAL;
+        if (block >= index) {
+            index = block;
+            offset = it->second;
+            doc = it->first;
+            next();
+        }
+    }
+
+    while (!finished && doc < target) {
+        next();
+    }
+}
+
+ContentIndex::ContentIndex() : documentCount(0), removedCount(0) {}
+
+// Helper: añadir un documento al final de una lista
+void ContentIndex::appendDoc(PostingList& list, int doc, const vector<uint32_t>& positions) {
+    if (list.docCount % SKIP_INTERVAL == 0) {
+        list.skips.push_back({list.lastDoc, static_cast<uint32_t>(list.bytes.size())});
+    }
+
+    writeVarint(list.bytes, static_cast<uint64_t>(doc - list.lastDoc));
+    writeVarint(list.bytes, positions.size());
+    uint32_t previous = 0;
+    for (uint32_t position : positions) {
+        writeVarint(list.bytes, position - previous);
+        previous = position;
+    }
+
+    list.lastDoc = doc;
+    list.docCount++;
+}
+
+// Helper: rehacer una lista a partir de documentos ordenados
+void ContentIndex::rebuildList(PostingList& list, vector<pair<int, vector<uint32_t>>>& docs) {
+    list = PostingList();
+    for (const auto& doc : docs) {
+        appendDoc(list, doc.first, doc.second);
+    }
+    list.bytes.shrink_to_fit();
+}
+
+// Helper: decodificar una lista completa
+void ContentIndex::decodeList(const PostingList& list, vector<pair<int, vector<uint32_t>>>& docs) {
+    docs.clear();
+    docs.reserve(list.docCount);
+    for (Cursor cursor(&list); cursor.valid(); cursor.next()) {
+        docs.push_back({cursor.current(), cursor.currentPositions()});
+    }
+}
+
+// Helper: fusionar los documentos pendientes en las listas. Si todos los
+// IDs nuevos de un término son mayores que el último, basta con añadirlos
+void ContentIndex::flush() {
+    if (pending.empty()) return;
+
+    sort(pending.begin(), pending.end(), [](const PendingDoc& a, const PendingDoc& b) {
+        return a.id < b.id;
+    });
+
+    unordered_map<string, vector<pair<int, vector<uint32_t>>>> additions;
+    for (auto& doc : pending) {
+        for (auto& term : doc.terms) {
+            additions[term.first].push_back({doc.id, std::move(term.second)});
+        }
+    }
+    pending.clear();
+
+    vector<pair<int, vector<uint32_t>>> merged;
+    for (auto& addition : additions) {
+        PostingList& list = postings[addition.first];
+        auto& docs = addition.second;
+
+        if (docs.front().first > list.lastDoc) {
+            for (const auto& doc : docs) {
+                appendDoc(list, doc.first, doc.second);
+            }
+            continue;
+        }
+
+        decodeList(list, merged);
+        size_t middle = merged.size();
+        merged.insert(merged.end(), docs.begin(), docs.end());
+        inplace_merge(merged.begin(), merged.begin() + middle, merged.end(),
+            [](const pair<int, vector<uint32_t>>& a, const pair<int, vector<uint32_t>>& b) {
+                return a.first < b.first;
+            });
+        rebuildList(list, merged);
+    }
+}
+
+bool ContentIndex::isLive(int doc) const {
+    return doc >= 0 && static_cast<size_t>(doc) < indexed.size() && indexed[doc] && !removed[doc];
+}
+
+// 1. Separar un texto en términos
+vector<string> ContentIndex::tokenize(const string& text) {
+    vector<string> tokens;
+    string current;
+    for (unsigned char c : text) {
+        if (isTokenByte(c)) {
+            current += static_cast<char>(c < 0x80 ? tolower(c) : c);
+        } else if (!current.empty()) {
+            tokens.push_back(std::move(current));
+            current.clear();
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(std::move(current));
+    }
+    return tokens;
+}
+
+// 2. Analizar una consulta
+ContentIndex::Query ContentIndex::parseQuery(const string& text) {
+    Query query;
+    query.groups.emplace_back();
+
+    size_t i = 0;
+    while (i < text.size()) {
+        if (isspace(static_cast<unsigned char>(text[i]))) {
+            i++;
+            continue;
+        }
+
+        string word;
+        if (text[i] == '"') {
+            size_t end = text.find('"', i + 1);
+            if (end == string::npos) end = text.size();
+            word = text.substr(i + 1, end - i - 1);
+            i = end + 1;
+        } else {
+            size_t end = i;
+            while (end < text.size() && !isspace(static_cast<unsigned char>(text[end]))) end++;
+            word = text.substr(i, end - i);
+            i = end;
+
+            if (word == "OR") {
+                if (!query.groups.back().empty()) query.groups.emplace_back();
+                continue;
+            }
+        }
+
+        // Una palabra con separadores ("foo-bar") se trata como frase
+        auto phrase = tokenize(word);
+        if (!phrase.empty()) {
+            query.groups.back().push_back(phrase);
+        }
+    }
+
+    if (query.groups.back().empty()) {
+        query.groups.pop_back();
+    }
+    return query;
+}
+
+// 3. Añadir un documento
+void ContentIndex::addDocument(int id, const string& content) {
+    if (id < 0 || content.empty()) return;
+
+    if (static_cast<size_t>(id) >= indexed.size()) {
+        indexed.resize(id + 1, 0);
+        removed.resize(id + 1, 0);
+    }
+
+    // Parte de sus listas puede estar ya purgada: se indexa de nuevo al
+    // terminar la purga
+    if (static_cast<size_t>(id) < purging.size() && purging[id]) {
+        revived.push_back({id, content});
+        return;
+    }
+
+    // El contenido no cambia: un documento ya indexado solo se reactiva
+    if (indexed[id]) {
+        if (removed[id]) {
+            removed[id] = 0;
+            removedCount--;
+        }
+        return;
+    }
+
+    unordered_map<string, vector<uint32_t>> terms;
+    auto tokens = tokenize(content);
+    for (size_t i = 0; i < tokens.size(); i++) {
+        terms[tokens[i]].push_back(static_cast<uint32_t>(i));
+    }
+    if (terms.empty()) return;
+
+    // Con IDs crecientes (lo habitual al indexar el árbol) se añade al final
+    // de la lista; el resto espera a la fusión
+    PendingDoc doc;
+    doc.id = id;
+    for (auto& term : terms) {
+        PostingList& list = postings[term.first];
+        if (id > list.lastDoc) {
+            appendDoc(list, id, term.second);
+        } else {
+            doc.terms.push_back({term.first, std::move(term.second)});
+        }
+    }
+    if (!doc.terms.empty()) {
+        pending.push_back(std::move(doc));
+    }
+
+    indexed[id] = 1;
+    documentCount++;
+}
+
+// 4. Retirar un documento
+void ContentIndex::removeDocument(int id) {
+    // Reactivado y retirado otra vez durante la purga
+    if (static_cast<size_t>(id) < purging.size() && purging[id]) {
+        revived.erase(remove_if(revived.begin(), revived.end(),
+            [id](const pair<int, string>& document) { return document.first == id; }), revived.end());
+        return;
+    }
+    if (id >= 0 && static_cast<size_t>(id) < indexed.size() && indexed[id] && !removed[id]) {
+        removed[id] = 1;
+        removedCount++;
+    }
+}
+
+// Helper: intersección de un grupo AND. Avanza todas las listas a la vez
+// empezando por la más corta y usa los saltos para no decodificar el resto.
+vector<int> ContentIndex::matchGroup(const vector<vector<string>>& phrases) {
+    vector<int> result;
+
+    // Un cursor por término distinto
+    vector<string> terms;
+    for (const auto& phrase : phrases) {
+        for (const auto& term : phrase) {
+            if (find(terms.begin(), terms.end(), term) == terms.end()) {
+                terms.push_back(term);
+            }
+        }
+    }
+
+    vector<const PostingList*> lists;
+    for (const auto& term : terms) {
+        auto it = postings.find(term);
+        if (it == postings.end()) return result;
+        lists.push_back(&it->second);
+    }
+
+    vector<size_t> order(terms.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return lists[a]->docCount < lists[b]->docCount;
+    });
+
+    vector<Cursor> cursors;
+    cursors.reserve(terms.size());
+    for (size_t i : order) {
+        cursors.emplace_back(lists[i]);
+    }
+    vector<size_t> cursorOf(terms.size());
+    for (size_t k = 0; k < order.size(); k++) {
+        cursorOf[order[k]] = k;
+    }
+    auto cursorFor = [&](const string& term) -> Cursor& {
+        size_t i = find(terms.begin(), terms.end(), term) - terms.begin();
+        return cursors[cursorOf[i]];
+    };
+
+    while (cursors[0].valid()) {
+        int candidate = cursors[0].current();
+        bool aligned = true;
+
+        for (size_t k = 1; k < cursors.size(); k++) {
+            cursors[k].advanceTo(candidate);
+            if (!cursors[k].valid()) return result;
+            if (cursors[k].current() != candidate) {
+                cursors[0].advanceTo(cursors[k].current());
+                aligned = false;
+                break;
+            }
+        }
+        if (!aligned) continue;
+
+        // Frases: cada palabra debe aparecer justo después de la anterior
+        bool matches = isLive(candidate);
+        for (const auto& phrase : phrases) {
+            if (!matches || phrase.size() < 2) continue;
+
+            matches = false;
+            for (uint32_t start : cursorFor(phrase[0]).currentPositions()) {
+                bool all = true;
+                for (size_t w = 1; w < phrase.size() && all; w++) {
+                    const auto& positions = cursorFor(phrase[w]).currentPositions();
+                    all = binary_search(positions.begin(), positions.end(), start + static_cast<uint32_t>(w));
+                }
+                if (all) {
+                    matches = true;
+                    break;
+                }
+            }
+        }
+
+        if (matches) {
+            result.push_back(candidate);
+        }
+        cursors[0].next();
+    }
+
+    return result;
+}
+
+// 5. Buscar
+vector<int> ContentIndex::search(const Query& query) {
+    flush();
+
+    vector<int> result;
+    vector<int> merged;
+    for (const auto& group : query.groups) {
+        vector<int> docs = matchGroup(group);
+        merged.clear();
+        set_union(result.begin(), result.end(), docs.begin(), docs.end(), back_inserter(merged));
+        result.swap(merged);
+    }
+    return result;
+}
+
+// 6. Purga por tramos
+size_t ContentIndex::beginPurge(const function<bool(int)>& isDead) {
+    flush();
+
+    // Una purga sin terminar se amplía: sus marcas se conservan y se
+    // vuelven a revisar todos los términos
+    purging.resize(indexed.size(), 0);
+    for (size_t id = 0; id < indexed.size(); id++) {
+        if (indexed[id] && !purging[id] && (removed[id] || isDead(static_cast<int>(id)))) {
+            purging[id] = 1;
+            purgingDocs.push_back(static_cast<int>(id));
+        }
+    }
+    if (purgingDocs.empty()) {
+        purging.clear();
+        return 0;
+    }
+    sort(purgingDocs.begin(), purgingDocs.end());
+
+    purgeQueue.clear();
+    purgeQueue.reserve(postings.size());
+    for (const auto& entry : postings) {
+        purgeQueue.push_back(entry.first);
+    }
+    return purgingDocs.size();
+}
+
+bool ContentIndex::purgeStep(size_t maxTerms) {
+    vector<pair<int, vector<uint32_t>>> docs;
+    for (size_t done = 0; done < maxTerms && !purgeQueue.empty(); done++) {
+        auto it = postings.find(purgeQueue.back());
+        purgeQueue.pop_back();
+        if (it == postings.end() || !containsPurged(it->second)) continue;
+
+        decodeList(it->second, docs);
+        docs.erase(remove_if(docs.begin(), docs.end(),
+            [&](const pair<int, vector<uint32_t>>& doc) {
+                // Los añadidos entre tramos pueden quedar fuera de las marcas
+                return static_cast<size_t>(doc.first) < purging.size() && purging[doc.first] != 0;
+            }), docs.end());
+        if (docs.empty()) {
+            postings.erase(it);
+        } else {
+            rebuildList(it->second, docs);
+        }
+    }
+
+    if (!purgeQueue.empty()) return false;
+    finishPurge();
+    return true;
+}
+
+// Helper: la lista tiene algún documento marcado. Se salta con el cursor
+// de uno marcado al siguiente en lugar de decodificarla entera
+bool ContentIndex::containsPurged(const PostingList& list) const {
+    Cursor cursor(&list);
+    for (int id : purgingDocs) {
+        if (id > list.lastDoc) break;
+        cursor.advanceTo(id);
+        if (!cursor.valid()) return false;
+        if (cursor.current() == id) return true;
+    }
+    return false;
+}
+
+// Helper: dar de baja los documentos purgados y volver a indexar los que
+// se reactivaron entre tramos
+void ContentIndex::finishPurge() {
+    for (int id : purgingDocs) {
+        if (removed[id]) removedCount--;
+        indexed[id] = removed[id] = 0;
+        documentCount--;
+    }
+    purging.clear();
+    purgingDocs.clear();
+
+    vector<pair<int, string>> pendingRevivals;
+    pendingRevivals.swap(revived);
+    for (const auto& document : pendingRevivals) {
+        addDocument(document.first, document.second);
+    }
+}
+
+// 7. Persistencia binaria
+void ContentIndex::save(ostream& out, uint64_t fingerprint) {
+    flush();
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeValue(out, FORMAT_VERSION);
+    writeValue(out, fingerprint);
+    writeValue(out, static_cast<uint64_t>(documentCount));
+    writeValue(out, static_cast<uint64_t>(removedCount));
+    writeBytes(out, indexed.data(), indexed.size());
+    writeBytes(out, removed.data(), removed.size());
+
+    writeValue(out, static_cast<uint64_t>(postings.size()));
+    for (const auto& entry : postings) {
+        const PostingList& list = entry.second;
+        writeBytes(out, entry.first.data(), entry.first.size());
+        writeValue(out, static_cast<int64_t>(list.lastDoc));
+        writeValue(out, static_cast<uint64_t>(list.docCount));
+        writeBytes(out, list.bytes.data(), list.bytes.size());
+        writeBytes(out, list.skips.data(), list.skips.size() * sizeof(list.skips[0]));
+    }
+}
+
+bool ContentIndex::load(istream& in, uint64_t fingerprint) {
+    clear();
+
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint64_t storedFingerprint, documents, removedDocs, termTotal;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readValue(in, version) || version != FORMAT_VERSION ||
+        !readValue(in, storedFingerprint) || storedFingerprint != fingerprint ||
+        !readValue(in, documents) || !readValue(in, removedDocs)) {
+        return false;
+    }
+
+    const uint64_t limit = uint64_t(1) << 40;
+    bool ok = readVector(in, indexed, limit) && readVector(in, removed, limit) &&
+              indexed.size() == removed.size() && readValue(in, termTotal);
+
+    for (uint64_t t = 0; ok && t < termTotal; t++) {
+        vector<char> name;
+        int64_t lastDoc;
+        uint64_t docCount;
+        PostingList list;
+        ok = readVector(in, name, limit) && readValue(in, lastDoc) && readValue(in, docCount) &&
+             readVector(in, list.bytes, limit) && readVector(in, list.skips, limit);
+        if (ok) {
+            list.lastDoc = static_cast<int>(lastDoc);
+            list.docCount = docCount;
+            postings.emplace(string(name.begin(), name.end()), std::move(list));
+        }
+    }
+
+    if (!ok) {
+        clear();
+        return false;
+    }
+    documentCount = documents;
+    removedCount = removedDocs;
+    return true;
+}
+
+// 8. Estadísticas
+size_t ContentIndex::termCount() const {
+    return postings.size();
+}
+
+size_t ContentIndex::documents() const {
+    return documentCount - removedCount;
+}
+
+size_t ContentIndex::compressedBytes() const {
+    size_t total = 0;
+    for (const auto& entry : postings) {
+        total += entry.second.bytes.size();
+    }
+    return total;
+}
+
+void ContentIndex::clear() {
+    postings.clear();
+    indexed.clear();
+    removed.clear();
+    pending.clear();
+    purging.clear();
+    purgingDocs.clear();
+    purgeQueue.clear();
+    revived.clear();
+    documentCount = 0;
+    removedCount = 0;
+}
@@ -0,0 +1,127 @@
+#ifndef CONTENTINDEX_HPP
+#define CONTENTINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <functional>
+#include <iostream>
+
+using namespace std;
+
+// Índice invertido sobre el contenido de los archivos.
+// Cada término guarda sus documentos (IDs de nodo) en orden creciente como
+// una lista comprimida: delta del ID, número de apariciones y deltas de las
+// posiciones, todo en varint. Cada SKIP_INTERVAL documentos se anota un
+// salto (ID, desplazamiento) para avanzar sin decodificar la lista entera.
+// Los documentos nuevos se añaden al final de cada lista; los que llegan
+// fuera de orden se acumulan y se fusionan en la siguiente consulta.
+class ContentIndex {
+public:
+    static const size_t SKIP_INTERVAL = 64;
+
+    // Consulta: grupos unidos por OR; dentro de cada grupo, frases unidas
+    // por AND (una frase de una sola palabra es un término suelto)
+    struct Query {
+        vector<vector<vector<string>>> groups;
+    };
+
+private:
+    struct PostingList {
+        vector<uint8_t> bytes;
+        vector<pair<int, uint32_t>> skips;  // (último ID antes del bloque, desplazamiento)
+        int lastDoc;
+        size_t docCount;
+
+        PostingList() : lastDoc(-1), docCount(0) {}
+    };
+
+    // Lector secuencial de una lista
+    class Cursor {
+        const PostingList* list;
+        size_t offset;
+        size_t index;     // Documentos ya leídos
+        int doc;
+        bool finished;
+        vector<uint32_t> positions;
+
+    public:
+        explicit Cursor(const PostingList* list);
+        bool valid() const { return !finished; }
+        int current() const { return doc; }
+        const vector<uint32_t>& currentPositions() const { return positions; }
+        void next();
+        void advanceTo(int target);
+    };
+
+    unordered_map<string, PostingList> postings;
+    vector<uint8_t> indexed;   // Documentos presentes en las listas
+    vector<uint8_t> removed;   // Documentos retirados (pendientes de purgar)
+    size_t documentCount;
+    size_t removedCount;
+
+    // Documentos añadidos fuera de orden desde la última fusión
+    struct PendingDoc {
+        int id;
+        vector<pair<string, vector<uint32_t>>> terms;
+    };
+    vector<PendingDoc> pending;
+
+    // Purga en curso (ver beginPurge): documentos marcados, términos que
+    // faltan por revisar y documentos reactivados mientras tanto
+    vector<uint8_t> purging;
+    vector<int> purgingDocs;     // Los mismos, en orden creciente
+    vector<string> purgeQueue;
+    vector<pair<int, string>> revived;
+
+    // Helpers
+    static void appendDoc(PostingList& list, int doc, const vector<uint32_t>& positions);
+    static void rebuildList(PostingList& list, vector<pair<int, vector<uint32_t>>>& docs);
+    static void decodeList(const PostingList& list, vector<pair<int, vector<uint32_t>>>& docs);
+    void flush();
+    bool isLive(int doc) const;
+    bool containsPurged(const PostingList& list) const;
+    void finishPurge();
+    vector<int> matchGroup(const vector<vector<string>>& phrases);
+
+public:
+    ContentIndex();
+
+    // 1. Separar un texto en términos (minúsculas ASCII; los bytes UTF-8 se
+    //    conservan dentro de la palabra)
+    static vector<string> tokenize(const string& text);
+
+    // 2. Analizar una consulta: palabras, "frases entre comillas" y OR
+    static Query parseQuery(const string& text);
+
+    // 3. Añadir el contenido de un documento (ignorado si ya está indexado)
+    void addDocument(int id, const string& content);
+
+    // 4. Retirar un documento (se purga en la siguiente compactación)
+    void removeDocument(int id);
+
+    // 5. IDs de los documentos que cumplen la consulta, en orden creciente
+    vector<int> search(const Query& query);
+
+    // 6. Purga por tramos de los documentos retirados o muertos.
+    //    beginPurge los marca y devuelve cuántos son; cada purgeStep revisa
+    //    como mucho maxTerms términos, reescribe solo las listas que
+    //    contienen alguno y devuelve true al terminar. Entre tramos se puede
+    //    buscar y añadir documentos; uno reactivado durante la purga se
+    //    vuelve a indexar al terminarla
+    size_t beginPurge(const function<bool(int)>& isDead);
+    bool purgeStep(size_t maxTerms);
+
+    // 7. Persistencia binaria; fingerprint identifica la instantánea
+    void save(ostream& out, uint64_t fingerprint);
+    bool load(istream& in, uint64_t fingerprint);
+
+    // 8. Estadísticas
+    size_t termCount() const;
+    size_t documents() const;
+    size_t compressedBytes() const;
+    void clear();
+};
+
+#endif // CONTENTINDEX_HPP
@@ -0,0 +1,250 @@
+#include "ContentScanner.hpp"
+#include "SimdSearch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Archivos por bloque de trabajo: se corta al llegar a cualquiera de
+    // los dos límites para que los bloques cuesten parecido
+    const size_t CHUNK_FILES = 4096;
+    const size_t CHUNK_BYTES = 1 << 20;
+}
+
+ContentScanner::ContentScanner(const vector<string>& patternList) : classCount(1) {
+    for (const auto& pattern : patternList) {
+        if (!pattern.empty() && find(patterns.begin(), patterns.end(), pattern) == patterns.end()) {
+            patterns.push_back(pattern);
+        }
+    }
+    if (patterns.size() > 1) {
+        buildAutomaton();
+    }
+}
+
+// Helper: construir el autómata de Aho-Corasick con todas sus transiciones
+void ContentScanner::buildAutomaton() {
+    memset(byteClass, 0, sizeof(byteClass));
+    for (const auto& pattern : patterns) {
+        for (unsigned char c : pattern) {
+            if (byteClass[c] == 0) byteClass[c] = static_cast<uint16_t>(classCount++);
+        }
+        if (startBytes.find(pattern[0]) == string::npos) startBytes += pattern[0];
+    }
+
+    // Comienzos de dos bytes: filtran mucho más que el primer byte solo
+    bool pairsUsable = true;
+    for (const auto& pattern : patterns) {
+        if (pattern.size() < 2) {
+            pairsUsable = false;
+            break;
+        }
+        bool known = false;
+        for (size_t k = 0; k < startPairs.size() && !known; k += 2) {
+            known = startPairs.compare(k, 2, pattern, 0, 2) == 0;
+        }
+        if (!known) startPairs.append(pattern, 0, 2);
+    }
+    if (!pairsUsable || startPairs.size() / 2 > SimdSearch::MAX_PAIRS) {
+        startPairs.clear();
+    }
+
+    // Trie de los patrones
+    transitions.assign(classCount, -1);
+    outputs.assign(1, {});
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        int32_t state = 0;
+        for (unsigned char c : patterns[p]) {
+            int32_t& next = transitions[state * classCount + byteClass[c]];
+            if (next < 0) {
+                next = static_cast<int32_t>(outputs.size());
+                outputs.emplace_back();
+                transitions.resize(transitions.size() + classCount, -1);
+            }
+            state = transitions[state * classCount + byteClass[c]];
+        }
+        outputs[state].push_back(p);
+    }
+
+    // Enlaces de fallo en anchura; las transiciones ausentes se copian del
+    // estado de fallo, así que la búsqueda no retrocede nunca
+    vector<int32_t> fail(outputs.size(), 0);
+    queue<int32_t> frontier;
+    for (size_t c = 0; c < classCount; c++) {
+        int32_t& next = transitions[c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            frontier.push(next);
+        }
+    }
+    while (!frontier.empty()) {
+        int32_t state = frontier.front();
+        frontier.pop();
+        for (size_t c = 0; c < classCount; c++) {
+            int32_t& next = transitions[state * classCount + c];
+            int32_t fallback = transitions[fail[state] * classCount + c];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                const auto& inherited = outputs[fallback];
+                outputs[next].insert(outputs[next].end(), inherited.begin(), inherited.end());
+                frontier.push(next);
+            }
+        }
+    }
+}
+
+// Helper: un solo patrón con el filtro SIMD
+size_t ContentScanner::scanSingle(const string& text, size_t& firstOffset) const {
+    return SimdSearch::count(text.data(), text.size(), patterns[0], firstOffset);
+}
+
+// Helper: varios patrones con Aho-Corasick. En el estado inicial se salta
+// con SIMD hasta la siguiente posición donde puede empezar un patrón
+size_t ContentScanner::scanMultiple(const string& text, vector<size_t>& perPattern, size_t& firstOffset) const {
+    const char* data = text.data();
+    size_t n = text.size(), count = 0;
+    bool skipPairs = !startPairs.empty();
+    bool skipBytes = !skipPairs && startBytes.size() <= SimdSearch::MAX_BYTES;
+    int32_t state = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (state == 0 && (skipPairs || skipBytes)) {
+            i = skipPairs ? SimdSearch::findAnyPair(data, n, i, startPairs)
+                          : SimdSearch::findAnyByte(data, n, i, startBytes);
+            if (i == n) break;
+        }
+        state = transitions[state * classCount + byteClass[static_cast<unsigned char>(data[i])]];
+        for (uint32_t p : outputs[state]) {
+            size_t start = i + 1 - patterns[p].size();
+            if (count == 0 || start < firstOffset) firstOffset = start;
+            perPattern[p]++;
+            count++;
+        }
+    }
+    return count;
+}
+
+// 1. Buscar en un texto
+size_t ContentScanner::scanText(const string& text, vector<size_t>& perPattern, size_t& firstOffset) const {
+    perPattern.assign(patterns.size(), 0);
+    firstOffset = 0;
+    if (patterns.empty()) return 0;
+
+    if (patterns.size() == 1) {
+        perPattern[0] = scanSingle(text, firstOffset);
+        return perPattern[0];
+    }
+    return scanMultiple(text, perPattern, firstOffset);
+}
+
+// 2. Recorrer los archivos en paralelo. El hilo llamador entrega los
+// resultados de cada bloque en cuanto están listos los anteriores
+ContentScanner::Stats ContentScanner::scan(shared_ptr<TreeNode> root, const Sink& sink, unsigned threads) const {
+    auto start = chrono::steady_clock::now();
+    Stats stats = {0, 0, 0, 0, 0.0, 0, false};
+    if (!root || patterns.empty()) return stats;
+
+    // Archivos en preorden, cortados en bloques
+    vector<TreeNode*> files;
+    vector<size_t> chunkStarts = {0};
+    size_t chunkBytes = 0;
+    vector<TreeNode*> pending = {root.get()};
+    while (!pending.empty()) {
+        TreeNode* current = pending.back();
+        pending.pop_back();
+        if (current->isFile()) {
+            files.push_back(current);
+            chunkBytes += current->getContent().size();
+            if (chunkBytes >= CHUNK_BYTES || files.size() - chunkStarts.back() >= CHUNK_FILES) {
+                chunkStarts.push_back(files.size());
+                chunkBytes = 0;
+            }
+        }
+        for (auto it = current->getChildren().rbegin(); it != current->getChildren().rend(); ++it) {
+            pending.push_back(it->get());
+        }
+    }
+    if (chunkStarts.back() != files.size()) chunkStarts.push_back(files.size());
+    size_t chunkCount = chunkStarts.size() - 1;
+
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    threads = static_cast<unsigned>(min<size_t>(threads, max<size_t>(chunkCount, 1)));
+    stats.threads = threads;
+
+    vector<vector<FileHit>> results(chunkCount);
+    vector<uint8_t> done(chunkCount, 0);
+    atomic<size_t> nextChunk(0);
+    atomic<size_t> scannedFiles(0), scannedBytes(0);
+    atomic<bool> stop(false);
+    mutex doneMutex;
+    condition_variable chunkDone;
+
+    auto worker = [&]() {
+        vector<size_t> perPattern;
+        size_t firstOffset;
+        while (!stop.load(memory_order_relaxed)) {
+            size_t chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) break;
+
+            vector<FileHit> hits;
+            size_t bytes = 0;
+            for (size_t f = chunkStarts[chunk]; f < chunkStarts[chunk + 1]; f++) {
+                const string& content = files[f]->getContent();
+                bytes += content.size();
+                size_t matches = scanText(content, perPattern, firstOffset);
+                if (matches > 0) {
+                    hits.push_back({files[f], matches, firstOffset, perPattern});
+                }
+            }
+            scannedFiles += chunkStarts[chunk + 1] - chunkStarts[chunk];
+            scannedBytes += bytes;
+
+            lock_guard<mutex> lock(doneMutex);
+            results[chunk] = std::move(hits);
+            done[chunk] = 1;
+            chunkDone.notify_one();
+        }
+    };
+
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back(worker);
+    }
+
+    for (size_t chunk = 0; chunk < chunkCount && !stats.stopped; chunk++) {
+        vector<FileHit> hits;
+        {
+            unique_lock<mutex> lock(doneMutex);
+            chunkDone.wait(lock, [&]() { return done[chunk] != 0; });
+            hits = std::move(results[chunk]);
+        }
+        for (const auto& hit : hits) {
+            stats.matchedFiles++;
+            stats.matches += hit.matches;
+            if (!sink(hit)) {
+                stats.stopped = true;
+                stop = true;
+                break;
+            }
+        }
+    }
+
+    for (auto& running : workers) {
+        running.join();
+    }
+
+    stats.files = scannedFiles;
+    stats.bytes = scannedBytes;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
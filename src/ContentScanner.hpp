@@ -0,0 +1,75 @@
+#ifndef CONTENTSCANNER_HPP
+#define CONTENTSCANNER_HPP
+
+#include "TreeNode.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+using namespace std;
+
+// Búsqueda por fuerza bruta en el contenido de los archivos, sin índice:
+// para patrones puntuales que no compensa indexar. Los archivos se reparten
+// en bloques entre varios hilos y los resultados se entregan en preorden a
+// medida que terminan los bloques.
+// Un solo patrón se busca con SimdSearch; con varios se usa un autómata de
+// Aho-Corasick que salta con SIMD hasta el siguiente comienzo posible.
+class ContentScanner {
+public:
+    // Coincidencias de un archivo
+    struct FileHit {
+        TreeNode* node;
+        size_t matches;               // Apariciones (pueden solaparse)
+        size_t firstOffset;           // Byte de la primera aparición
+        vector<size_t> perPattern;    // Apariciones de cada patrón
+    };
+
+    struct Stats {
+        size_t files;         // Archivos examinados
+        size_t bytes;         // Bytes de contenido examinados
+        size_t matchedFiles;
+        size_t matches;
+        double seconds;
+        unsigned threads;
+        bool stopped;         // El receptor pidió parar (límite alcanzado)
+    };
+
+    // Recibe cada archivo con coincidencias; devolver false detiene el recorrido
+    using Sink = function<bool(const FileHit&)>;
+
+private:
+    vector<string> patterns;
+
+    // Autómata de Aho-Corasick completo sobre clases de bytes (solo los
+    // bytes que aparecen en los patrones tienen clase propia)
+    uint16_t byteClass[256];
+    size_t classCount;
+    vector<int32_t> transitions;            // estado * classCount + clase
+    vector<vector<uint32_t>> outputs;       // Patrones que terminan en cada estado
+    string startBytes;                      // Primeros bytes de los patrones
+    string startPairs;                      // Primeros dos bytes (si todos los tienen)
+
+    void buildAutomaton();
+
+    // Helpers de búsqueda sobre un texto
+    size_t scanSingle(const string& text, size_t& firstOffset) const;
+    size_t scanMultiple(const string& text, vector<size_t>& perPattern, size_t& firstOffset) const;
+
+public:
+    // Los patrones vacíos se ignoran
+    explicit ContentScanner(const vector<string>& patterns);
+
+    // 1. Buscar en un texto: número de apariciones (0 si no hay)
+    size_t scanText(const string& text, vector<size_t>& perPattern, size_t& firstOffset) const;
+
+    // 2. Recorrer los archivos bajo root con threads hilos (0 = uno por núcleo)
+    Stats scan(shared_ptr<TreeNode> root, const Sink& sink, unsigned threads = 0) const;
+
+    // 3. Consultas
+    const vector<string>& getPatterns() const { return patterns; }
+    bool empty() const { return patterns.empty(); }
+};
+
+#endif // CONTENTSCANNER_HPP
@@ -0,0 +1,435 @@
+#include "DaemonServer.hpp"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const int MAX_EVENTS = 64;
+const size_t READ_CHUNK = 4096;
+const size_t MAX_LINE = 64 * 1024;           // Una línea más larga cierra la sesión
+const int SHUTDOWN_FLUSH_MS = 2000;          // Plazo para vaciar las salidas al detenerse
+
+bool makeAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Conectar como cliente (bloqueante)
+int connectTo(const string& path) {
+    sockaddr_un address;
+    if (!makeAddress(path, address)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Leer una respuesta completa (terminada en '\0'); lo sobrante queda en pending
+bool receiveResponse(int fd, string& pending, string& response) {
+    char chunk[READ_CHUNK];
+    while (true) {
+        size_t end = pending.find('\0');
+        if (end != string::npos) {
+            response = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            return true;
+        }
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        pending.append(chunk, n);
+    }
+}
+
+}  // namespace
+
+DaemonServer::DaemonServer(ConsoleInterface& consoleInterface, const string& path)
+    : console(consoleInterface), socketPath(path), listenFd(-1), epollFd(-1),
+      running(false), servedCommands(0), acceptedConnections(0) {}
+
+DaemonServer::~DaemonServer() {
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    connections.clear();
+    if (epollFd >= 0) close(epollFd);
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+// 1. Crear el socket de escucha y el descriptor epoll
+bool DaemonServer::openSocket() {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        cerr << "Error: Ruta de socket inválida: " << socketPath << endl;
+        return false;
+    }
+
+    // Si el socket ya existe y nadie responde, es un resto de una ejecución anterior
+    int probe = connectTo(socketPath);
+    if (probe >= 0) {
+        close(probe);
+        cerr << "Error: Ya hay un servidor escuchando en " << socketPath << endl;
+        return false;
+    }
+    unlink(socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 ||
+        bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0 || !setNonBlocking(listenFd)) {
+        cerr << "Error: No se pudo escuchar en " << socketPath << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        cerr << "Error: epoll_create1: " << strerror(errno) << endl;
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+}
+
+// 2. Aceptar todas las conexiones pendientes
+void DaemonServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;  // EAGAIN: no quedan conexiones
+        }
+        if (!setNonBlocking(fd)) {
+            close(fd);
+            continue;
+        }
+
+        Connection connection;
+        connection.fd = fd;
+        connection.session = static_cast<int>(acceptedConnections + 1);
+        connection.closing = false;
+        // currentDirectory nulo: executeCommand lo sitúa en la raíz
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        connections.emplace(fd, move(connection));
+        acceptedConnections++;
+    }
+}
+
+// 3. Leer datos y ejecutar cada línea completa
+void DaemonServer::readFromClient(Connection& connection) {
+    char chunk[READ_CHUNK];
+    while (running && !connection.closing) {
+        ssize_t n = recv(connection.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            connection.pendingInput.append(chunk, n);
+            executeLines(connection);
+            // Lo que queda no tiene '\n': si ya supera el límite, el cliente
+            // no está enviando comandos y se descarta la sesión
+            if (connection.pendingInput.size() > MAX_LINE) {
+                connection.pendingInput.clear();
+                connection.pendingOutput += "Error: línea de más de " + to_string(MAX_LINE) +
+                                            " bytes sin salto de línea; se cierra la sesión.\n";
+                connection.pendingOutput += '\0';
+                connection.closing = true;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0) connection.closing = true;  // El cliente cerró su extremo
+        break;
+    }
+}
+
+// Ejecutar las líneas completas del búfer de entrada
+void DaemonServer::executeLines(Connection& connection) {
+    size_t start = 0;
+    size_t newline;
+    while (running && (newline = connection.pendingInput.find('\n', start)) != string::npos) {
+        string line = connection.pendingInput.substr(start, newline - start);
+        start = newline + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (line == "exit" || line == "quit") {
+            connection.pendingOutput += "Sesión cerrada.\n";
+            connection.pendingOutput += '\0';
+            connection.closing = true;
+            break;
+        }
+        if (line == "shutdown") {
+            connection.pendingOutput += "Servidor detenido.\n";
+            connection.pendingOutput += '\0';
+            connection.closing = true;
+            running = false;
+            break;
+        }
+
+        connection.pendingOutput += console.executeCommand(line, connection.session, connection.currentDirectory,
+                                                               connection.search, connection.batch);
+        connection.pendingOutput += '\0';
+        servedCommands++;
+    }
+    connection.pendingInput.erase(0, start);
+}
+
+// 4. Enviar la salida pendiente sin bloquear
+void DaemonServer::writeToClient(Connection& connection) {
+    size_t sent = 0;
+    while (sent < connection.pendingOutput.size()) {
+        ssize_t n = send(connection.fd, connection.pendingOutput.data() + sent,
+                         connection.pendingOutput.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection.pendingOutput.clear();
+                connection.closing = true;
+                return;
+            }
+            break;
+        }
+        sent += n;
+    }
+    connection.pendingOutput.erase(0, sent);
+}
+
+// Vigilar escritura solo mientras quede salida por enviar
+void DaemonServer::updateInterest(Connection& connection) {
+    epoll_event event{};
+    event.events = uint32_t(EPOLLIN) | (connection.pendingOutput.empty() ? 0u : uint32_t(EPOLLOUT));
+    event.data.fd = connection.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+void DaemonServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it != connections.end()) console.endSession(it->second.session);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+// 5. Bucle principal
+bool DaemonServer::run() {
+    if (!openSocket()) {
+        return false;
+    }
+
+    cout << "Servidor escuchando en " << socketPath << endl;
+    running = true;
+    epoll_event events[MAX_EVENTS];
+
+    while (running) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Error: epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& connection = it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                connection.closing = true;
+            }
+            if (events[i].events & EPOLLIN) {
+                readFromClient(connection);
+            }
+            writeToClient(connection);
+
+            if (connection.closing && connection.pendingOutput.empty()) {
+                closeConnection(fd);
+            } else if (!(events[i].events & EPOLLHUP)) {
+                updateInterest(connection);
+            } else {
+                closeConnection(fd);
+            }
+        }
+    }
+
+    // Enviar lo que quede antes de cerrar (respuesta a "shutdown"): se
+    // espera a cada cliente dentro de un plazo común y lo que no se haya
+    // podido enviar al agotarse se descarta
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(SHUTDOWN_FLUSH_MS);
+    for (auto& entry : connections) {
+        Connection& connection = entry.second;
+        while (true) {
+            writeToClient(connection);
+            if (connection.pendingOutput.empty()) break;
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            pollfd writable{connection.fd, POLLOUT, 0};
+            int result = left.count() > 0 ? poll(&writable, 1, static_cast<int>(left.count())) : 0;
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) {
+                connection.pendingOutput.clear();
+                break;
+            }
+        }
+    }
+
+    cout << "Servidor detenido. Conexiones atendidas: " << acceptedConnections
+         << ", comandos ejecutados: " << servedCommands << endl;
+    return true;
+}
+
+// Cliente ligero: una línea de stdin por comando, respuesta a stdout
+int runDaemonClient(const string& socketPath) {
+    int fd = connectTo(socketPath);
+    if (fd < 0) {
+        cerr << "Error: No se pudo conectar a " << socketPath << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    string pending;
+    string response;
+    string line;
+    while (getline(cin, line)) {
+        if (!sendAll(fd, line + "\n") || !receiveResponse(fd, pending, response)) {
+            cerr << "Error: Conexión cerrada por el servidor" << endl;
+            close(fd);
+            return 1;
+        }
+        cout << response << flush;
+        if (line == "exit" || line == "quit" || line == "shutdown") break;
+    }
+
+    close(fd);
+    return 0;
+}
+
+// Prueba de carga: cada hilo abre su conexión y envía peticiones en serie
+int runDaemonLoadTest(const string& socketPath, int maxConnections, int requestsPerConnection,
+                      const string& command) {
+    if (maxConnections < 1 || requestsPerConnection < 1) {
+        cerr << "Error: conexiones y peticiones deben ser mayores que 0" << endl;
+        return 1;
+    }
+
+    cout << "=== PRUEBA DE CARGA DEL SERVIDOR ===" << endl;
+    cout << "Comando: \"" << command << "\", " << requestsPerConnection
+         << " peticiones por conexión" << endl;
+    cout << "Conexiones\tPeticiones/s\tp50 (us)\tp99 (us)" << endl;
+
+    // 1, 2, 4, ... y siempre el máximo pedido
+    vector<int> steps;
+    for (int clients = 1; clients < maxConnections; clients *= 2) {
+        steps.push_back(clients);
+    }
+    steps.push_back(maxConnections);
+
+    for (int clients : steps) {
+        vector<vector<long long>> latencies(clients);
+        vector<int> failures(clients, 0);
+        vector<thread> workers;
+
+        auto start = chrono::high_resolution_clock::now();
+        for (int c = 0; c < clients; c++) {
+            workers.emplace_back([&, c]() {
+                int fd = connectTo(socketPath);
+                if (fd < 0) {
+                    failures[c] = requestsPerConnection;
+                    return;
+                }
+                latencies[c].reserve(requestsPerConnection);
+                string pending;
+                string response;
+                string request = command + "\n";
+                for (int r = 0; r < requestsPerConnection; r++) {
+                    auto sentAt = chrono::high_resolution_clock::now();
+                    if (!sendAll(fd, request) || !receiveResponse(fd, pending, response)) {
+                        failures[c] += requestsPerConnection - r;
+                        break;
+                    }
+                    auto elapsed = chrono::high_resolution_clock::now() - sentAt;
+                    latencies[c].push_back(chrono::duration_cast<chrono::microseconds>(elapsed).count());
+                }
+                close(fd);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto total = chrono::duration_cast<chrono::microseconds>(
+            chrono::high_resolution_clock::now() - start).count();
+
+        vector<long long> all;
+        int failed = 0;
+        for (int c = 0; c < clients; c++) {
+            all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+            failed += failures[c];
+        }
+        if (all.empty()) {
+            cerr << "Error: Ninguna petición completada con " << clients << " conexiones" << endl;
+            return 1;
+        }
+        sort(all.begin(), all.end());
+        long long p50 = all[all.size() / 2];
+        long long p99 = all[min(all.size() - 1, all.size() * 99 / 100)];
+        double throughput = total > 0 ? all.size() * 1e6 / total : 0.0;
+
+        cout << clients << "\t\t" << static_cast<long long>(throughput) << "\t\t"
+             << p50 << "\t\t" << p99;
+        if (failed > 0) cout << "\t(" << failed << " fallidas)";
+        cout << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef DAEMONSERVER_HPP
+#define DAEMONSERVER_HPP
+
+#include "ConsoleInterface.hpp"
+#include <string>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+// Servidor local: mantiene un único árbol e índice en memoria y atiende
+// los comandos de consola de varios clientes por un socket Unix.
+//
+// Protocolo: el cliente envía un comando por línea ('\n'); el servidor
+// responde con la salida del comando seguida de un byte '\0'.
+// "exit"/"quit" cierran la conexión y "shutdown" detiene el servidor.
+// Una línea de más de 64 KiB sin '\n' cierra la sesión que la envía.
+class DaemonServer {
+private:
+    // Estado de cada conexión: búferes, carpeta actual, búsqueda paginada
+    // y transacción abierta
+    struct Connection {
+        int fd;
+        int session;  // Identifica sus trabajos en segundo plano
+        string pendingInput;
+        string pendingOutput;
+        shared_ptr<TreeNode> currentDirectory;
+        ConsoleInterface::PagedSearch search;
+        ConsoleInterface::PendingBatch batch;
+        bool closing;
+    };
+
+    ConsoleInterface& console;
+    string socketPath;
+    int listenFd;
+    int epollFd;
+    bool running;
+    map<int, Connection> connections;
+
+    // Estadísticas
+    long long servedCommands;
+    long long acceptedConnections;
+
+    // Helpers del bucle de eventos
+    bool openSocket();
+    void acceptClients();
+    void readFromClient(Connection& connection);
+    void executeLines(Connection& connection);
+    void writeToClient(Connection& connection);
+    void closeConnection(int fd);
+    void updateInterest(Connection& connection);
+
+public:
+    DaemonServer(ConsoleInterface& consoleInterface, const string& path);
+    ~DaemonServer();
+
+    // Ejecutar el bucle epoll hasta recibir "shutdown"
+    bool run();
+};
+
+// Cliente ligero: reenvía comandos de stdin al servidor
+int runDaemonClient(const string& socketPath);
+
+// Prueba de carga: peticiones/s y latencia p99 con 1..maxConnections conexiones
+int runDaemonLoadTest(const string& socketPath, int maxConnections, int requestsPerConnection,
+                      const string& command);
+
+#endif // DAEMONSERVER_HPP
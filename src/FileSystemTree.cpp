@@ -1,4 +1,9 @@
 #include "FileSystemTree.hpp"
+#include "NodeReclaimer.hpp"
+#include "JobManager.hpp"
+#include "OrderLabels.hpp"
+#include "GlobMatcher.hpp"
+#include "TreeSnapshot.hpp"
 #include <sstream>
 #include <algorithm>
 #include <stack>
@@ -9,53 +14,239 @@
 #include <unordered_set>
 #include <climits>
 #include <limits>
+#include <atomic>
 
 using namespace std;
 using namespace chrono;
 
-FileSystemTree::FileSystemTree() : nextId(1) {
+namespace {
+    // Épocas únicas entre todos los árboles: un nodo de otro árbol nunca
+    // coincide con la época actual
+    atomic<uint64_t> epochCounter(0);
+    
+    // Segmento de un patrón de ruta
+    struct PathSegment {
+        bool anyDepth;        // "**"
+        bool literal;         // Sin comodines: se busca en el índice de hijos
+        string pattern;       // Texto original del segmento
+        string text;          // Nombre exacto (segmentos literales)
+        GlobMatcher matcher;
+        
+        PathSegment(const string& segment)
+            : anyDepth(segment == "**"), literal(!GlobMatcher::hasWildcards(segment)),
+              pattern(segment), text(GlobMatcher::literalPrefix(segment)), matcher(segment) {}
+        
+        bool matches(const string& name) const {
+            return literal ? name == text : matcher.matches(name);
+        }
+    };
+    
+    // Estados que el recorrido descendente visita antes de consultar el índice
+    const size_t TOP_DOWN_PROBE = 1024;
+    
+    // Coste relativo de comprobar un segmento subiendo desde un candidato
+    // (bloquear el weak_ptr del padre) frente a visitar un estado descendente
+    const size_t BOTTOM_UP_COST = 4;
+    
+    // Recorrido descendente desde (start, first). Devuelve false si supera
+    // budget estados; los "**" repetidos se controlan con visitedStates
+    bool expandTopDown(TreeNode* start, size_t first, const vector<PathSegment>& segments,
+                       size_t budget, vector<TreeNode*>& out, size_t& visited) {
+        vector<pair<TreeNode*, size_t>> pending = {{start, first}};
+        unordered_set<string> visitedStates;
+        size_t deepSegments = count_if(segments.begin(), segments.end(),
+                                       [](const PathSegment& s) { return s.anyDepth; });
+        
+        while (!pending.empty()) {
+            if (++visited > budget) return false;
+            auto state = pending.back();
+            pending.pop_back();
+            TreeNode* node = state.first;
+            size_t index = state.second;
+            
+            if (deepSegments > 1) {
+                string key(reinterpret_cast<const char*>(&node), sizeof(node));
+                key.append(reinterpret_cast<const char*>(&index), sizeof(index));
+                if (!visitedStates.insert(key).second) continue;
+            }
+            
+            if (index == segments.size()) {
+                out.push_back(node);
+                continue;
+            }
+            
+            const PathSegment& segment = segments[index];
+            if (segment.anyDepth) {
+                pending.push_back({node, index + 1});
+                for (auto& child : node->getChildren()) {
+                    pending.push_back({child.get(), index});
+                }
+            } else if (segment.literal) {
+                // Índice de hijos del directorio: sin recorrer sus hermanos
+                if (auto child = node->findChild(segment.text)) {
+                    pending.push_back({child.get(), index + 1});
+                }
+            } else {
+                for (auto& child : node->getChildren()) {
+                    if (segment.matches(child->getName())) {
+                        pending.push_back({child.get(), index + 1});
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    
+    // ¿Coinciden los segmentos desde first con todos los nombres de chain?
+    // Como GlobMatcher, se avanza el conjunto de segmentos alcanzables un
+    // nombre cada vez: O(segmentos * nombres) aunque haya varios "**"
+    bool matchesChain(const vector<PathSegment>& segments, size_t first,
+                      const vector<const string*>& chain) {
+        size_t count = segments.size();
+        vector<uint8_t> current(count + 1, 0);
+        vector<uint8_t> next(count + 1, 0);
+        
+        // Un "**" también puede no consumir ningún nombre
+        auto skipAnyDepth = [&](vector<uint8_t>& states) {
+            for (size_t i = first; i < count; i++) {
+                if (states[i] && segments[i].anyDepth) states[i + 1] = 1;
+            }
+        };
+        
+        current[first] = 1;
+        skipAnyDepth(current);
+        for (const string* name : chain) {
+            fill(next.begin(), next.end(), 0);
+            bool alive = false;
+            for (size_t i = first; i < count; i++) {
+                if (!current[i]) continue;
+                if (segments[i].anyDepth) {
+                    next[i] = 1;
+                    alive = true;
+                } else if (segments[i].matches(*name)) {
+                    next[i + 1] = 1;
+                    alive = true;
+                }
+            }
+            if (!alive) return false;
+            skipAnyDepth(next);
+            current.swap(next);
+        }
+        return current[count] != 0;
+    }
+}
+
+FileSystemTree::FileSystemTree() : nextId(1), verbose(true) {
     // Crear nodo raíz
-    root = make_shared<TreeNode>(0, "root", NodeType::FOLDER);
+    root = TreeNode::create(0, "root", NodeType::FOLDER);
+    OrderLabels::labelTree(root);
+    bumpAttachEpoch();
 }
 
-// Helper: dividir ruta en componentes
+FileSystemTree::~FileSystemTree() {
+    // El árbol completo se libera en segundo plano
+    NodeReclaimer::instance().retire(std::move(root));
+}
+
+// Helper: dividir ruta en componentes (sin el nombre inicial de la raíz)
 vector<string> FileSystemTree::splitPath(const string& path) {
     vector<string> components;
-    stringstream ss(path);
-    string component;
+    size_t start = 0;
     
-    while (getline(ss, component, '/')) {
-        if (!component.empty()) {
-            components.push_back(component);
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            components.emplace_back(path, start, end - start);
         }
+        start = end + 1;
     }
     
+    if (!components.empty() && components.front() == "root") {
+        components.erase(components.begin());
+    }
     return components;
 }
 
-// Helper: encontrar nodo por ruta
+// Helper: ruta canónica usada como clave de la caché
+string FileSystemTree::canonicalPath(const string& path) {
+    string key = "/root";
+    for (const string& component : splitPath(path)) {
+        key += '/';
+        key += component;
+    }
+    return key;
+}
+
+// Helper: invalidar en caché la ruta de un nodo y sus descendientes. Las
+// claves están ordenadas, así que se borra solo el rango con ese prefijo
+// (construir la ruta cuesta O(profundidad), no recorrer toda la caché)
+void FileSystemTree::invalidateCachedPath(shared_ptr<TreeNode> node) {
+    pathCache.invalidate(canonicalPath(getFullPath(node)));
+}
+
+// Helper: nueva época de conexión
+void FileSystemTree::bumpAttachEpoch() {
+    attachEpoch = ++epochCounter;
+}
+
+// Helper: la instantánea deja de reflejar el árbol
+void FileSystemTree::invalidateSnapshot() {
+    lock_guard<mutex> lock(snapshotMutex);
+    snapshot.reset();
+}
+
+// Helper: encontrar nodo por ruta (con caché de rutas)
 shared_ptr<TreeNode> FileSystemTree::findNodeByPath(const string& path) {
     if (path == "/" || path.empty()) {
         return root;
     }
     
     vector<string> components = splitPath(path);
-    shared_ptr<TreeNode> current = root;
     
+    // Construir la clave canónica y el fin de cada prefijo dentro de ella
+    string key = "/root";
+    vector<const string*> names;
+    vector<size_t> prefixEnds;
     for (const string& component : components) {
-        if (component == "root") continue;
-        
-        bool found = false;
-        for (auto& child : current->children) {
-            if (child->name == component) {
-                current = child;
-                found = true;
-                break;
-            }
+        key += '/';
+        key += component;
+        names.push_back(&component);
+        prefixEnds.push_back(key.size());
+    }
+    
+    if (names.empty()) {
+        return root;
+    }
+    
+    // Un acierto se confirma con la época de conexión (O(1) salvo tras una
+    // eliminación): la caché nunca devuelve un nodo ya desconectado
+    auto cached = pathCache.lookup(key);
+    if (cached && isAttached(cached)) {
+        return cached;
+    }
+    
+    // Reutilizar el directorio ancestro más profundo que esté en caché
+    shared_ptr<TreeNode> current = root;
+    size_t start = 0;
+    vector<size_t> directoryEnds(prefixEnds.begin(), prefixEnds.end() - 1);
+    int found = pathCache.lookupLongestPrefix(key, directoryEnds, current);
+    if (found >= 0) {
+        start = found + 1;
+    }
+    
+    for (size_t i = start; i < names.size(); i++) {
+        auto child = current->findChild(*names[i]);
+        if (!child) {
+            return nullptr;
         }
+        current = child;
         
-        if (!found) {
-            return nullptr;
+        // Guardar directorios intermedios y el destino final
+        if (current->isFolder() || i + 1 == names.size()) {
+            pathCache.insert(key.substr(0, prefixEnds[i]), current);
         }
     }
     
@@ -68,7 +259,7 @@ shared_ptr<TreeNode> FileSystemTree::findNodeById(shared_ptr<TreeNode> node, int
         return node;
     }
     
-    for (auto& child : node->children) {
+    for (auto& child : node->getChildren()) {
         auto result = findNodeById(child, id);
         if (result != nullptr) {
             return result;
@@ -80,12 +271,7 @@ shared_ptr<TreeNode> FileSystemTree::findNodeById(shared_ptr<TreeNode> node, int
 
 // Helper: verificar si nombre ya existe en hijos
 bool FileSystemTree::nameExists(shared_ptr<TreeNode> parent, const string& name) {
-    for (auto& child : parent->children) {
-        if (child->name == name) {
-            return true;
-        }
-    }
-    return false;
+    return parent->findChild(name) != nullptr;
 }
 
 // 1. Crear nodo en ruta específica
@@ -101,6 +287,27 @@ shared_ptr<TreeNode> FileSystemTree::createNode(const string& path, const string
         throw invalid_argument("Ruta no encontrada: " + path);
     }
     
+    auto newNode = createNode(parentNode, name, type, content);
+    
+    if (verbose) cout << "Nodo creado: ID=" << newNode->id 
+         << ", Nombre=" << name 
+         << ", Tipo=" << (type == NodeType::FOLDER ? "CARPETA" : "ARCHIVO")
+         << endl;
+    
+    return newNode;
+}
+
+// 1b. Crear nodo bajo un padre ya resuelto
+shared_ptr<TreeNode> FileSystemTree::createNode(shared_ptr<TreeNode> parentNode, const string& name,
+                                               NodeType type, const string& content) {
+    if (name.empty()) {
+        throw invalid_argument("El nombre no puede estar vacío");
+    }
+    
+    if (!parentNode) {
+        throw invalid_argument("Directorio padre no válido");
+    }
+    
     if (!parentNode->isFolder()) {
         throw invalid_argument("No se puede crear dentro de un archivo");
     }
@@ -110,13 +317,10 @@ shared_ptr<TreeNode> FileSystemTree::createNode(const string& path, const string
     }
     
     // Crear nuevo nodo
-    auto newNode = make_shared<TreeNode>(nextId++, name, type, content);
+    auto newNode = TreeNode::create(nextId++, name, type, content);
     parentNode->addChild(newNode);
-    
-    cout << "Nodo creado: ID=" << newNode->id 
-         << ", Nombre=" << name 
-         << ", Tipo=" << (type == NodeType::FOLDER ? "CARPETA" : "ARCHIVO")
-         << endl;
+    OrderLabels::attach(parentNode, newNode);
+    invalidateSnapshot();
     
     return newNode;
 }
@@ -133,29 +337,60 @@ bool FileSystemTree::moveNode(const string& sourcePath, const string& destPath)
         throw invalid_argument("Ruta destino no encontrada: " + destPath);
     }
     
+    moveNode(sourceNode, destNode);
+    
+    if (verbose) cout << "Nodo movido: " << sourcePath << " -> " << destPath << endl;
+    return true;
+}
+
+// 2b. Mover un nodo ya resuelto a otra carpeta
+bool FileSystemTree::moveNode(shared_ptr<TreeNode> sourceNode, shared_ptr<TreeNode> destNode) {
+    if (!sourceNode || !destNode) {
+        throw invalid_argument("Nodo origen o destino no válido");
+    }
+    
+    if (sourceNode == root) {
+        throw invalid_argument("No se puede mover la raíz");
+    }
+    
     if (!destNode->isFolder()) {
         throw invalid_argument("El destino debe ser una carpeta");
     }
     
-    // Verificar si el destino es descendiente del origen
-    auto current = destNode;
-    while (auto parent = current->parent.lock()) {
-        if (parent == sourceNode) {
-            throw invalid_argument("No se puede mover un nodo dentro de sus propios descendientes");
-        }
-        current = parent;
+    // Las etiquetas solo son comparables entre nodos del árbol actual
+    if (!isAttached(sourceNode) || !isAttached(destNode)) {
+        throw invalid_argument("El nodo no pertenece al árbol");
     }
     
-    // Remover del padre actual
+    // Verificar si el destino es el propio origen o uno de sus descendientes
+    if (isAncestor(sourceNode, destNode)) {
+        throw invalid_argument("No se puede mover un nodo dentro de sus propios descendientes");
+    }
+    
+    // Mover a la misma carpeta no cambia nada
     auto sourceParent = sourceNode->parent.lock();
+    if (sourceParent == destNode) {
+        return true;
+    }
+    
+    if (nameExists(destNode, sourceNode->getName())) {
+        throw invalid_argument("Ya existe un nodo con ese nombre en el destino");
+    }
+    
+    // Las rutas cacheadas del origen y sus descendientes dejan de ser válidas
+    invalidateCachedPath(sourceNode);
+    
+    // Remover del padre actual
     if (sourceParent) {
-        sourceParent->removeChild(sourceNode->name);
+        sourceParent->removeChild(sourceNode->getName());
     }
+    OrderLabels::detach(sourceNode);
     
     // Agregar al nuevo padre
     destNode->addChild(sourceNode);
+    OrderLabels::attach(destNode, sourceNode);
+    invalidateSnapshot();
     
-    cout << "Nodo movido: " << sourcePath << " -> " << destPath << endl;
     return true;
 }
 
@@ -170,6 +405,23 @@ bool FileSystemTree::renameNode(const string& path, const string& newName) {
         throw invalid_argument("Nodo no encontrado: " + path);
     }
     
+    string oldName = node->getName();
+    renameNode(node, newName);
+    
+    if (verbose) cout << "Nodo renombrado: " << oldName << " -> " << newName << endl;
+    return true;
+}
+
+// 3b. Renombrar un nodo ya resuelto
+bool FileSystemTree::renameNode(shared_ptr<TreeNode> node, const string& newName) {
+    if (newName.empty()) {
+        throw invalid_argument("El nuevo nombre no puede estar vacío");
+    }
+    
+    if (!node) {
+        throw invalid_argument("Nodo no válido");
+    }
+    
     // Verificar si es la raíz
     if (node == root) {
         throw invalid_argument("No se puede renombrar la raíz");
@@ -181,10 +433,10 @@ bool FileSystemTree::renameNode(const string& path, const string& newName) {
         throw invalid_argument("Ya existe un nodo con ese nombre en esta ubicación");
     }
     
-    string oldName = node->name;
-    node->name = newName;
+    invalidateCachedPath(node);
+    node->setName(newName);
+    invalidateSnapshot();
     
-    cout << "Nodo renombrado: " << oldName << " -> " << newName << endl;
     return true;
 }
 
@@ -195,6 +447,21 @@ bool FileSystemTree::deleteNode(const string& path) {
         throw invalid_argument("Nodo no encontrado: " + path);
     }
     
+    int nodeId = node->id;
+    if (deleteNode(node)) {
+        if (verbose) cout << "Nodo eliminado: " << path << " (ID=" << nodeId << ")" << endl;
+        return true;
+    }
+    
+    return false;
+}
+
+// 4b. Eliminar un nodo ya resuelto
+bool FileSystemTree::deleteNode(shared_ptr<TreeNode> node) {
+    if (!node) {
+        throw invalid_argument("Nodo no válido");
+    }
+    
     // Verificar si es la raíz
     if (node == root) {
         throw invalid_argument("No se puede eliminar la raíz");
@@ -203,8 +470,17 @@ bool FileSystemTree::deleteNode(const string& path) {
     // Remover del padre
     auto parent = node->parent.lock();
     if (parent) {
-        parent->removeChild(node->name);
-        cout << "Nodo eliminado: " << path << " (ID=" << node->id << ")" << endl;
+        invalidateCachedPath(node);
+        parent->removeChild(node->getName());
+        
+        // El subárbol queda desconectado: sin padre deja de alcanzar la raíz
+        node->parent.reset();
+        OrderLabels::detach(node);
+        bumpAttachEpoch();
+        invalidateSnapshot();
+        
+        // Si nadie más lo retiene, el subárbol se libera en segundo plano
+        NodeReclaimer::instance().retire(std::move(node));
         return true;
     }
     
@@ -218,10 +494,15 @@ vector<string> FileSystemTree::listChildren(const string& path) {
         throw invalid_argument("Nodo no encontrado: " + path);
     }
     
+    return listChildren(node);
+}
+
+// 5b. Listar hijos de un nodo ya resuelto
+vector<string> FileSystemTree::listChildren(shared_ptr<TreeNode> node) {
     vector<string> result;
-    for (auto& child : node->children) {
+    for (auto& child : node->getChildren()) {
         string typeStr = child->isFolder() ? "[DIR] " : "[FILE] ";
-        result.push_back(typeStr + child->name + " (ID: " + to_string(child->id) + ")");
+        result.push_back(typeStr + child->getName() + " (ID: " + to_string(child->id) + ")");
     }
     
     return result;
@@ -235,7 +516,7 @@ string FileSystemTree::getFullPath(shared_ptr<TreeNode> node) {
     shared_ptr<TreeNode> current = node;
     
     while (current && current != root) {
-        pathComponents.push_back(current->name);
+        pathComponents.push_back(current->getName());
         if (auto parent = current->parent.lock()) {
             current = parent;
         } else {
@@ -258,64 +539,53 @@ string FileSystemTree::getFullPath(shared_ptr<TreeNode> node) {
     return path;
 }
 
-// 7. Recorrido en preorden
-vector<string> FileSystemTree::preorderTraversal() {
+// 7. Recorrido en preorden (sobre la instantánea)
+vector<string> FileSystemTree::preorderTraversal(JobControl* control) {
     vector<string> result;
     if (!root) return result;
     
-    stack<shared_ptr<TreeNode>> s;
-    s.push(root);
-    
-    while (!s.empty()) {
-        auto current = s.top();
-        s.pop();
+    auto frozen = freeze();
+    const auto& ids = frozen->getIds();
+    const auto& nameIds = frozen->getNameIds();
+    const auto& folders = frozen->getFolders();
+    NamePool& pool = NamePool::instance();
+    result.reserve(frozen->size());
+    
+    for (size_t i = 0; i < frozen->size(); i++) {
+        if (control) {
+            control->checkpoint();
+            control->advance();
+        }
         
-        // Procesar nodo actual
-        string nodeInfo = "ID: " + to_string(current->id) + 
-                         ", Nombre: " + current->name +
-                         ", Tipo: " + (current->isFolder() ? "CARPETA" : "ARCHIVO");
+        string nodeInfo = "ID: " + to_string(ids[i]) + 
+                         ", Nombre: " + pool.get(nameIds[i]) +
+                         ", Tipo: " + (folders[i] ? "CARPETA" : "ARCHIVO");
         result.push_back(nodeInfo);
-        
-        // Agregar hijos en orden inverso para mantener orden correcto
-        for (auto it = current->children.rbegin(); it != current->children.rend(); ++it) {
-            s.push(*it);
-        }
     }
     
     return result;
 }
 
-// 8. Calcular altura del árbol
+// 8. Calcular altura del árbol (la raíz tiene altura 0)
 int FileSystemTree::calculateHeight() {
-    return calculateHeightRecursive(root) - 1; // Restar 1 porque la raíz tiene altura 0
-}
-
-int FileSystemTree::calculateHeightRecursive(shared_ptr<TreeNode> node) {
-    if (!node) return 0;
-    
-    int maxHeight = 0;
-    for (auto& child : node->children) {
-        int childHeight = calculateHeightRecursive(child);
-        maxHeight = max(maxHeight, childHeight);
-    }
-    
-    return maxHeight + 1;
+    if (!root) return -1;
+    return static_cast<int>(freeze()->maxDepth());
 }
 
 // 9. Calcular tamaño (número de nodos)
 int FileSystemTree::calculateSize() {
-    return calculateSizeRecursive(root);
+    return static_cast<int>(freeze()->size());
 }
 
-int FileSystemTree::calculateSizeRecursive(shared_ptr<TreeNode> node) {
-    if (!node) return 0;
-    
-    int size = 1; // Contar el nodo actual
-    for (auto& child : node->children) {
-        size += calculateSizeRecursive(child);
+// Instantánea plana; se reconstruye solo si el árbol cambió desde la última.
+// Un trabajo de save y la consola pueden pedirla a la vez: la construye
+// solo el primero y el otro espera y la comparte
+shared_ptr<const TreeSnapshot> FileSystemTree::freeze() {
+    lock_guard<mutex> lock(snapshotMutex);
+    if (!snapshot) {
+        snapshot = TreeSnapshot::build(root.get());
     }
-    
-    return size;
+    return snapshot;
 }
 
 // 10. Buscar nodo por ID
@@ -323,32 +593,15 @@ shared_ptr<TreeNode> FileSystemTree::findNodeById(int id) {
     return findNodeById(root, id);
 }
 
-// 11. Verificar consistencia del árbol
+// 11. Verificar consistencia del árbol (enlaces, etiquetas de orden e
+// índices de hijos; los nombres repetidos no cuentan)
 bool FileSystemTree::verifyTreeConsistency() {
-    return verifyConsistencyRecursive(root, nullptr);
+    return validate().valid();
 }
 
-bool FileSystemTree::verifyConsistencyRecursive(shared_ptr<TreeNode> node, shared_ptr<TreeNode> expectedParent) {
-    if (!node) return true;
-    
-    // Verificar que el padre sea el esperado
-    auto actualParent = node->parent.lock();
-    if (expectedParent == nullptr) {
-        if (actualParent != nullptr) {
-            return false;
-        }
-    } else if (actualParent != expectedParent) {
-        return false;
-    }
-    
-    // Verificar recursivamente los hijos
-    for (auto& child : node->children) {
-        if (!verifyConsistencyRecursive(child, node)) {
-            return false;
-        }
-    }
-    
-    return true;
+// Activar o silenciar los mensajes por operación
+void FileSystemTree::setVerbose(bool enabled) {
+    verbose = enabled;
 }
 
 // Getters
@@ -361,173 +614,469 @@ int FileSystemTree::getNextId() const {
 }
 
 // Método para imprimir árbol
-void FileSystemTree::printTree() {
-    cout << "\n=== ESTRUCTURA DEL ÁRBOL ===" << endl;
-    printTreeRecursive(root, 0);
+void FileSystemTree::printTree(ostream& out) {
+    out << "\n=== ESTRUCTURA DEL ÁRBOL ===" << endl;
+    printTreeRecursive(root, 0, out);
 }
 
-void FileSystemTree::printTreeRecursive(shared_ptr<TreeNode> node, int depth) {
+void FileSystemTree::printTreeRecursive(shared_ptr<TreeNode> node, int depth, ostream& out) {
     if (!node) return;
     
     // Imprimir sangría
     for (int i = 0; i < depth; i++) {
-        cout << "  ";
+        out << "  ";
     }
     
     // Imprimir información del nodo
-    cout << "├─ ";
+    out << "├─ ";
     if (node->isFolder()) {
-        cout << "[DIR] ";
+        out << "[DIR] ";
     } else {
-        cout << "[FILE] ";
+        out << "[FILE] ";
     }
-    cout << node->name << " (ID: " << node->id << ")";
+    out << node->getName() << " (ID: " << node->id << ")";
     
-    if (node->isFile() && !node->content.empty()) {
-        cout << " - Contenido: \"" << node->content.substr(0, 20) 
-             << (node->content.length() > 20 ? "..." : "") << "\"";
+    if (node->isFile() && !node->getContent().empty()) {
+        out << " - Contenido: \"" << node->getContent().substr(0, 20) 
+             << (node->getContent().length() > 20 ? "..." : "") << "\"";
     }
-    cout << endl;
+    out << endl;
     
     // Imprimir hijos
-    for (auto& child : node->children) {
-        printTreeRecursive(child, depth + 1);
+    for (auto& child : node->getChildren()) {
+        printTreeRecursive(child, depth + 1, out);
     }
 }
 // Verificar si nodo está en árbol
 bool FileSystemTree::isNodeInTree(shared_ptr<TreeNode> node) {
-    return findNodeById(node->id) != nullptr;
+    return isAttached(node);
 }
 
-// Helper para estadísticas
-void FileSystemTree::collectStatsRecursive(shared_ptr<TreeNode> node, int depth, 
-                                          int& folderCount, int& fileCount, int& maxDepth, int& totalNodes) {
-    if (!node) return;
+// Verificar si el nodo sigue conectado a la raíz.
+// Sube por los padres solo hasta el primer ancestro ya comprobado en la
+// época actual y marca el camino; mover no cambia la época, eliminar sí.
+bool FileSystemTree::isAttached(shared_ptr<TreeNode> node) {
+    if (!node) return false;
+    if (node->attachedEpoch == attachEpoch) return true;
+    
+    vector<TreeNode*> path;
+    auto current = node;
+    bool attached = false;
+    while (true) {
+        if (current == root || current->attachedEpoch == attachEpoch) {
+            attached = true;
+            break;
+        }
+        path.push_back(current.get());
+        
+        auto parent = current->parent.lock();
+        if (!parent) break;
+        current = parent;
+    }
     
-    totalNodes++;
-    if (node->isFolder()) {
-        folderCount++;
+    if (attached) {
+        for (TreeNode* visited : path) {
+            visited->attachedEpoch = attachEpoch;
+        }
+    }
+    return attached;
+}
+
+// ¿ancestor contiene a node? Ambos deben estar conectados al árbol
+bool FileSystemTree::isAncestor(shared_ptr<TreeNode> ancestor, shared_ptr<TreeNode> node) {
+    return ancestor && node && OrderLabels::contains(*ancestor, *node);
+}
+
+// Reinsertar un nodo bajo un padre existente
+void FileSystemTree::restoreNode(shared_ptr<TreeNode> parent, shared_ptr<TreeNode> node) {
+    if (!parent || !node || !parent->isFolder() || !isAttached(parent)) {
+        throw invalid_argument("Directorio de destino no válido");
+    }
+    
+    parent->addChild(node);
+    OrderLabels::attach(parent, node);
+    invalidateSnapshot();
+    invalidateCachedPath(node);
+}
+
+// Transacciones: encolar operaciones
+void FileSystemTree::Batch::create(const string& parentPath, const string& name, NodeType type,
+                                   const string& content) {
+    ops.push_back({OpType::CREATE, parentPath, name, type, content});
+}
+
+void FileSystemTree::Batch::move(const string& sourcePath, const string& destPath) {
+    ops.push_back({OpType::MOVE, sourcePath, destPath, NodeType::FILE, ""});
+}
+
+void FileSystemTree::Batch::rename(const string& path, const string& newName) {
+    ops.push_back({OpType::RENAME, path, newName, NodeType::FILE, ""});
+}
+
+void FileSystemTree::Batch::remove(const string& path) {
+    ops.push_back({OpType::DELETE, path, "", NodeType::FILE, ""});
+}
+
+string FileSystemTree::Batch::describe(const Op& op) {
+    switch (op.type) {
+        case OpType::CREATE: {
+            string path = op.path + (op.path.empty() || op.path.back() != '/' ? "/" : "") + op.argument;
+            return (op.nodeType == NodeType::FOLDER ? "mkdir " : "touch ") + path;
+        }
+        case OpType::MOVE:
+            return "mv " + op.path + " " + op.argument;
+        case OpType::RENAME:
+            return "rename " + op.path + " " + op.argument;
+        case OpType::DELETE:
+            return "rm " + op.path;
+    }
+    return "";
+}
+
+// Helper: deshacer un paso. Los nodos vuelven a su posición entre los
+// hermanos; las etiquetas de orden solo necesitan que el intervalo quede
+// dentro del padre, no el orden entre hermanos
+void FileSystemTree::undoBatchStep(const BatchUndo& step) {
+    auto& node = step.node;
+    
+    if (step.type == Batch::OpType::RENAME) {
+        node->setName(step.name);
+        return;
+    }
+    
+    // Sacar el nodo de donde esté ahora (create, move)
+    if (auto current = node->parent.lock()) {
+        current->removeChild(node->getName());
+        node->parent.reset();
+        OrderLabels::detach(node);
+    }
+    if (step.type == Batch::OpType::CREATE) return;
+    
+    // Devolverlo a su padre anterior (move, delete)
+    step.parent->addChild(node);
+    OrderLabels::attach(step.parent, node);
+    auto& children = step.parent->asFolder()->children;
+    if (step.position + 1 < children.size()) {
+        rotate(children.begin() + step.position, children.end() - 1, children.end());
+    }
+}
+
+// Aplicar una transacción
+FileSystemTree::BatchResult FileSystemTree::commit(const Batch& batch) {
+    auto start = high_resolution_clock::now();
+    BatchResult result = {};
+    vector<BatchUndo> undo;
+    undo.reserve(batch.size());
+    int firstId = nextId;
+    
+    // Del índice de nombres solo importa el efecto neto: los nodos nuevos se
+    // indexan con su nombre final y de los previos basta el nombre original
+    unordered_set<const TreeNode*> createdNodes;
+    unordered_set<const TreeNode*> renamedNodes;
+    createdNodes.reserve(batch.size());
+    
+    // Las creaciones seguidas en una misma carpeta reutilizan el padre; las
+    // demás operaciones pueden cambiar rutas y lo olvidan
+    const string* lastParentPath = nullptr;
+    shared_ptr<TreeNode> lastParent;
+    
+    auto require = [this](const string& path, const string& message) {
+        auto node = findNodeByPath(path);
+        if (!node) {
+            throw invalid_argument(message + path);
+        }
+        return node;
+    };
+    auto positionOf = [](const shared_ptr<TreeNode>& parent, const shared_ptr<TreeNode>& node) {
+        const auto& children = parent->getChildren();
+        return static_cast<size_t>(find(children.begin(), children.end(), node) - children.begin());
+    };
+    
+    const auto& ops = batch.operations();
+    for (size_t i = 0; i < ops.size(); i++) {
+        const Batch::Op& op = ops[i];
+        try {
+            switch (op.type) {
+                case Batch::OpType::CREATE: {
+                    if (!lastParentPath || *lastParentPath != op.path) {
+                        lastParent = require(op.path, "Ruta no encontrada: ");
+                        lastParentPath = &op.path;
+                    }
+                    auto parentNode = lastParent;
+                    auto node = createNode(parentNode, op.argument, op.nodeType, op.content);
+                    undo.push_back({op.type, node, parentNode, 0, ""});
+                    createdNodes.insert(node.get());
+                    result.created.push_back(node);
+                    break;
+                }
+                case Batch::OpType::MOVE: {
+                    lastParentPath = nullptr;
+                    auto node = require(op.path, "Nodo origen no encontrado: ");
+                    auto destNode = require(op.argument, "Ruta destino no encontrada: ");
+                    auto parentNode = node->parent.lock();
+                    size_t position = parentNode ? positionOf(parentNode, node) : 0;
+                    moveNode(node, destNode);
+                    undo.push_back({op.type, node, parentNode, position, ""});
+                    result.moved++;
+                    break;
+                }
+                case Batch::OpType::RENAME: {
+                    lastParentPath = nullptr;
+                    auto node = require(op.path, "Nodo no encontrado: ");
+                    string oldName = node->getName();
+                    renameNode(node, op.argument);
+                    undo.push_back({op.type, node, nullptr, 0, oldName});
+                    if (!createdNodes.count(node.get()) && renamedNodes.insert(node.get()).second) {
+                        result.renamed.push_back({node, oldName});
+                    }
+                    break;
+                }
+                case Batch::OpType::DELETE: {
+                    lastParentPath = nullptr;
+                    auto node = require(op.path, "Nodo no encontrado: ");
+                    auto parentNode = node->parent.lock();
+                    size_t position = parentNode ? positionOf(parentNode, node) : 0;
+                    string originalPath = getFullPath(node);
+                    // El recolector no lo libera: la transacción conserva una referencia
+                    deleteNode(node);
+                    undo.push_back({op.type, node, parentNode, position, ""});
+                    result.removed.push_back({node, parentNode, originalPath});
+                    break;
+                }
+            }
+        } catch (const exception& e) {
+            for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+                undoBatchStep(*it);
+            }
+            nextId = firstId;
+            pathCache.clear();
+            bumpAttachEpoch();
+            invalidateSnapshot();
+            throw invalid_argument("Operación " + to_string(i + 1) + " (" + Batch::describe(op) + "): " + e.what());
+        }
+    }
+    
+    // Renombrados que volvieron a su nombre original
+    result.renamed.erase(remove_if(result.renamed.begin(), result.renamed.end(),
+        [](const pair<shared_ptr<TreeNode>, string>& entry) {
+            return entry.first->getName() == entry.second;
+        }), result.renamed.end());
+    
+    auto end = high_resolution_clock::now();
+    result.seconds = duration<double>(end - start).count();
+    return result;
+}
+
+// Consulta de rutas con comodines.
+// El recorrido descendente usa el índice de hijos en los segmentos literales.
+// Si tras una primera sonda sigue abierto y el último segmento tiene texto
+// fijo, se piden al índice de nombres los candidatos: con C candidatos el
+// filtrado ascendente cuesta unas C * profundidad comprobaciones; ese coste
+// (en estados descendentes) es el presupuesto del descendente antes de
+// cambiar de estrategia.
+vector<shared_ptr<TreeNode>> FileSystemTree::findByPattern(const string& pattern, shared_ptr<TreeNode> base,
+                                                           const LeafIndex& leafIndex, PatternStats* stats) {
+    PatternStats localStats = {false, 0, 0};
+    PatternStats& info = stats ? *stats : localStats;
+    info = {false, 0, 0};
+    
+    // Segmentos del patrón ("**" seguidos equivalen a uno)
+    vector<PathSegment> segments;
+    stringstream stream(pattern);
+    string part;
+    while (getline(stream, part, '/')) {
+        if (part.empty() || part == ".") continue;
+        if (part == "..") {
+            throw invalid_argument("Los patrones de find no admiten '..'");
+        }
+        if (part == "**" && !segments.empty() && segments.back().anyDepth) continue;
+        segments.emplace_back(part);
+    }
+    
+    // Absoluta: el primer segmento corresponde a la raíz
+    bool absolute = !pattern.empty() && pattern[0] == '/';
+    if (!base || absolute) base = root;
+    size_t first = 0;
+    if (absolute && !segments.empty() && !segments[0].anyDepth) {
+        if (!segments[0].matches(root->getName())) return {};
+        first = 1;
+    }
+    
+    vector<TreeNode*> found;
+    bool done = false;
+    
+    const PathSegment* leaf = segments.size() > first ? &segments.back() : nullptr;
+    bool selectiveLeaf = leaf && !leaf->anyDepth &&
+        (leaf->literal || GlobMatcher::literalPrefix(leaf->pattern).size() +
+                          GlobMatcher::literalSuffix(leaf->pattern).size() > 0);
+    
+    // El índice y las etiquetas de orden solo describen nodos conectados:
+    // bajo una base ya separada del árbol se recorre de arriba abajo
+    if (!leafIndex || !selectiveLeaf || !isAttached(base)) {
+        done = expandTopDown(base.get(), first, segments, numeric_limits<size_t>::max(), found, info.visited);
+    } else if (expandTopDown(base.get(), first, segments, TOP_DOWN_PROBE, found, info.visited)) {
+        done = true;
     } else {
-        fileCount++;
+        auto candidates = leafIndex(leaf->pattern);
+        info.candidates = candidates.size();
+        
+        size_t budget = max(TOP_DOWN_PROBE, candidates.size() * (segments.size() + 1) * BOTTOM_UP_COST);
+        found.clear();
+        info.visited = 0;
+        done = expandTopDown(base.get(), first, segments, budget, found, info.visited);
+        
+        if (!done) {
+            // Ascendente: subir desde cada candidato comprobando los segmentos
+            info.bottomUp = true;
+            found.clear();
+            vector<const string*> chain;
+            for (auto& candidate : candidates) {
+                if (!isAttached(candidate) || candidate == base || !isAncestor(base, candidate)) continue;
+                
+                chain.clear();
+                TreeNode* current = candidate.get();
+                while (current && current != base.get()) {
+                    chain.push_back(&current->getName());
+                    current = current->parent.lock().get();
+                }
+                reverse(chain.begin(), chain.end());
+                
+                if (matchesChain(segments, first, chain)) {
+                    found.push_back(candidate.get());
+                }
+            }
+            done = true;
+        }
     }
     
-    maxDepth = max(maxDepth, depth);
+    // Resultados únicos en preorden
+    sort(found.begin(), found.end(), [](const TreeNode* a, const TreeNode* b) {
+        return a->enter.label < b->enter.label;
+    });
+    found.erase(unique(found.begin(), found.end()), found.end());
     
-    for (auto& child : node->children) {
-        collectStatsRecursive(child, depth + 1, folderCount, fileCount, maxDepth, totalNodes);
+    vector<shared_ptr<TreeNode>> results;
+    results.reserve(found.size());
+    for (TreeNode* node : found) {
+        results.push_back(node->shared_from_this());
     }
+    return results;
 }
 
-// Obtener estadísticas del árbol
+// Obtener estadísticas del árbol: recorridos lineales sobre la instantánea
 FileSystemTree::TreeStats FileSystemTree::getTreeStats() {
     TreeStats stats;
     stats.totalNodes = 0;
     stats.folderCount = 0;
     stats.fileCount = 0;
     stats.maxDepth = 0;
-    stats.minDepth = INT_MAX;  // Usar INT_MAX que ahora está disponible
+    stats.minDepth = 0;
     stats.avgDepth = 0.0;
     stats.treeHeight = 0;
     
     if (!root) return stats;
     
-    // Usar BFS para calcular profundidades mínimas y promedio
-    queue<pair<shared_ptr<TreeNode>, int>> q;
-    q.push({root, 0});
-    
-    int totalLeafDepth = 0;
-    int leafCount = 0;
+    auto frozen = freeze();
+    stats.totalNodes = static_cast<int>(frozen->size());
+    stats.folderCount = static_cast<int>(frozen->folderCount());
+    stats.fileCount = stats.totalNodes - stats.folderCount;
     
-    while (!q.empty()) {
-        auto currentPair = q.front();
-        auto current = currentPair.first;
-        int depth = currentPair.second;
-        q.pop();
-        
-        stats.totalNodes++;
-        if (current->isFolder()) {
-            stats.folderCount++;
-        } else {
-            stats.fileCount++;
-        }
-        
-        // Si es hoja
-        if (current->children.empty()) {
-            leafCount++;
-            totalLeafDepth += depth;
-            stats.minDepth = min(stats.minDepth, depth);
-        }
-        
-        for (auto& child : current->children) {
-            q.push({child, depth + 1});
-        }
+    // Profundidades de las hojas (nodos sin hijos)
+    TreeSnapshot::LeafDepths leaves = frozen->leafDepths();
+    stats.minDepth = static_cast<int>(leaves.minDepth);
+    if (leaves.leaves > 0) {
+        stats.avgDepth = static_cast<double>(leaves.totalDepth) / leaves.leaves;
     }
     
-    stats.maxDepth = calculateHeight() - 1; // Altura - 1 para profundidad máxima
-    stats.treeHeight = calculateHeight();
-    
-    if (leafCount > 0) {
-        stats.avgDepth = static_cast<double>(totalLeafDepth) / leafCount;
-    } else {
-        stats.minDepth = 0;
-        stats.avgDepth = 0.0;
-    }
+    stats.treeHeight = static_cast<int>(frozen->maxDepth());
+    stats.maxDepth = stats.treeHeight - 1; // Altura - 1 para profundidad máxima
     
     return stats;
 }
 
 // Generar árbol grande para pruebas de rendimiento
-void FileSystemTree::generateLargeTree(int levels, int childrenPerLevel) {
-    cout << "Generando árbol grande con " << levels << " niveles y " 
+void FileSystemTree::generateLargeTree(int levels, int childrenPerLevel, JobControl* control) {
+    if (verbose) cout << "Generando árbol grande con " << levels << " niveles y " 
          << childrenPerLevel << " hijos por nivel..." << endl;
     
     // Limpiar árbol existente
-    root = make_shared<TreeNode>(0, "root", NodeType::FOLDER);
+    pathCache.clear();
+    NodeReclaimer::instance().retire(std::move(root));
+    root = TreeNode::create(0, "root", NodeType::FOLDER);
     nextId = 1;
     
+    // Total esperado: hijos + hijos^2 + ... + hijos^niveles
+    if (control) {
+        double expected = 0, levelNodes = 1;
+        for (int level = 0; level < levels; level++) {
+            levelNodes *= childrenPerLevel;
+            expected += levelNodes;
+        }
+        control->setTotal(expected < 9e18 ? static_cast<long long>(expected) : 0);
+    }
+    
+    // Al terminar o al cancelarse, lo generado queda etiquetado y visible
+    auto finish = [this]() {
+        OrderLabels::labelTree(root);
+        bumpAttachEpoch();
+        invalidateSnapshot();
+    };
+    
     // Usar BFS para generar el árbol
     queue<shared_ptr<TreeNode>> q;
     q.push(root);
     int currentLevel = 0;
     
-    while (!q.empty() && currentLevel < levels) {
-        int levelSize = q.size();
-        
-        for (int i = 0; i < levelSize; i++) {
-            auto current = q.front();
-            q.pop();
+    try {
+        while (!q.empty() && currentLevel < levels) {
+            int levelSize = q.size();
             
-            // Crear hijos para este nodo
-            for (int j = 0; j < childrenPerLevel; j++) {
-                string name = "nodo_L" + to_string(currentLevel + 1) + 
-                            "_P" + to_string(i) + "_H" + to_string(j);
-                NodeType type = (currentLevel == levels - 1) ? NodeType::FILE : NodeType::FOLDER;
+            for (int i = 0; i < levelSize; i++) {
+                auto current = q.front();
+                q.pop();
+                
+                if (control) {
+                    control->checkpoint();
+                    control->advance(childrenPerLevel);
+                }
                 
-                try {
-                    auto newNode = make_shared<TreeNode>(nextId++, name, type);
-                    current->addChild(newNode);
+                // Crear hijos para este nodo
+                for (int j = 0; j < childrenPerLevel; j++) {
+                    string name = "nodo_L" + to_string(currentLevel + 1) + 
+                                "_P" + to_string(i) + "_H" + to_string(j);
+                    NodeType type = (currentLevel == levels - 1) ? NodeType::FILE : NodeType::FOLDER;
                     
-                    if (currentLevel < levels - 1) {
-                        q.push(newNode);
+                    try {
+                        auto newNode = TreeNode::create(nextId++, name, type);
+                        current->addChild(newNode);
+                        
+                        if (currentLevel < levels - 1) {
+                            q.push(newNode);
+                        }
+                    } catch (const exception& e) {
+                        // Ignorar errores en generación
                     }
-                } catch (const exception& e) {
-                    // Ignorar errores en generación
                 }
             }
+            
+            currentLevel++;
         }
-        
-        currentLevel++;
+    } catch (...) {
+        finish();
+        throw;
     }
     
-    cout << "Árbol generado. Total de nodos: " << calculateSize() << endl;
+    finish();
+    
+    if (verbose) cout << "Árbol generado. Total de nodos: " << calculateSize() << endl;
 }
 
 // Medir tiempo de recorrido
-double FileSystemTree::measureTraversalTime() {
+double FileSystemTree::measureTraversalTime(JobControl* control) {
     auto start = high_resolution_clock::now();
     
     // Realizar recorrido preorden
-    auto traversal = preorderTraversal();
+    auto traversal = preorderTraversal(control);
     
     auto end = high_resolution_clock::now();
     duration<double> elapsed = end - start;
@@ -536,7 +1085,7 @@ double FileSystemTree::measureTraversalTime() {
 }
 
 // Medir tiempo de búsqueda
-double FileSystemTree::measureSearchTime(const string& query) {
+double FileSystemTree::measureSearchTime(const string& query, JobControl* control) {
     auto start = high_resolution_clock::now();
     
     // Realizar búsqueda básica
@@ -548,11 +1097,16 @@ double FileSystemTree::measureSearchTime(const string& query) {
         auto current = q.front();
         q.pop();
         
-        if (current->name.find(query) != string::npos) {
+        if (control) {
+            control->checkpoint();
+            control->advance();
+        }
+        
+        if (current->getName().find(query) != string::npos) {
             results.push_back(current);
         }
         
-        for (auto& child : current->children) {
+        for (auto& child : current->getChildren()) {
             q.push(child);
         }
     }
@@ -565,166 +1119,73 @@ double FileSystemTree::measureSearchTime(const string& query) {
 
 // Validar estructura del árbol
 bool FileSystemTree::validateTreeStructure() {
-    cout << "=== VALIDACIÓN DE ESTRUCTURA DEL ÁRBOL ===" << endl;
-    
-    bool isValid = true;
+    TreeValidator::Report report = validate();
     
-    // 1. Verificar que la raíz no tenga padre
-    if (root->parent.lock()) {
-        cout << "ERROR: La raíz tiene un padre asignado." << endl;
-        isValid = false;
+    cout << "=== VALIDACIÓN DE ESTRUCTURA DEL ÁRBOL ===" << endl;
+    for (const auto& issue : report.issues) {
+        cout << (issue.type == TreeValidator::IssueType::DUPLICATE_NAME ? "ADVERTENCIA: " : "ERROR: ")
+             << issue.message << endl;
     }
     
-    // 2. Verificar consistencia padre-hijo
-    stack<shared_ptr<TreeNode>> s;
-    s.push(root);
-    
-    int inconsistencyCount = 0;
-    while (!s.empty()) {
-        auto current = s.top();
-        s.pop();
-        
-        for (auto& child : current->children) {
-            // Verificar que el padre del hijo sea correcto
-            auto parent = child->parent.lock();
-            if (parent != current) {
-                cout << "ERROR: Inconsistencia padre-hijo en nodo '" 
-                     << child->name << "' (ID: " << child->id << ")" << endl;
-                inconsistencyCount++;
-                isValid = false;
+    size_t total = 0;
+    for (size_t count : report.counts) total += count;
+    if (total > report.issues.size()) {
+        cout << "... y " << total - report.issues.size() << " problemas más:" << endl;
+        for (int type = 0; type <= static_cast<int>(TreeValidator::IssueType::DUPLICATE_NAME); type++) {
+            auto issueType = static_cast<TreeValidator::IssueType>(type);
+            if (report.count(issueType) > 0) {
+                cout << "  " << TreeValidator::describe(issueType) << ": " << report.count(issueType) << endl;
             }
-            s.push(child);
         }
     }
     
-    if (inconsistencyCount == 0) {
+    using Type = TreeValidator::IssueType;
+    if (report.count(Type::ROOT_HAS_PARENT) + report.count(Type::ORPHAN) + report.count(Type::PARENT_MISMATCH) == 0) {
         cout << "✓ Relaciones padre-hijo consistentes." << endl;
     }
-    
-    // 3. Verificar IDs únicos
-    unordered_set<int> ids;
-    s.push(root);
-    int duplicateCount = 0;
-    
-    while (!s.empty()) {
-        auto current = s.top();
-        s.pop();
-        
-        if (ids.find(current->id) != ids.end()) {
-            cout << "ERROR: ID duplicado encontrado: " << current->id 
-                 << " (Nodo: " << current->name << ")" << endl;
-            duplicateCount++;
-            isValid = false;
-        }
-        ids.insert(current->id);
-        
-        for (auto& child : current->children) {
-            s.push(child);
-        }
-    }
-    
-    if (duplicateCount == 0) {
+    if (report.count(Type::DUPLICATE_ID) == 0) {
         cout << "✓ Todos los IDs son únicos." << endl;
     }
-    
-    // 4. Verificar nombres duplicados en mismo nivel
-    s.push(root);
-    int duplicateNameCount = 0;
-    
-    while (!s.empty()) {
-        auto current = s.top();
-        s.pop();
-        
-        unordered_set<string> names;
-        for (auto& child : current->children) {
-            if (names.find(child->name) != names.end()) {
-                cout << "ADVERTENCIA: Nombre duplicado '" << child->name 
-                     << "' en hijos de '" << current->name << "'" << endl;
-                duplicateNameCount++;
-                // No marcamos como error porque técnicamente es permitido
-            }
-            names.insert(child->name);
-            s.push(child);
-        }
+    if (report.count(Type::CYCLE) == 0) {
+        cout << "✓ No hay ciclos." << endl;
     }
-    
-    if (duplicateNameCount == 0) {
+    if (report.count(Type::ORDER_LABELS) + report.count(Type::CHILD_INDEX) == 0) {
+        cout << "✓ Etiquetas de orden e índices de hijos correctos." << endl;
+    }
+    if (report.count(Type::DUPLICATE_NAME) == 0) {
         cout << "✓ No hay nombres duplicados en mismo nivel." << endl;
     }
+    cout << "Nodos revisados: " << report.nodes << " (" << report.folders << " carpetas) en "
+         << report.seconds * 1000 << " ms con " << report.threads << " hilo(s)" << endl;
     
     cout << "===========================================" << endl;
-    return isValid;
+    return report.valid();
 }
 
-// Encontrar nodos huérfanos
+// Validación completa en una pasada (ver TreeValidator)
+TreeValidator::Report FileSystemTree::validate(unsigned threads) {
+    return TreeValidator::validate(root, nextId, threads);
+}
+
+// Nodos alcanzables cuyo enlace al padre está vacío o caducado
 vector<string> FileSystemTree::findOrphanNodes() {
     vector<string> orphans;
-    unordered_set<shared_ptr<TreeNode>> visited;
-    
-    // Recorrer todo el árbol marcando nodos visitados
-    stack<shared_ptr<TreeNode>> s;
-    s.push(root);
-    
-    while (!s.empty()) {
-        auto current = s.top();
-        s.pop();
-        
-        visited.insert(current);
-        
-        for (auto& child : current->children) {
-            s.push(child);
+    for (const auto& issue : validate().issues) {
+        if (issue.type == TreeValidator::IssueType::ORPHAN) {
+            orphans.push_back(issue.message);
         }
     }
-    
-    // Buscar en todos los nodos creados (simulado)
-    // En un sistema real, tendríamos un registro de todos los nodos
-    
     return orphans;
 }
 
-// Encontrar ciclos
+// Ciclos: nodos que son antecesores de sí mismos
 vector<string> FileSystemTree::findCycles() {
     vector<string> cycles;
-    
-    // Usar DFS para detectar ciclos
-    unordered_set<int> visited;
-    unordered_set<int> recursionStack;
-    stack<pair<shared_ptr<TreeNode>, vector<string>>> s;
-    
-    s.push({root, {}});
-    
-    while (!s.empty()) {
-        auto [current, path] = s.top();
-        s.pop();
-        
-        if (recursionStack.find(current->id) != recursionStack.end()) {
-            // Ciclo detectado
-            string cyclePath = "Ciclo encontrado: ";
-            for (const auto& nodeName : path) {
-                cyclePath += nodeName + " -> ";
-            }
-            cyclePath += current->name;
-            cycles.push_back(cyclePath);
-            continue;
+    for (const auto& issue : validate().issues) {
+        if (issue.type == TreeValidator::IssueType::CYCLE) {
+            cycles.push_back(issue.message);
         }
-        
-        if (visited.find(current->id) != visited.end()) {
-            continue;
-        }
-        
-        visited.insert(current->id);
-        recursionStack.insert(current->id);
-        
-        vector<string> newPath = path;
-        newPath.push_back(current->name);
-        
-        for (auto& child : current->children) {
-            s.push({child, newPath});
-        }
-        
-        recursionStack.erase(current->id);
     }
-    
     return cycles;
 }
 
@@ -749,19 +1210,43 @@ void FileSystemTree::printTreeStats() {
     
     cout << "===============================\n" << endl;
 }
+
+// Imprimir estadísticas de la caché de rutas
+void FileSystemTree::printPathCacheStats() {
+    pathCache.printStats();
+}
 void FileSystemTree::rebuildTree(shared_ptr<TreeNode> newRoot, int newNextId) {
+    if (newRoot != root) {
+        NodeReclaimer::instance().retire(std::move(root));
+    }
+    pathCache.clear();
     root = newRoot;
     nextId = newNextId;
+    OrderLabels::labelTree(root);
+    bumpAttachEpoch();
+    invalidateSnapshot();
 }
 // Método para limpiar el árbol
 void FileSystemTree::clear() {
-    root = make_shared<TreeNode>(0, "root", NodeType::FOLDER);
+    pathCache.clear();
+    NodeReclaimer::instance().retire(std::move(root));
+    root = TreeNode::create(0, "root", NodeType::FOLDER);
     nextId = 1;
+    OrderLabels::labelTree(root);
+    bumpAttachEpoch();
+    invalidateSnapshot();
 }
 
 // Método para establecer nueva raíz
 void FileSystemTree::setRoot(shared_ptr<TreeNode> newRoot) {
+    if (newRoot != root) {
+        NodeReclaimer::instance().retire(std::move(root));
+    }
+    pathCache.clear();
     root = newRoot;
+    OrderLabels::labelTree(root);
+    bumpAttachEpoch();
+    invalidateSnapshot();
     
     // Encontrar el máximo ID para establecer nextId correctamente
     int maxId = 0;
@@ -776,7 +1261,7 @@ void FileSystemTree::setRoot(shared_ptr<TreeNode> newRoot) {
             maxId = current->id;
         }
         
-        for (auto& child : current->children) {
+        for (auto& child : current->getChildren()) {
             s.push(child);
         }
     }
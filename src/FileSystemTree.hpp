@@ -2,45 +2,121 @@
 #define FILESYSTEMTREE_HPP
 
 #include "TreeNode.hpp"
+#include "PathCache.hpp"
+#include "TreeSnapshot.hpp"
+#include "TreeValidator.hpp"
 #include <vector>
 #include <string>
 #include <memory>
 #include <chrono>
+#include <iostream>
+#include <functional>
+#include <mutex>
 
 using namespace std;
 
+class JobControl;
+
 class FileSystemTree {
+public:
+    // Transacción: operaciones encoladas que se aplican juntas con commit.
+    // Las rutas son absolutas, como en findNodeByPath, y se resuelven al
+    // aplicar (una operación puede usar carpetas creadas por las anteriores)
+    class Batch {
+    public:
+        enum class OpType { CREATE, MOVE, RENAME, DELETE };
+        
+        struct Op {
+            OpType type;
+            string path;        // Carpeta padre (create) o nodo afectado
+            string argument;    // Nombre (create, rename) o carpeta destino (move)
+            NodeType nodeType;  // Solo create
+            string content;     // Solo create de archivos
+        };
+        
+    private:
+        vector<Op> ops;
+        
+    public:
+        // 1. Encolar operaciones (nada se comprueba hasta commit)
+        void create(const string& parentPath, const string& name, NodeType type,
+                    const string& content = "");
+        void move(const string& sourcePath, const string& destPath);
+        void rename(const string& path, const string& newName);
+        void remove(const string& path);
+        
+        // 2. Consultas
+        const vector<Op>& operations() const { return ops; }
+        size_t size() const { return ops.size(); }
+        bool empty() const { return ops.empty(); }
+        void clear() { ops.clear(); }
+        
+        // 3. La operación como comando de consola ("mv /root/a /root/b")
+        static string describe(const Op& op);
+    };
+    
+    // Efecto neto de una transacción, para actualizar índices de una vez
+    struct BatchResult {
+        struct Removal {
+            shared_ptr<TreeNode> node;    // Subárbol ya desconectado
+            shared_ptr<TreeNode> parent;  // Padre en el momento de eliminarlo
+            string originalPath;
+        };
+        
+        vector<shared_ptr<TreeNode>> created;             // En orden de creación
+        vector<pair<shared_ptr<TreeNode>, string>> renamed;  // Nodos previos y su nombre original
+        vector<Removal> removed;
+        size_t moved;
+        double seconds;
+    };
+    
 private:
     shared_ptr<TreeNode> root;
     int nextId;
-    
-    // Helper: dividir ruta en componentes
+    bool verbose;  // Mensajes por operación ("Nodo creado", ...)
+    PathCache pathCache;
+    uint64_t attachEpoch;  // Cambia en cada desconexión: invalida las comprobaciones de isAttached
+    shared_ptr<const TreeSnapshot> snapshot;  // Nula si el árbol cambió desde freeze()
+    mutex snapshotMutex;  // freeze() se llama también desde trabajos (save)
+    
+    // Helper: dividir ruta en componentes. Un primer componente "root" es
+    // el nombre de la raíz y se omite; los demás son nombres normales
     vector<string> splitPath(const string& path);
     
+    // Helper: ruta canónica ("/root/a/b") usada como clave de la caché
+    string canonicalPath(const string& path);
+    
+    // Helper: invalidar en caché la ruta de un nodo y sus descendientes
+    void invalidateCachedPath(shared_ptr<TreeNode> node);
+    
+    // Helper: nueva época de conexión (tras eliminar o cambiar la raíz)
+    void bumpAttachEpoch();
+    
+    // Helper: descartar la instantánea tras cualquier cambio de estructura
+    void invalidateSnapshot();
+    
+    // Helper: deshacer un paso de una transacción fallida
+    struct BatchUndo {
+        Batch::OpType type;
+        shared_ptr<TreeNode> node;
+        shared_ptr<TreeNode> parent;  // Padre anterior (move, delete) o actual (create)
+        size_t position;              // Posición anterior entre los hijos
+        string name;                  // Nombre anterior (rename)
+    };
+    void undoBatchStep(const BatchUndo& step);
+    
     // Helper: encontrar nodo por ID (recursivo)
     shared_ptr<TreeNode> findNodeById(shared_ptr<TreeNode> node, int id);
     
     // Helper: verificar si nombre ya existe en hijos
     bool nameExists(shared_ptr<TreeNode> parent, const string& name);
     
-    // Helper recursivo para altura
-    int calculateHeightRecursive(shared_ptr<TreeNode> node);
-    
-    // Helper recursivo para tamaño
-    int calculateSizeRecursive(shared_ptr<TreeNode> node);
-    
-    // Helper recursivo para consistencia
-    bool verifyConsistencyRecursive(shared_ptr<TreeNode> node, shared_ptr<TreeNode> expectedParent);
-    
     // Helper para imprimir árbol
-    void printTreeRecursive(shared_ptr<TreeNode> node, int depth);
-    
-    // Helper para estadísticas
-    void collectStatsRecursive(shared_ptr<TreeNode> node, int depth, 
-                              int& folderCount, int& fileCount, int& maxDepth, int& totalNodes);
+    void printTreeRecursive(shared_ptr<TreeNode> node, int depth, ostream& out);
 
 public:
     FileSystemTree();
+    ~FileSystemTree();
     
     // Operaciones básicas
     shared_ptr<TreeNode> createNode(const string& path, const string& name, 
@@ -49,8 +125,17 @@ public:
     bool renameNode(const string& path, const string& newName);
     bool deleteNode(const string& path);
     vector<string> listChildren(const string& path);
+    
+    // Operaciones sobre nodos ya resueltos (sin mensajes en consola)
+    shared_ptr<TreeNode> createNode(shared_ptr<TreeNode> parentNode, const string& name,
+                                   NodeType type, const string& content = "");
+    bool moveNode(shared_ptr<TreeNode> sourceNode, shared_ptr<TreeNode> destNode);
+    bool renameNode(shared_ptr<TreeNode> node, const string& newName);
+    bool deleteNode(shared_ptr<TreeNode> node);
+    vector<string> listChildren(shared_ptr<TreeNode> node);
+    
     string getFullPath(shared_ptr<TreeNode> node);
-    vector<string> preorderTraversal();
+    vector<string> preorderTraversal(JobControl* control = nullptr);
     
     // Búsqueda de nodos
     shared_ptr<TreeNode> findNodeByPath(const string& path);
@@ -59,7 +144,43 @@ public:
     // Verificar si nodo está en árbol
     bool isNodeInTree(shared_ptr<TreeNode> node);
     
-    // Propiedades del árbol
+    // Verificar si el nodo sigue conectado a la raíz actual
+    // (O(1) amortizado: el resultado se recuerda hasta la siguiente eliminación)
+    bool isAttached(shared_ptr<TreeNode> node);
+    
+    // ¿ancestor es el nodo o uno de sus ancestros? O(1) con etiquetas de orden
+    bool isAncestor(shared_ptr<TreeNode> ancestor, shared_ptr<TreeNode> node);
+    
+    // Reinsertar un nodo (por ejemplo, desde la papelera) bajo un padre
+    void restoreNode(shared_ptr<TreeNode> parent, shared_ptr<TreeNode> node);
+    
+    // Aplicar una transacción: las operaciones se ejecutan en orden con las
+    // mismas comprobaciones que una a una, pero sin mensajes. Si alguna
+    // falla se deshacen las anteriores (el árbol queda como estaba) y se
+    // lanza invalid_argument con el número de la operación. Los subárboles
+    // eliminados se devuelven en el resultado, no van al recolector
+    BatchResult commit(const Batch& batch);
+    
+    // Consultas de rutas con comodines (find): '*' y '?' dentro de un
+    // segmento, '**' cualquier número de segmentos. Las rutas relativas
+    // parten de base. leafIndex, si se da, devuelve los nodos cuyo nombre
+    // coincide con el último segmento (índice de nombres). Un segmento ".."
+    // lanza invalid_argument.
+    struct PatternStats {
+        bool bottomUp;      // Se filtraron los candidatos del índice
+        size_t visited;     // Estados visitados en el recorrido descendente
+        size_t candidates;  // Candidatos pedidos al índice
+    };
+    using LeafIndex = function<vector<shared_ptr<TreeNode>>(const string&)>;
+    vector<shared_ptr<TreeNode>> findByPattern(const string& pattern, shared_ptr<TreeNode> base = nullptr,
+                                               const LeafIndex& leafIndex = nullptr,
+                                               PatternStats* stats = nullptr);
+    
+    // Instantánea plana en preorden para análisis (ver TreeSnapshot); se
+    // reconstruye en la siguiente llamada después de un cambio
+    shared_ptr<const TreeSnapshot> freeze();
+    
+    // Propiedades del árbol (sobre la instantánea)
     int calculateHeight();
     int calculateSize();
     bool verifyTreeConsistency();
@@ -77,23 +198,30 @@ public:
     
     TreeStats getTreeStats();
     
-    // Pruebas de rendimiento
-    void generateLargeTree(int levels, int childrenPerLevel);
-    double measureTraversalTime();
-    double measureSearchTime(const string& query);
+    // Pruebas de rendimiento (control permite cancelar y ver el progreso)
+    void generateLargeTree(int levels, int childrenPerLevel, JobControl* control = nullptr);
+    double measureTraversalTime(JobControl* control = nullptr);
+    double measureSearchTime(const string& query, JobControl* control = nullptr);
     
-    // Casos límite y validación
+    // Casos límite y validación: una sola pasada en paralelo que devuelve
+    // un informe estructurado; las demás funciones lo resumen o lo imprimen.
+    // findOrphanNodes y findCycles devuelven como mucho MAX_ISSUES entradas
+    TreeValidator::Report validate(unsigned threads = 0);
     bool validateTreeStructure();
     vector<string> findOrphanNodes();
     vector<string> findCycles();
     
+    // Mensajes por operación (desactivados en modo silencioso)
+    void setVerbose(bool enabled);
+    
     // Getters
     shared_ptr<TreeNode> getRoot() const;
     int getNextId() const;
     
     // Utilidades
-    void printTree();
+    void printTree(ostream& out = cout);
     void printTreeStats();
+    void printPathCacheStats();
     // Método para reconstruir el árbol desde una raíz
     void rebuildTree(shared_ptr<TreeNode> newRoot, int newNextId);
 
@@ -0,0 +1,176 @@
+#include "FuzzyMatcher.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    const uint32_t REPLACEMENT = 0xFFFD;  // Secuencia UTF-8 inválida
+
+    // Bytes de continuación que siguen a un byte inicial (-1 si no es inicial)
+    int continuationBytes(unsigned char byte) {
+        if (byte < 0x80) return 0;
+        if ((byte & 0xE0) == 0xC0) return 1;
+        if ((byte & 0xF0) == 0xE0) return 2;
+        if ((byte & 0xF8) == 0xF0) return 3;
+        return -1;
+    }
+
+    bool isContinuation(unsigned char byte) {
+        return (byte & 0xC0) == 0x80;
+    }
+}
+
+FuzzyMatcher::FuzzyMatcher(const string& text, int maxEdits)
+    : query(decodeUtf8(text)), maxDistance(max(0, maxEdits)) {}
+
+// Helper: avanzar la fila con un carácter completo
+bool FuzzyMatcher::advance(const State& state, uint32_t c, State& next) const {
+    const vector<int>& row = state.row;
+    size_t n = query.size();
+
+    vector<int> newRow(n + 1);
+    newRow[0] = row[0] + 1;
+    int best = newRow[0];
+
+    for (size_t i = 1; i <= n; i++) {
+        int cost = query[i - 1] == c ? 0 : 1;
+        int value = min({newRow[i - 1] + 1, row[i] + 1, row[i - 1] + cost});
+
+        // Trasposición de dos caracteres adyacentes
+        if (i >= 2 && !state.previousRow.empty() &&
+            query[i - 1] == state.previousChar && query[i - 2] == c) {
+            value = min(value, state.previousRow[i - 2] + 1);
+        }
+
+        newRow[i] = value;
+        best = min(best, value);
+    }
+
+    next.previousRow = row;
+    next.row = std::move(newRow);
+    next.previousChar = c;
+    next.pending = 0;
+    next.pendingBytes = 0;
+
+    // Si ningún prefijo cabe en la distancia, ninguna extensión cabrá
+    return best <= maxDistance;
+}
+
+// 1. Estado inicial
+FuzzyMatcher::State FuzzyMatcher::start() const {
+    State state;
+    state.row.resize(query.size() + 1);
+    for (size_t i = 0; i <= query.size(); i++) {
+        state.row[i] = static_cast<int>(i);
+    }
+    state.previousChar = 0;
+    state.pending = 0;
+    state.pendingBytes = 0;
+    return state;
+}
+
+// 2. Consumir un byte del Trie
+bool FuzzyMatcher::step(const State& state, unsigned char byte, State& next) const {
+    if (state.pendingBytes > 0) {
+        if (isContinuation(byte)) {
+            uint32_t pending = (state.pending << 6) | (byte & 0x3F);
+            if (state.pendingBytes > 1) {
+                next = state;
+                next.pending = pending;
+                next.pendingBytes = state.pendingBytes - 1;
+                return true;
+            }
+            return advance(state, pending, next);
+        }
+
+        // Secuencia cortada: cuenta como un carácter inválido y el byte
+        // actual se procesa desde cero
+        State repaired;
+        if (!advance(state, REPLACEMENT, repaired)) return false;
+        return step(repaired, byte, next);
+    }
+
+    int extra = continuationBytes(byte);
+    if (extra < 0) {
+        return advance(state, REPLACEMENT, next);
+    }
+    if (extra == 0) {
+        return advance(state, byte, next);
+    }
+
+    next = state;
+    next.pending = byte & (0x3F >> extra);
+    next.pendingBytes = extra;
+    return true;
+}
+
+// 3. Distancia de la palabra consumida
+int FuzzyMatcher::accepts(const State& state) const {
+    if (state.pendingBytes > 0) return -1;
+
+    int distance = state.row.back();
+    return distance <= maxDistance ? distance : -1;
+}
+
+// 4. Longitud de la consulta
+size_t FuzzyMatcher::length() const {
+    return query.size();
+}
+
+// Decodificar UTF-8 con las mismas reglas que step
+vector<uint32_t> FuzzyMatcher::decodeUtf8(const string& text) {
+    vector<uint32_t> result;
+    uint32_t pending = 0;
+    int pendingBytes = 0;
+
+    for (unsigned char byte : text) {
+        if (pendingBytes > 0) {
+            if (isContinuation(byte)) {
+                pending = (pending << 6) | (byte & 0x3F);
+                if (--pendingBytes == 0) {
+                    result.push_back(pending);
+                }
+                continue;
+            }
+            result.push_back(REPLACEMENT);
+            pendingBytes = 0;
+        }
+
+        int extra = continuationBytes(byte);
+        if (extra < 0) {
+            result.push_back(REPLACEMENT);
+        } else if (extra == 0) {
+            result.push_back(byte);
+        } else {
+            pending = byte & (0x3F >> extra);
+            pendingBytes = extra;
+        }
+    }
+
+    if (pendingBytes > 0) {
+        result.push_back(REPLACEMENT);
+    }
+    return result;
+}
+
+// Distancia completa entre dos nombres (referencia para comparar)
+int FuzzyMatcher::editDistance(const string& a, const string& b) {
+    vector<uint32_t> x = decodeUtf8(a);
+    vector<uint32_t> y = decodeUtf8(b);
+    size_t n = x.size(), m = y.size();
+
+    vector<vector<int>> d(n + 1, vector<int>(m + 1));
+    for (size_t i = 0; i <= n; i++) d[i][0] = static_cast<int>(i);
+    for (size_t j = 0; j <= m; j++) d[0][j] = static_cast<int>(j);
+
+    for (size_t i = 1; i <= n; i++) {
+        for (size_t j = 1; j <= m; j++) {
+            int cost = x[i - 1] == y[j - 1] ? 0 : 1;
+            d[i][j] = min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + cost});
+            if (i > 1 && j > 1 && x[i - 1] == y[j - 2] && x[i - 2] == y[j - 1]) {
+                d[i][j] = min(d[i][j], d[i - 2][j - 2] + 1);
+            }
+        }
+    }
+    return d[n][m];
+}
@@ -0,0 +1,53 @@
+#ifndef FUZZYMATCHER_HPP
+#define FUZZYMATCHER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Autómata de Levenshtein (simulado por filas) para recorrer el Trie.
+// Trabaja sobre caracteres UTF-8 completos: "Imagenes" e "Imágenes" están a
+// distancia 1. Cuenta inserciones, borrados, sustituciones y trasposiciones
+// de caracteres adyacentes ("reprote" -> "reporte" también está a 1).
+// El Trie avanza byte a byte; la fila solo cambia al completar un carácter,
+// y una rama se poda en cuanto ningún valor de la fila cabe en la distancia.
+class FuzzyMatcher {
+public:
+    struct State {
+        vector<int> row;          // Distancias a cada prefijo de la consulta
+        vector<int> previousRow;  // Fila anterior (para trasposiciones)
+        uint32_t previousChar;    // Último carácter consumido
+        uint32_t pending;         // Bytes acumulados de un carácter incompleto
+        int pendingBytes;         // Bytes que faltan para completarlo
+    };
+
+private:
+    vector<uint32_t> query;
+    int maxDistance;
+
+    // Helper: avanzar la fila con un carácter completo
+    bool advance(const State& state, uint32_t c, State& next) const;
+
+public:
+    FuzzyMatcher(const string& text, int maxEdits);
+
+    // 1. Estado inicial (palabra vacía)
+    State start() const;
+
+    // 2. Consumir un byte; false si la rama ya no puede coincidir
+    bool step(const State& state, unsigned char byte, State& next) const;
+
+    // 3. Distancia de la palabra consumida, o -1 si supera el máximo
+    int accepts(const State& state) const;
+
+    // 4. Longitud de la consulta en caracteres
+    size_t length() const;
+
+    // Utilidades
+    static vector<uint32_t> decodeUtf8(const string& text);
+    static int editDistance(const string& a, const string& b);
+};
+
+#endif // FUZZYMATCHER_HPP
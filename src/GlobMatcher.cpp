@@ -0,0 +1,186 @@
+#include "GlobMatcher.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    bool isContinuation(unsigned char byte) {
+        return (byte & 0xC0) == 0x80;
+    }
+
+    bool isWildcard(char c) {
+        return c == '*' || c == '?';
+    }
+}
+
+GlobMatcher::GlobMatcher(const string& pattern, bool reversed) : reversed(reversed) {
+    for (size_t i = 0; i < pattern.size(); i++) {
+        char c = pattern[i];
+        if (c == '\\' && i + 1 < pattern.size()) {
+            tokens.push_back({false, false, static_cast<unsigned char>(pattern[++i])});
+        } else if (isWildcard(c)) {
+            // "**" equivale a "*"
+            if (c == '*' && !tokens.empty() && tokens.back().anyLength) continue;
+            tokens.push_back({true, c == '*', 0});
+        } else {
+            tokens.push_back({false, false, static_cast<unsigned char>(c)});
+        }
+    }
+
+    if (reversed) {
+        reverse(tokens.begin(), tokens.end());
+    }
+}
+
+size_t GlobMatcher::stateCount() const {
+    return 2 * tokens.size() + 1;
+}
+
+bool GlobMatcher::test(const State& state, size_t s) {
+    return (state.active[s / 64] >> (s % 64)) & 1;
+}
+
+void GlobMatcher::set(State& state, size_t s) {
+    state.active[s / 64] |= uint64_t(1) << (s % 64);
+}
+
+// Helper: cierre epsilon. Los estados solo avanzan hacia posiciones mayores,
+// así que basta una pasada en orden
+void GlobMatcher::close(State& state) const {
+    size_t n = tokens.size();
+    for (size_t p = 0; p < n; p++) {
+        bool here = test(state, p);
+        // Un '?' completo (modo directo) continúa en la siguiente posición
+        if (!reversed && !tokens[p].anyLength && tokens[p].wildcard && test(state, n + 1 + p)) {
+            set(state, p + 1);
+        }
+        if (here && tokens[p].anyLength) {
+            set(state, p + 1);
+        }
+    }
+}
+
+// 1. Estado inicial
+GlobMatcher::State GlobMatcher::start() const {
+    State state;
+    state.active.assign(stateCount() / 64 + 1, 0);
+    set(state, 0);
+    close(state);
+    return state;
+}
+
+// 2. Consumir un byte del Trie
+bool GlobMatcher::step(const State& state, unsigned char byte, State& next) const {
+    size_t n = tokens.size();
+    next.active.assign(state.active.size(), 0);
+    bool continuation = isContinuation(byte);
+    bool alive = false;
+
+    for (size_t p = 0; p < n; p++) {
+        const Token& token = tokens[p];
+        bool here = test(state, p);
+        bool inside = token.wildcard && !token.anyLength && test(state, n + 1 + p);
+        if (!here && !inside) continue;
+
+        if (!token.wildcard) {
+            if (token.byte == byte) {
+                set(next, p + 1);
+                alive = true;
+            }
+        } else if (token.anyLength) {
+            set(next, p);
+            alive = true;
+        } else if (!reversed) {
+            // '?': byte inicial y después sus bytes de continuación
+            if (here && !continuation) {
+                set(next, n + 1 + p);
+                alive = true;
+            } else if (inside && continuation) {
+                set(next, n + 1 + p);
+                alive = true;
+            }
+        } else {
+            // '?' al revés: continuaciones primero, el byte inicial lo cierra
+            if (continuation) {
+                set(next, n + 1 + p);
+            } else {
+                set(next, p + 1);
+            }
+            alive = true;
+        }
+    }
+
+    close(next);
+    return alive;
+}
+
+// 3. ¿Coincide la palabra consumida?
+int GlobMatcher::accepts(const State& state) const {
+    return test(state, tokens.size()) ? 0 : -1;
+}
+
+// 4. Comprobar un texto completo
+bool GlobMatcher::matches(const string& text) const {
+    State state = start();
+    State next;
+    for (unsigned char byte : text) {
+        if (!step(state, byte, next)) return false;
+        swap(state, next);
+    }
+    return accepts(state) == 0;
+}
+
+// Utilidades
+bool GlobMatcher::hasWildcards(const string& pattern) {
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '\\') {
+            i++;
+        } else if (isWildcard(pattern[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+string GlobMatcher::literalPrefix(const string& pattern) {
+    string prefix;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+            prefix += pattern[++i];
+        } else if (isWildcard(pattern[i])) {
+            break;
+        } else {
+            prefix += pattern[i];
+        }
+    }
+    return prefix;
+}
+
+bool GlobMatcher::containsLiteral(const string& pattern, string& literal) {
+    if (pattern.size() < 3 || pattern.front() != '*' || pattern.back() != '*') return false;
+
+    // El texto intermedio no puede tener comodines ni terminar escapando el '*' final
+    string middle = pattern.substr(1, pattern.size() - 2);
+    size_t trailingEscapes = 0;
+    for (size_t i = middle.size(); i > 0 && middle[i - 1] == '\\'; i--) {
+        trailingEscapes++;
+    }
+    if (hasWildcards(middle) || trailingEscapes % 2 == 1) return false;
+
+    literal = literalPrefix(middle);
+    return true;
+}
+
+string GlobMatcher::literalSuffix(const string& pattern) {
+    string suffix;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+            suffix += pattern[++i];
+        } else if (isWildcard(pattern[i])) {
+            suffix.clear();
+        } else {
+            suffix += pattern[i];
+        }
+    }
+    return suffix;
+}
@@ -0,0 +1,65 @@
+#ifndef GLOBMATCHER_HPP
+#define GLOBMATCHER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Patrones glob de nombres: '*' (cualquier secuencia), '?' (un carácter
+// UTF-8) y '\' para escapar un comodín. El patrón se compila a un AFN que
+// avanza byte a byte junto al Trie (mismo contrato que FuzzyMatcher): una
+// rama se poda en cuanto no queda ningún estado activo.
+// En modo invertido el AFN reconoce el nombre leído al revés, para recorrer
+// el índice de sufijos con patrones como "*.docx".
+class GlobMatcher {
+public:
+    struct State {
+        vector<uint64_t> active;  // Estados activos del AFN (mapa de bits)
+    };
+
+private:
+    struct Token {
+        bool wildcard;    // '*' o '?'
+        bool anyLength;   // '*'
+        unsigned char byte;
+    };
+
+    vector<Token> tokens;
+    bool reversed;
+
+    // Estados: 0..n = posición en el patrón; n+1+i = dentro del '?' i
+    size_t stateCount() const;
+    static bool test(const State& state, size_t s);
+    static void set(State& state, size_t s);
+
+    // Helper: cierre epsilon (saltar '*' y completar '?')
+    void close(State& state) const;
+
+public:
+    GlobMatcher(const string& pattern, bool reversed = false);
+
+    // 1. Estado inicial
+    State start() const;
+
+    // 2. Consumir un byte; false si la rama ya no puede coincidir
+    bool step(const State& state, unsigned char byte, State& next) const;
+
+    // 3. 0 si la palabra consumida coincide, -1 si no
+    int accepts(const State& state) const;
+
+    // 4. ¿Coincide un texto completo? (en modo directo)
+    bool matches(const string& text) const;
+
+    // Utilidades sobre el patrón (sin escapes resueltos: bytes literales)
+    static bool hasWildcards(const string& pattern);
+    static string literalPrefix(const string& pattern);
+    static string literalSuffix(const string& pattern);
+
+    // ¿Es el patrón "*texto*" con texto sin comodines? Deja en literal el
+    // texto con los escapes resueltos
+    static bool containsLiteral(const string& pattern, string& literal);
+};
+
+#endif // GLOBMATCHER_HPP
@@ -0,0 +1,281 @@
+#include "JobManager.hpp"
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+using namespace chrono;
+
+JobControl::JobControl(ostream* sink)
+    : cancelRequested(false), completed(0), total(0), out(sink ? sink : &log) {}
+
+// 1. Cancelación cooperativa
+void JobControl::requestCancel() {
+    cancelRequested.store(true, memory_order_relaxed);
+}
+
+bool JobControl::isCancelled() const {
+    return cancelRequested.load(memory_order_relaxed);
+}
+
+void JobControl::checkpoint() const {
+    if (isCancelled()) {
+        throw JobCancelled();
+    }
+}
+
+// 2. Progreso
+void JobControl::setPhase(const string& newPhase) {
+    lock_guard<mutex> lock(phaseMutex);
+    phase = newPhase;
+}
+
+string JobControl::getPhase() const {
+    lock_guard<mutex> lock(phaseMutex);
+    return phase;
+}
+
+void JobControl::setTotal(long long units) {
+    completed.store(0, memory_order_relaxed);
+    total.store(units, memory_order_relaxed);
+}
+
+void JobControl::advance(long long units) {
+    completed.fetch_add(units, memory_order_relaxed);
+}
+
+long long JobControl::getCompleted() const {
+    return completed.load(memory_order_relaxed);
+}
+
+long long JobControl::getTotal() const {
+    return total.load(memory_order_relaxed);
+}
+
+// 3. Salida del trabajo
+ostream& JobControl::output() {
+    return *out;
+}
+
+string JobControl::takeLog() {
+    string text = log.str();
+    log.str("");
+    return text;
+}
+
+JobManager::JobManager() : nextJobId(1), session(0) {}
+
+JobManager::~JobManager() {
+    cancelAll();
+    for (auto& job : jobs) {
+        if (job->worker.joinable()) {
+            job->worker.join();
+        }
+    }
+}
+
+// Solo los trabajos de la sesión actual
+JobManager::Job* JobManager::findJob(int id) {
+    for (auto& job : jobs) {
+        if (job->id == id && job->session == session) return job.get();
+    }
+    return nullptr;
+}
+
+const char* JobManager::stateName(JobState state) {
+    switch (state) {
+        case JobState::RUNNING:   return "EN CURSO";
+        case JobState::DONE:      return "TERMINADO";
+        case JobState::CANCELLED: return "CANCELADO";
+        case JobState::FAILED:    return "FALLÓ";
+    }
+    return "?";
+}
+
+// 1. Lanzar un trabajo
+int JobManager::submit(const string& description, bool readsTree, Body body,
+                       bool async, ostream& out) {
+    if (!async) {
+        JobControl control(&out);
+        Completion completion = body(control);
+        if (completion) completion();
+        return 0;
+    }
+
+    auto job = make_unique<Job>();
+    job->id = nextJobId++;
+    job->description = description;
+    job->readsTree = readsTree;
+    job->session = session;
+    job->control = make_shared<JobControl>();
+    job->state = JobState::RUNNING;
+    job->started = steady_clock::now();
+
+    Job* raw = job.get();
+    job->worker = thread([raw, body]() {
+        JobState result = JobState::DONE;
+        try {
+            raw->completion = body(*raw->control);
+        } catch (const JobCancelled&) {
+            result = JobState::CANCELLED;
+        } catch (const exception& e) {
+            raw->error = e.what();
+            result = JobState::FAILED;
+        }
+        raw->finished = steady_clock::now();
+        raw->state.store(result, memory_order_release);
+    });
+
+    jobs.push_back(move(job));
+    out << "[" << raw->id << "] " << description << " en segundo plano" << endl;
+    return raw->id;
+}
+
+// Aplicar la finalización de un trabajo ya terminado e informar
+void JobManager::finish(Job& job, ostream& out) {
+    if (job.worker.joinable()) {
+        job.worker.join();
+    }
+
+    JobState state = job.state.load(memory_order_acquire);
+    duration<double> elapsed = job.finished - job.started;
+
+    out << "\n[" << job.id << "] " << stateName(state) << ": " << job.description
+        << " (" << fixed << setprecision(2) << elapsed.count() << " s)" << endl;
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+
+    string log = job.control->takeLog();
+    if (!log.empty()) {
+        out << log;
+        if (log.back() != '\n') out << endl;
+    }
+
+    if (state == JobState::DONE && job.completion) {
+        try {
+            job.completion();
+        } catch (const exception& e) {
+            out << "Error: " << e.what() << endl;
+        }
+    } else if (state == JobState::FAILED) {
+        out << "Error: " << job.error << endl;
+    }
+}
+
+// 2. Recoger los trabajos terminados
+void JobManager::reapFinished(ostream& out) {
+    ostream discarded(nullptr);
+    for (size_t i = 0; i < jobs.size();) {
+        int owner = jobs[i]->session;
+        bool mine = owner == session || owner == NO_SESSION;
+        if (mine && jobs[i]->state.load(memory_order_acquire) != JobState::RUNNING) {
+            // La finalización se aplica también si su sesión ya se cerró
+            finish(*jobs[i], owner == session ? out : discarded);
+            jobs.erase(jobs.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// 3. Listar trabajos
+void JobManager::list(ostream& out) {
+    bool any = any_of(jobs.begin(), jobs.end(), [this](const unique_ptr<Job>& job) {
+        return job->session == session;
+    });
+    if (!any) {
+        out << "No hay trabajos en segundo plano." << endl;
+        return;
+    }
+
+    out << "=== TRABAJOS ===" << endl;
+    auto now = steady_clock::now();
+    for (auto& job : jobs) {
+        if (job->session != session) continue;
+        JobState state = job->state.load(memory_order_acquire);
+        auto end = state == JobState::RUNNING ? now : job->finished;
+        duration<double> elapsed = end - job->started;
+
+        out << "[" << job->id << "] " << stateName(state) << "  ";
+
+        long long done = job->control->getCompleted();
+        long long total = job->control->getTotal();
+        if (total > 0) {
+            out << min(100LL, done * 100 / total) << "% (" << done << "/" << total << ")  ";
+        }
+        string phase = job->control->getPhase();
+        if (!phase.empty()) {
+            out << phase << "  ";
+        }
+        out << fixed << setprecision(1) << elapsed.count() << " s  " << job->description << endl;
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+}
+
+// 4. Cancelación
+bool JobManager::cancel(int id) {
+    Job* job = findJob(id);
+    if (!job || job->state.load(memory_order_acquire) != JobState::RUNNING) {
+        return false;
+    }
+    job->control->requestCancel();
+    return true;
+}
+
+void JobManager::cancelAll() {
+    for (auto& job : jobs) {
+        job->control->requestCancel();
+    }
+}
+
+// 5. Esperar a un trabajo (o a todos con id 0)
+bool JobManager::wait(int id, ostream& out) {
+    if (id == 0) {
+        for (auto& job : jobs) {
+            if (job->session == session && job->worker.joinable()) job->worker.join();
+        }
+        reapFinished(out);
+        return true;
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (jobs[i]->id == id && jobs[i]->session == session) {
+            finish(*jobs[i], out);
+            jobs.erase(jobs.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 6. Consultas
+size_t JobManager::runningCount() const {
+    size_t count = 0;
+    for (auto& job : jobs) {
+        if (job->state.load(memory_order_acquire) == JobState::RUNNING) count++;
+    }
+    return count;
+}
+
+bool JobManager::treeReaderActive(string& description) const {
+    for (auto& job : jobs) {
+        if (job->readsTree && job->state.load(memory_order_acquire) == JobState::RUNNING) {
+            description = "[" + to_string(job->id) + "] " + job->description;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 7. Sesiones
+void JobManager::setSession(int id) {
+    session = id;
+}
+
+void JobManager::endSession(int id) {
+    for (auto& job : jobs) {
+        if (job->session != id) continue;
+        job->control->requestCancel();
+        job->session = NO_SESSION;
+    }
+}
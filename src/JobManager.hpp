@@ -0,0 +1,133 @@
+#ifndef JOBMANAGER_HPP
+#define JOBMANAGER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+// Excepción lanzada en un punto de control cuando se pidió cancelar el trabajo
+class JobCancelled : public runtime_error {
+public:
+    JobCancelled() : runtime_error("Trabajo cancelado") {}
+};
+
+// Control compartido entre un trabajo y la consola: progreso, fase,
+// salida y petición de cancelación. Los bucles largos llaman a
+// checkpoint() para detenerse de forma cooperativa.
+class JobControl {
+private:
+    atomic<bool> cancelRequested;
+    atomic<long long> completed;
+    atomic<long long> total;
+    mutable mutex phaseMutex;
+    string phase;
+    ostringstream log;
+    ostream* out;
+
+public:
+    // Sin destino explícito la salida se acumula para mostrarla al terminar
+    explicit JobControl(ostream* sink = nullptr);
+
+    // 1. Cancelación cooperativa
+    void requestCancel();
+    bool isCancelled() const;
+    void checkpoint() const;
+
+    // 2. Progreso
+    void setPhase(const string& newPhase);
+    string getPhase() const;
+    void setTotal(long long units);
+    void advance(long long units = 1);
+    long long getCompleted() const;
+    long long getTotal() const;
+
+    // 3. Salida del trabajo
+    ostream& output();
+    string takeLog();
+};
+
+// Ejecutor de trabajos largos de la consola (generate, save, load, ...).
+// Cada trabajo corre en su propio hilo; lo que deba tocar el estado de la
+// consola se devuelve como una función de finalización que se ejecuta en
+// el hilo de la consola al recoger el trabajo.
+class JobManager {
+public:
+    using Completion = function<void()>;
+    using Body = function<Completion(JobControl&)>;
+
+    enum class JobState { RUNNING, DONE, CANCELLED, FAILED };
+
+    // Sesiones: 0 es la consola local; en modo servidor cada conexión
+    // tiene la suya y solo ve y recoge sus trabajos
+    static const int NO_SESSION = -1;
+
+private:
+    struct Job {
+        int id;
+        string description;
+        bool readsTree;  // Lee el árbol en vivo: bloquea las modificaciones
+        int session;     // Sesión que lo lanzó (NO_SESSION si ya se cerró)
+        shared_ptr<JobControl> control;
+        thread worker;
+        atomic<JobState> state;
+        Completion completion;
+        string error;
+        chrono::steady_clock::time_point started;
+        chrono::steady_clock::time_point finished;
+    };
+
+    vector<unique_ptr<Job>> jobs;
+    int nextJobId;
+    int session;  // Sesión actual: la que lanza, lista, cancela y recoge
+
+    // Helpers
+    Job* findJob(int id);
+    void finish(Job& job, ostream& out);
+    static const char* stateName(JobState state);
+
+public:
+    JobManager();
+    ~JobManager();
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    // 1. Lanzar un trabajo. En modo síncrono se ejecuta en el hilo llamador
+    //    con la salida directa a out y se devuelve 0.
+    int submit(const string& description, bool readsTree, Body body,
+               bool async, ostream& out = cout);
+
+    // 2. Recoger los trabajos terminados: aplicar su finalización e informar
+    void reapFinished(ostream& out);
+
+    // 3. Listar trabajos en curso y terminados sin recoger
+    void list(ostream& out);
+
+    // 4. Pedir la cancelación de un trabajo
+    bool cancel(int id);
+    void cancelAll();
+
+    // 5. Esperar a un trabajo (o a todos con id 0) y recogerlo
+    bool wait(int id, ostream& out);
+
+    // 6. Consultas (de todas las sesiones: el árbol es compartido)
+    size_t runningCount() const;
+    bool treeReaderActive(string& description) const;
+
+    // 7. Sesión a la que se atribuyen las llamadas siguientes. Al cerrar
+    //    una sesión sus trabajos se cancelan y se recogen sin informar
+    void setSession(int id);
+    void endSession(int id);
+};
+
+#endif // JOBMANAGER_HPP
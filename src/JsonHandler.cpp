@@ -1,5 +1,6 @@
 #include "JsonHandler.hpp"
 #include "FileSystemTree.hpp"
+#include "JobManager.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -9,28 +10,37 @@
 using json = nlohmann::json;
 using namespace std;
 
-bool JsonHandler::saveTree(shared_ptr<FileSystemTree> tree, const string& filename) {
+bool JsonHandler::saveTree(shared_ptr<FileSystemTree> tree, const string& filename,
+                           JobControl* control) {
+    ostream& out = control ? control->output() : cout;
+    ostream& err = control ? control->output() : cerr;
+    
     try {
         ofstream file(filename);
         if (!file.is_open()) {
-            cerr << "Error: No se pudo abrir " << filename << " para escritura" << endl;
+            err << "Error: No se pudo abrir " << filename << " para escritura" << endl;
             return false;
         }
         
         // Función recursiva para convertir nodo a JSON
         function<json(shared_ptr<TreeNode>)> toJson = [&](shared_ptr<TreeNode> node) -> json {
+            if (control) {
+                control->checkpoint();
+                control->advance();
+            }
+            
             json j;
             j["id"] = node->id;
-            j["name"] = node->name;
+            j["name"] = node->getName();
             j["type"] = node->isFolder() ? "FOLDER" : "FILE";
             
-            if (node->isFile() && !node->content.empty()) {
-                j["content"] = node->content;
+            if (node->isFile() && !node->getContent().empty()) {
+                j["content"] = node->getContent();
             }
             
-            if (!node->children.empty()) {
+            if (!node->getChildren().empty()) {
                 json children = json::array();
-                for (auto& child : node->children) {
+                for (auto& child : node->getChildren()) {
                     children.push_back(toJson(child));
                 }
                 j["children"] = children;
@@ -44,52 +54,74 @@ bool JsonHandler::saveTree(shared_ptr<FileSystemTree> tree, const string& filena
         
         // Metadatos
         json metadata;
+        if (control) control->setPhase("contando nodos");
+        int nodeCount = tree->calculateSize();
         metadata["version"] = "1.0";
         metadata["type"] = "filesystem_tree";
         metadata["nextId"] = tree->getNextId();
-        metadata["nodes"] = tree->calculateSize();
+        metadata["nodes"] = nodeCount;
         metadata["height"] = tree->calculateHeight();
         
         // Árbol
+        if (control) {
+            control->setPhase("serializando");
+            control->setTotal(nodeCount);
+        }
         json treeJson = toJson(tree->getRoot());
         
         rootJson["metadata"] = metadata;
         rootJson["tree"] = treeJson;
         
         // Escribir al archivo
+        if (control) {
+            control->checkpoint();
+            control->setPhase("escribiendo");
+        }
         file << rootJson.dump(2);
         file.close();
         
-        cout << "Árbol guardado exitosamente en " << filename << endl;
-        cout << "  Nodos guardados: " << tree->calculateSize() << endl;
+        out << "Árbol guardado exitosamente en " << filename << endl;
+        out << "  Nodos guardados: " << nodeCount << endl;
         
         return true;
         
+    } catch (const JobCancelled&) {
+        throw;
     } catch (const exception& e) {
-        cerr << "Error al guardar: " << e.what() << endl;
+        err << "Error al guardar: " << e.what() << endl;
         return false;
     }
 }
 
-bool JsonHandler::loadTree(shared_ptr<FileSystemTree> tree, const string& filename) {
+bool JsonHandler::loadTree(shared_ptr<FileSystemTree> tree, const string& filename,
+                           JobControl* control) {
+    ostream& out = control ? control->output() : cout;
+    ostream& err = control ? control->output() : cerr;
+    
     try {
         ifstream file(filename);
         if (!file.is_open()) {
-            cerr << "Error: No se pudo abrir " << filename << endl;
+            err << "Error: No se pudo abrir " << filename << endl;
             return false;
         }
         
         // Leer todo el archivo
+        if (control) control->setPhase("leyendo");
         stringstream buffer;
         buffer << file.rdbuf();
         file.close();
         
-        // Parsear JSON
-        json rootJson = json::parse(buffer.str());
+        // Parsear JSON (el callback permite cancelar a mitad del análisis)
+        if (control) control->setPhase("analizando JSON");
+        json::parser_callback_t onEvent = [control](int, json::parse_event_t, json&) {
+            if (control) control->checkpoint();
+            return true;
+        };
+        json rootJson = json::parse(buffer.str(), control ? onEvent : nullptr);
         
         // Verificar estructura
         if (!rootJson.contains("tree")) {
-            cerr << "Error: Formato JSON inválido - falta 'tree'" << endl;
+            err << "Error: Formato JSON inválido - falta 'tree'" << endl;
             return false;
         }
         
@@ -98,6 +130,11 @@ bool JsonHandler::loadTree(shared_ptr<FileSystemTree> tree, const string& filena
         fromJson = [&](const json& nodeJson) -> shared_ptr<TreeNode> {
             if (nodeJson.is_null()) return nullptr;
             
+            if (control) {
+                control->checkpoint();
+                control->advance();
+            }
+            
             int id = nodeJson["id"];
             string name = nodeJson["name"];
             string typeStr = nodeJson["type"];
@@ -108,7 +145,7 @@ bool JsonHandler::loadTree(shared_ptr<FileSystemTree> tree, const string& filena
                 content = nodeJson["content"];
             }
             
-            auto node = make_shared<TreeNode>(id, name, type, content);
+            auto node = TreeNode::create(id, name, type, content);
             
             // Procesar hijos
             if (nodeJson.contains("children") && nodeJson["children"].is_array()) {
@@ -124,34 +161,42 @@ bool JsonHandler::loadTree(shared_ptr<FileSystemTree> tree, const string& filena
         };
         
         // Construir árbol
-        json treeJson = rootJson["tree"];
+        if (control) {
+            control->setPhase("construyendo");
+            if (rootJson.contains("metadata") && rootJson["metadata"].contains("nodes")) {
+                control->setTotal(rootJson["metadata"]["nodes"].get<long long>());
+            }
+        }
+        const json& treeJson = rootJson["tree"];
         auto newRoot = fromJson(treeJson);
         
         if (!newRoot) {
-            cerr << "Error: No se pudo construir el árbol desde JSON" << endl;
+            err << "Error: No se pudo construir el árbol desde JSON" << endl;
             return false;
         }
         
         // Reemplazar la raíz del árbol
         tree->setRoot(newRoot);
         
-        cout << "Árbol cargado exitosamente desde " << filename << endl;
+        out << "Árbol cargado exitosamente desde " << filename << endl;
         
         // Mostrar metadatos si existen
         if (rootJson.contains("metadata")) {
-            json metadata = rootJson["metadata"];
+            const json& metadata = rootJson["metadata"];
             if (metadata.contains("nodes")) {
-                cout << "  Nodos cargados: " << metadata["nodes"] << endl;
+                out << "  Nodos cargados: " << metadata["nodes"] << endl;
             }
         }
         
         return true;
         
+    } catch (const JobCancelled&) {
+        throw;
     } catch (const json::exception& e) {
-        cerr << "Error JSON: " << e.what() << endl;
+        err << "Error JSON: " << e.what() << endl;
         return false;
     } catch (const exception& e) {
-        cerr << "Error: " << e.what() << endl;
+        err << "Error: " << e.what() << endl;
         return false;
     }
 }
\ No newline at end of file
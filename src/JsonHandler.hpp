@@ -7,10 +7,15 @@
 
 using namespace std;
 
+class JobControl;
+
 class JsonHandler {
 public:
-    static bool saveTree(shared_ptr<FileSystemTree> tree, const string& filename);
-    static bool loadTree(shared_ptr<FileSystemTree> tree, const string& filename);
+    // Con control, los mensajes van a la salida del trabajo y se puede cancelar
+    static bool saveTree(shared_ptr<FileSystemTree> tree, const string& filename,
+                         JobControl* control = nullptr);
+    static bool loadTree(shared_ptr<FileSystemTree> tree, const string& filename,
+                         JobControl* control = nullptr);
 };
 
 #endif
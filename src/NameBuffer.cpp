@@ -0,0 +1,140 @@
+#include "NameBuffer.hpp"
+#include "SimdSearch.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    // No compensa compactar bloques pequeños
+    const size_t MIN_COMPACT_BYTES = 1 << 16;
+}
+
+const uint32_t NameBuffer::NO_ENTRY;
+
+NameBuffer::NameBuffer() : deadEntries(0), deadBytes(0) {}
+
+size_t NameBuffer::entryLength(size_t entry) const {
+    size_t end = entry + 1 < starts.size() ? starts[entry + 1] : bytes.size();
+    return end - starts[entry] - 1;  // Sin el separador
+}
+
+// Helper: marcar una entrada como muerta
+void NameBuffer::killEntry(uint32_t entry) {
+    entryOf[ids[entry]] = NO_ENTRY;
+    ids[entry] = -1;
+    deadEntries++;
+    deadBytes += entryLength(entry) + 1;
+}
+
+// Helper: reescribir el bloque solo con las entradas vivas
+void NameBuffer::compact() {
+    string packed;
+    packed.reserve(bytes.size() - deadBytes);
+    vector<uint32_t> packedStarts;
+    vector<int> packedIds;
+    packedStarts.reserve(starts.size() - deadEntries);
+    packedIds.reserve(starts.size() - deadEntries);
+
+    for (size_t entry = 0; entry < starts.size(); entry++) {
+        if (ids[entry] < 0) continue;
+        entryOf[ids[entry]] = static_cast<uint32_t>(packedIds.size());
+        packedStarts.push_back(static_cast<uint32_t>(packed.size()));
+        packedIds.push_back(ids[entry]);
+        packed.append(bytes, starts[entry], entryLength(entry) + 1);
+    }
+
+    bytes.swap(packed);
+    starts.swap(packedStarts);
+    ids.swap(packedIds);
+    deadEntries = 0;
+    deadBytes = 0;
+}
+
+// 1. Añadir o sustituir un nombre
+void NameBuffer::set(int id, const string& name) {
+    if (id < 0) return;
+    if (static_cast<size_t>(id) >= entryOf.size()) {
+        entryOf.resize(max(static_cast<size_t>(id) + 1, entryOf.size() * 2), NO_ENTRY);
+    }
+
+    uint32_t entry = entryOf[id];
+    if (entry != NO_ENTRY) {
+        if (bytes.compare(starts[entry], entryLength(entry), name) == 0) return;
+        killEntry(entry);
+    }
+
+    entryOf[id] = static_cast<uint32_t>(starts.size());
+    starts.push_back(static_cast<uint32_t>(bytes.size()));
+    ids.push_back(id);
+    bytes += name;
+    bytes += '\0';
+
+    if (deadBytes >= MIN_COMPACT_BYTES && deadBytes * 2 >= bytes.size()) {
+        compact();
+    }
+}
+
+// 2. Quitar un ID
+void NameBuffer::remove(int id) {
+    if (id < 0 || static_cast<size_t>(id) >= entryOf.size() || entryOf[id] == NO_ENTRY) return;
+    killEntry(entryOf[id]);
+
+    if (deadBytes >= MIN_COMPACT_BYTES && deadBytes * 2 >= bytes.size()) {
+        compact();
+    }
+}
+
+// 3. Buscar una subcadena en todo el bloque
+vector<int> NameBuffer::searchContains(const string& text, bool ignoreCase) const {
+    vector<uint32_t> matched;
+    if (text.find('\0') != string::npos) return {};
+
+    string pattern = ignoreCase ? SimdSearch::toLowerAscii(text) : text;
+    const char* data = bytes.data();
+    size_t n = bytes.size();
+    size_t entry = 0;
+
+    for (size_t pos = SimdSearch::find(data, n, 0, pattern, ignoreCase); pos < n;
+         pos = SimdSearch::find(data, n, pos, pattern, ignoreCase)) {
+        // Entrada que contiene la coincidencia; se sigue desde la siguiente
+        entry = upper_bound(starts.begin() + entry, starts.end(), static_cast<uint32_t>(pos)) - starts.begin() - 1;
+        if (ids[entry] >= 0) {
+            matched.push_back(static_cast<uint32_t>(entry));
+        }
+        entry++;
+        if (entry >= starts.size()) break;
+        pos = starts[entry];
+    }
+
+    // Mismo orden que el Trie (por char); a igual nombre, orden de inserción
+    stable_sort(matched.begin(), matched.end(), [&](uint32_t a, uint32_t b) {
+        const char* nameA = data + starts[a];
+        const char* nameB = data + starts[b];
+        return lexicographical_compare(nameA, nameA + entryLength(a), nameB, nameB + entryLength(b));
+    });
+
+    vector<int> result;
+    result.reserve(matched.size());
+    for (uint32_t match : matched) {
+        result.push_back(ids[match]);
+    }
+    return result;
+}
+
+// 4. Estadísticas
+size_t NameBuffer::entries() const {
+    return starts.size() - deadEntries;
+}
+
+size_t NameBuffer::byteSize() const {
+    return bytes.size();
+}
+
+void NameBuffer::clear() {
+    bytes.clear();
+    starts.clear();
+    ids.clear();
+    entryOf.clear();
+    deadEntries = 0;
+    deadBytes = 0;
+}
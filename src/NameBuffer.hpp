@@ -0,0 +1,53 @@
+#ifndef NAMEBUFFER_HPP
+#define NAMEBUFFER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Nombres de todos los nodos en un único bloque contiguo, separados por
+// '\0', con una tabla (inicio, ID) por entrada. Buscar una subcadena es un
+// solo recorrido SIMD del bloque en lugar de visitar cadenas sueltas por el
+// montón; una coincidencia nunca cruza el separador, así que cada una cae
+// dentro de un nombre.
+// Renombrar o quitar un ID deja su entrada muerta; el bloque se compacta
+// cuando las entradas muertas ocupan la mitad.
+class NameBuffer {
+private:
+    static const uint32_t NO_ENTRY = UINT32_MAX;
+
+    string bytes;
+    vector<uint32_t> starts;     // Inicio de cada entrada en bytes
+    vector<int> ids;             // ID de cada entrada (-1 = muerta)
+    vector<uint32_t> entryOf;    // ID -> entrada (los IDs son densos)
+    size_t deadEntries;
+    size_t deadBytes;
+
+    // Helpers
+    void killEntry(uint32_t entry);
+    void compact();
+    size_t entryLength(size_t entry) const;
+
+public:
+    NameBuffer();
+
+    // 1. Añadir el nombre de un ID (sustituye el anterior si lo tenía)
+    void set(int id, const string& name);
+
+    // 2. Quitar un ID
+    void remove(int id);
+
+    // 3. IDs cuyo nombre contiene text, ordenados por nombre como el Trie
+    //    (y por orden de inserción a igual nombre). ignoreCase iguala
+    //    mayúsculas y minúsculas ASCII
+    vector<int> searchContains(const string& text, bool ignoreCase = false) const;
+
+    // 4. Estadísticas
+    size_t entries() const;     // Entradas vivas
+    size_t byteSize() const;    // Tamaño del bloque (incluye entradas muertas)
+    void clear();
+};
+
+#endif // NAMEBUFFER_HPP
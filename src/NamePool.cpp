@@ -0,0 +1,171 @@
+#include "NamePool.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <functional>
+
+namespace {
+    // Bytes reservados en el montón por una cadena (0 si cabe en el objeto)
+    size_t outOfLineBytes(const string& text) {
+        const char* data = text.data();
+        const char* object = reinterpret_cast<const char*>(&text);
+        bool inlined = data >= object && data < object + sizeof(string);
+        return inlined ? 0 : text.capacity() + 1;
+    }
+
+    const size_t INITIAL_BUCKETS = 1024;
+}
+
+const NamePool::Id NamePool::NO_NAME;
+
+NamePool::NamePool()
+    : chunks(new unique_ptr<Slot[]>[MAX_CHUNKS]), slotCount(0), uniqueNames(0),
+      buckets(INITIAL_BUCKETS, NO_NAME),
+      references(0), heapBytes(0), referencedHeapBytes(0) {}
+
+// Se reserva una sola vez y no se destruye: los nodos que aún vivan al
+// terminar el proceso (recolector, papelera) pueden seguir soltando nombres
+NamePool& NamePool::instance() {
+    static NamePool* pool = new NamePool();
+    return *pool;
+}
+
+// Helpers de la tabla hash (el tamaño es potencia de dos)
+size_t NamePool::bucketOf(const string_view& name) const {
+    return hash<string_view>()(name) & (buckets.size() - 1);
+}
+
+size_t NamePool::findBucket(const string_view& name) const {
+    size_t mask = buckets.size() - 1;
+    size_t bucket = bucketOf(name);
+    while (buckets[bucket] != NO_NAME && slot(buckets[bucket]).text != name) {
+        bucket = (bucket + 1) & mask;
+    }
+    return bucket;
+}
+
+void NamePool::growBuckets() {
+    vector<Id> previous(buckets.size() * 2, NO_NAME);
+    previous.swap(buckets);
+    for (Id id : previous) {
+        if (id != NO_NAME) buckets[findBucket(slot(id).text)] = id;
+    }
+}
+
+// Borrado con desplazamiento hacia atrás: sin lápidas, las cadenas de
+// sondeo siguen siendo contiguas
+void NamePool::eraseBucket(size_t bucket) {
+    size_t mask = buckets.size() - 1;
+    size_t hole = bucket;
+    for (size_t next = (hole + 1) & mask; buckets[next] != NO_NAME; next = (next + 1) & mask) {
+        size_t home = bucketOf(slot(buckets[next]).text);
+        // Se mueve si su cubeta natural no está entre el hueco y su posición
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            buckets[hole] = buckets[next];
+            hole = next;
+        }
+    }
+    buckets[hole] = NO_NAME;
+}
+
+// 1. Internar un nombre
+NamePool::Id NamePool::intern(const string& name) {
+    lock_guard<mutex> lock(poolMutex);
+
+    size_t bucket = findBucket(name);
+    if (buckets[bucket] != NO_NAME) {
+        Slot& existing = slot(buckets[bucket]);
+        existing.references++;
+        references++;
+        referencedHeapBytes += outOfLineBytes(existing.text);
+        return buckets[bucket];
+    }
+
+    Id id;
+    if (!freeSlots.empty()) {
+        id = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        if (slotCount >= MAX_CHUNKS * CHUNK_SIZE) {
+            throw length_error("Demasiados nombres distintos");
+        }
+        id = static_cast<Id>(slotCount++);
+        if (!chunks[id >> CHUNK_BITS]) {
+            chunks[id >> CHUNK_BITS].reset(new Slot[CHUNK_SIZE]);
+        }
+    }
+
+    Slot& created = slot(id);
+    created.text = name;
+    created.references = 1;
+    buckets[bucket] = id;
+    uniqueNames++;
+    if (uniqueNames * 2 > buckets.size()) {
+        growBuckets();
+    }
+
+    size_t extra = outOfLineBytes(created.text);
+    references++;
+    heapBytes += extra;
+    referencedHeapBytes += extra;
+    return id;
+}
+
+// 2. Soltar una referencia
+void NamePool::release(Id id) {
+    if (id == NO_NAME) return;
+    lock_guard<mutex> lock(poolMutex);
+
+    Slot& target = slot(id);
+    size_t extra = outOfLineBytes(target.text);
+    references--;
+    referencedHeapBytes -= extra;
+    if (--target.references > 0) return;
+
+    eraseBucket(findBucket(target.text));
+    uniqueNames--;
+    heapBytes -= extra;
+    string().swap(target.text);
+    freeSlots.push_back(id);
+}
+
+// 4. Buscar sin internar
+NamePool::Id NamePool::find(const string& name) const {
+    lock_guard<mutex> lock(poolMutex);
+    return buckets[findBucket(name)];
+}
+
+// 5. Estadísticas
+NamePool::Stats NamePool::stats() const {
+    lock_guard<mutex> lock(poolMutex);
+
+    Stats result;
+    result.uniqueNames = uniqueNames;
+    result.references = references;
+
+    // Huecos reservados, cadenas, tabla hash y el identificador de cada nodo
+    size_t chunkCount = (slotCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    result.poolBytes = chunkCount * CHUNK_SIZE * sizeof(Slot) + heapBytes
+                     + buckets.capacity() * sizeof(Id)
+                     + freeSlots.capacity() * sizeof(Id)
+                     + references * sizeof(Id);
+
+    // Sin pool cada nodo tendría su propio string
+    result.copiedBytes = references * sizeof(string) + referencedHeapBytes;
+    return result;
+}
+
+void NamePool::printStats() const {
+    Stats current = stats();
+    long long saved = static_cast<long long>(current.copiedBytes) - static_cast<long long>(current.poolBytes);
+
+    cout << "=== NOMBRES INTERNADOS ===" << endl;
+    cout << "Nombres distintos: " << current.uniqueNames
+         << " (usados por " << current.references << " nodos)" << endl;
+    cout << "Memoria del pool: " << current.poolBytes / 1024 << " KiB"
+         << " (una copia por nodo: " << current.copiedBytes / 1024 << " KiB)" << endl;
+    cout << "Ahorro: " << saved / 1024 << " KiB";
+    if (current.copiedBytes > 0) {
+        cout << " (" << saved * 100 / static_cast<long long>(current.copiedBytes) << "%)";
+    }
+    cout << endl;
+}
@@ -0,0 +1,95 @@
+#ifndef NAMEPOOL_HPP
+#define NAMEPOOL_HPP
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// Tabla global de nombres internados. Los árboles generados o importados
+// repiten mucho los mismos nombres ("index.html", "README.md", "nodo_L3_0"),
+// así que cada nodo guarda solo un identificador y el texto se almacena una
+// vez. Dos nombres son iguales si y solo si lo son sus identificadores.
+// Cada identificador cuenta sus referencias; al llegar a cero el hueco se
+// reutiliza para otro nombre. Las cadenas viven en bloques que no se mueven,
+// de modo que leer un nombre no necesita bloqueo.
+class NamePool {
+public:
+    using Id = uint32_t;
+    static const Id NO_NAME = UINT32_MAX;
+
+    struct Stats {
+        size_t uniqueNames;    // Nombres distintos vivos
+        size_t references;     // Nodos que los usan
+        size_t poolBytes;      // Memoria del pool (cadenas, huecos y tabla hash)
+        size_t copiedBytes;    // Lo que ocuparían con una cadena por nodo
+    };
+
+private:
+    static const size_t CHUNK_BITS = 12;
+    static const size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = size_t(1) << 16;
+
+    struct Slot {
+        string text;
+        uint32_t references;
+
+        Slot() : references(0) {}
+    };
+
+    // Bloques de CHUNK_SIZE huecos; el directorio tiene tamaño fijo para
+    // que los lectores nunca vean una reasignación
+    unique_ptr<unique_ptr<Slot[]>[]> chunks;
+    size_t slotCount;
+    vector<Id> freeSlots;
+    size_t uniqueNames;
+
+    // Tabla hash con direccionamiento abierto (sondeo lineal): cada cubeta
+    // guarda solo el identificador, el texto se compara en su hueco
+    vector<Id> buckets;
+    mutable mutex poolMutex;
+
+    // Contadores para estadísticas
+    size_t references;
+    size_t heapBytes;           // Bytes fuera de línea de las cadenas distintas
+    size_t referencedHeapBytes; // Los mismos, multiplicados por sus referencias
+
+    NamePool();
+
+    Slot& slot(Id id) const { return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]; }
+
+    // Helpers de la tabla hash (con poolMutex tomado)
+    size_t bucketOf(const string_view& name) const;
+    size_t findBucket(const string_view& name) const;  // Cubeta con name o la vacía donde iría
+    void growBuckets();
+    void eraseBucket(size_t bucket);
+
+public:
+    NamePool(const NamePool&) = delete;
+    NamePool& operator=(const NamePool&) = delete;
+
+    // Instancia única del proceso
+    static NamePool& instance();
+
+    // 1. Identificador de name, sumando una referencia (lo crea si no existe)
+    Id intern(const string& name);
+
+    // 2. Quitar una referencia (el hueco se libera al llegar a cero)
+    void release(Id id);
+
+    // 3. Texto de un identificador vivo (sin bloqueo)
+    const string& get(Id id) const { return slot(id).text; }
+
+    // 4. Identificador de name sin crearlo (NO_NAME si ningún nodo lo usa)
+    Id find(const string& name) const;
+
+    // 5. Estadísticas
+    Stats stats() const;
+    void printStats() const;
+};
+
+#endif // NAMEPOOL_HPP
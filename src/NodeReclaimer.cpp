@@ -0,0 +1,119 @@
+#include "NodeReclaimer.hpp"
+#include <iostream>
+
+using namespace std;
+
+NodeReclaimer::NodeReclaimer()
+    : stopping(false), working(false), maxPending(64),
+      retiredSubtrees(0), releasedNodes(0), inlineReleases(0) {
+    worker = thread(&NodeReclaimer::workerLoop, this);
+}
+
+NodeReclaimer::~NodeReclaimer() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+NodeReclaimer& NodeReclaimer::instance() {
+    static NodeReclaimer reclaimer;
+    return reclaimer;
+}
+
+// Bucle del hilo de fondo: libera los subárboles en orden de llegada
+void NodeReclaimer::workerLoop() {
+    while (true) {
+        shared_ptr<TreeNode> subtree;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            workAvailable.wait(lock, [this]() { return stopping || !pending.empty(); });
+
+            // Al detenerse se termina de vaciar la cola antes de salir
+            if (pending.empty()) {
+                break;
+            }
+
+            subtree = std::move(pending.front());
+            pending.pop_front();
+            working = true;
+        }
+
+        vector<shared_ptr<TreeNode>> stack;
+        stack.push_back(std::move(subtree));
+        releasedNodes += TreeNode::releaseIteratively(stack);
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            working = false;
+            if (pending.empty()) {
+                queueDrained.notify_all();
+            }
+        }
+    }
+}
+
+// 1. Entregar un subárbol para liberarlo en segundo plano
+void NodeReclaimer::retire(shared_ptr<TreeNode> subtree) {
+    if (!subtree) return;
+
+    retiredSubtrees++;
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (!stopping && pending.size() < maxPending) {
+            pending.push_back(std::move(subtree));
+            workAvailable.notify_one();
+            return;
+        }
+    }
+
+    // Cola llena: liberar aquí, también de forma iterativa
+    inlineReleases++;
+    vector<shared_ptr<TreeNode>> stack;
+    stack.push_back(std::move(subtree));
+    releasedNodes += TreeNode::releaseIteratively(stack);
+}
+
+// 2. Esperar a que toda la basura pendiente se libere
+void NodeReclaimer::drain() {
+    unique_lock<mutex> lock(queueMutex);
+    queueDrained.wait(lock, [this]() { return pending.empty() && !working; });
+}
+
+// 3. Configurar el máximo de subárboles pendientes
+void NodeReclaimer::setMaxPending(size_t limit) {
+    lock_guard<mutex> lock(queueMutex);
+    maxPending = limit;
+}
+
+// 4. Consultas de estado
+size_t NodeReclaimer::pendingCount() {
+    lock_guard<mutex> lock(queueMutex);
+    return pending.size() + (working ? 1 : 0);
+}
+
+long long NodeReclaimer::releasedCount() const {
+    return releasedNodes.load();
+}
+
+// 5. Estadísticas del recolector
+void NodeReclaimer::printStats() {
+    size_t queued;
+    size_t limit;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        queued = pending.size() + (working ? 1 : 0);
+        limit = maxPending;
+    }
+    
+    cout << "=== RECOLECTOR DE NODOS ===" << endl;
+    cout << "Subárboles entregados: " << retiredSubtrees.load() << endl;
+    cout << "Subárboles pendientes: " << queued << " (máximo " << limit << ")" << endl;
+    cout << "Nodos liberados: " << releasedNodes.load() << endl;
+    cout << "Liberaciones en hilo llamador: " << inlineReleases.load() << endl;
+}
@@ -0,0 +1,65 @@
+#ifndef NODERECLAIMER_HPP
+#define NODERECLAIMER_HPP
+
+#include "TreeNode.hpp"
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+// Recolector diferido de subárboles.
+// Los subárboles desconectados del árbol se entregan aquí en O(1) y se
+// liberan de forma iterativa en un hilo de fondo. Si la cola supera el
+// límite de basura pendiente, el subárbol se libera en el hilo llamador.
+class NodeReclaimer {
+private:
+    deque<shared_ptr<TreeNode>> pending;
+    mutex queueMutex;
+    condition_variable workAvailable;
+    condition_variable queueDrained;
+    thread worker;
+    bool stopping;
+    bool working;
+    size_t maxPending;
+
+    // Contadores para estadísticas
+    atomic<long long> retiredSubtrees;
+    atomic<long long> releasedNodes;
+    atomic<long long> inlineReleases;
+
+    NodeReclaimer();
+
+    // Bucle del hilo de fondo
+    void workerLoop();
+
+public:
+    ~NodeReclaimer();
+
+    NodeReclaimer(const NodeReclaimer&) = delete;
+    NodeReclaimer& operator=(const NodeReclaimer&) = delete;
+
+    // Instancia única del proceso
+    static NodeReclaimer& instance();
+
+    // 1. Entregar un subárbol para liberarlo en segundo plano
+    void retire(shared_ptr<TreeNode> subtree);
+
+    // 2. Esperar a que toda la basura pendiente se libere
+    void drain();
+
+    // 3. Configurar el máximo de subárboles pendientes
+    void setMaxPending(size_t limit);
+
+    // 4. Consultas de estado
+    size_t pendingCount();
+    long long releasedCount() const;
+
+    // 5. Estadísticas del recolector
+    void printStats();
+};
+
+#endif // NODERECLAIMER_HPP
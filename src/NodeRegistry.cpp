@@ -0,0 +1,231 @@
+#include "NodeRegistry.hpp"
+#include "NodeReclaimer.hpp"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+namespace {
+    // Estado de cada hueco durante el censo (índice = hueco)
+    const uint8_t UNSEEN = 0;
+    const uint8_t IN_TREE = 1;
+    const uint8_t IN_TRASH = 2;
+    const uint8_t DETACHED = 3;
+    const uint8_t STATE_MASK = 3;
+    const uint8_t COVERED = 4;   // Hijo de otro nodo desconectado: no es raíz
+    const uint8_t COUNTED = 8;   // Ya sumado a una raíz
+}
+
+NodeRegistry::NodeRegistry() : liveNodes(0), allocatedBlocks(0), allocatedBytes(0) {}
+
+// Como NamePool: no se destruye, para que los nodos que se liberen al
+// terminar el proceso (recolector, papelera) aún puedan darse de baja
+NodeRegistry& NodeRegistry::instance() {
+    static NodeRegistry* registry = new NodeRegistry();
+    return *registry;
+}
+
+// 1. Alta y baja de un nodo
+uint32_t NodeRegistry::add(TreeNode* node) {
+    lock_guard<mutex> lock(registryMutex);
+    liveNodes++;
+    if (!freeSlots.empty()) {
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        slots[slot] = node;
+        return slot;
+    }
+    slots.push_back(node);
+    return static_cast<uint32_t>(slots.size() - 1);
+}
+
+void NodeRegistry::remove(uint32_t slot) {
+    lock_guard<mutex> lock(registryMutex);
+    liveNodes--;
+    slots[slot] = nullptr;
+    freeSlots.push_back(slot);
+}
+
+// 2. Reserva y liberación de bloques
+void NodeRegistry::blockAllocated(size_t bytes) {
+    allocatedBlocks.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(static_cast<long long>(bytes), memory_order_relaxed);
+}
+
+void NodeRegistry::blockReleased(size_t bytes) {
+    allocatedBlocks.fetch_sub(1, memory_order_relaxed);
+    allocatedBytes.fetch_sub(static_cast<long long>(bytes), memory_order_relaxed);
+}
+
+// Helper: recorrido en profundidad que marca los nodos aún sin estado.
+// Un nodo ya marcado no se vuelve a recorrer (nodos compartidos, ciclos);
+// los creados después de empezar el censo quedan fuera
+void NodeRegistry::markReachable(const vector<shared_ptr<TreeNode>>& roots, vector<uint8_t>& states,
+                                 uint8_t mark, size_t& nodes, long long& bytes) {
+    vector<const TreeNode*> pending;
+    for (const auto& root : roots) {
+        if (root) pending.push_back(root.get());
+    }
+
+    while (!pending.empty()) {
+        const TreeNode* node = pending.back();
+        pending.pop_back();
+
+        uint32_t slot = slotOf(node);
+        if (slot >= states.size() || states[slot] != UNSEEN) continue;
+        states[slot] = mark;
+        nodes++;
+        bytes += node->footprint();
+
+        for (const auto& child : node->getChildren()) {
+            pending.push_back(child.get());
+        }
+    }
+}
+
+// 3. Censo: se marca lo alcanzable y todo lo demás que siga vivo está
+//    desconectado. Las raíces de lo desconectado son los nodos que no
+//    cuelgan de otro nodo desconectado
+NodeRegistry::Census NodeRegistry::census(const vector<shared_ptr<TreeNode>>& treeRoots,
+                                          const vector<shared_ptr<TreeNode>>& trashRoots) {
+    auto start = chrono::high_resolution_clock::now();
+    Census result = {};
+
+    size_t slotCount;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        slotCount = slots.size();
+    }
+    vector<uint8_t> states(slotCount, UNSEEN);
+
+    int tree = static_cast<int>(State::TREE);
+    int trash = static_cast<int>(State::TRASH);
+    int detachedState = static_cast<int>(State::DETACHED);
+    markReachable(treeRoots, states, IN_TREE, result.counts[tree], result.bytes[tree]);
+    markReachable(trashRoots, states, IN_TRASH, result.counts[trash], result.bytes[trash]);
+
+    // Fijar los nodos vivos que no se alcanzaron. Con el bloqueo tomado
+    // ningún nodo puede terminar de darse de baja; uno cuyo contador ya
+    // llegó a cero (o que aún se está construyendo) no se deja fijar
+    vector<shared_ptr<TreeNode>> detached;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        result.live = liveNodes;
+        for (size_t slot = 0; slot < slotCount; slot++) {
+            TreeNode* node = slots[slot];
+            if (!node || states[slot] != UNSEEN) continue;
+
+            shared_ptr<TreeNode> pinned = node->weak_from_this().lock();
+            if (!pinned) continue;
+            states[slot] = DETACHED;
+            detached.push_back(std::move(pinned));
+        }
+    }
+
+    for (const auto& node : detached) {
+        result.counts[detachedState]++;
+        result.bytes[detachedState] += node->footprint();
+        for (const auto& child : node->getChildren()) {
+            uint32_t slot = slotOf(child.get());
+            if (slot < slotCount && (states[slot] & STATE_MASK) == DETACHED) {
+                states[slot] |= COVERED;
+            }
+        }
+    }
+
+    // Tamaño retenido por cada raíz
+    vector<const TreeNode*> pending;
+    for (const auto& node : detached) {
+        if (states[slotOf(node.get())] & COVERED) continue;
+
+        Orphan orphan = {node, 0, 0, 0};
+        pending.push_back(node.get());
+        while (!pending.empty()) {
+            const TreeNode* current = pending.back();
+            pending.pop_back();
+
+            uint8_t& state = states[slotOf(current)];
+            if (state & COUNTED) continue;
+            state |= COUNTED;
+            orphan.nodes++;
+            orphan.bytes += current->footprint();
+
+            for (const auto& child : current->getChildren()) {
+                uint32_t slot = slotOf(child.get());
+                if (slot < slotCount && (states[slot] & STATE_MASK) == DETACHED) {
+                    pending.push_back(child.get());
+                }
+            }
+        }
+        result.orphans.push_back(std::move(orphan));
+    }
+
+    // Soltar los nodos fijados (fuera del bloqueo: alguno puede liberarse
+    // aquí si su última referencia desapareció durante el censo)
+    detached.clear();
+    for (auto& orphan : result.orphans) {
+        orphan.holders = orphan.node.use_count() - 1;
+    }
+    sort(result.orphans.begin(), result.orphans.end(), [](const Orphan& a, const Orphan& b) {
+        return a.nodes != b.nodes ? a.nodes > b.nodes : a.node->id < b.node->id;
+    });
+
+    result.blocks = static_cast<size_t>(max(0LL, allocatedBlocks.load()));
+    result.blockBytes = allocatedBytes.load();
+    if (result.blocks > result.live) {
+        result.zombieBlocks = result.blocks - result.live;
+        result.zombieBytes = result.blockBytes / static_cast<long long>(result.blocks) *
+                             static_cast<long long>(result.zombieBlocks);
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    result.seconds = chrono::duration<double>(end - start).count();
+    return result;
+}
+
+// 4. Desmontar los subárboles desconectados
+long long NodeRegistry::reclaim(const Census& census) {
+    long long handed = 0;
+
+    for (const auto& orphan : census.orphans) {
+        FolderNode* folder = orphan.node->asFolder();
+        if (!folder || folder->children.empty()) continue;
+
+        vector<shared_ptr<TreeNode>> children;
+        children.swap(folder->children);
+        folder->childIndex.reset();
+        for (auto& child : children) {
+            NodeReclaimer::instance().retire(std::move(child));
+        }
+        handed += orphan.nodes - 1;
+    }
+
+    return handed;
+}
+
+// 5. Estadísticas
+size_t NodeRegistry::liveCount() const {
+    lock_guard<mutex> lock(registryMutex);
+    return liveNodes;
+}
+
+void NodeRegistry::printStats(ostream& out) const {
+    size_t live, slotCount, freeCount;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        live = liveNodes;
+        slotCount = slots.size();
+        freeCount = freeSlots.size();
+    }
+    long long blocks = allocatedBlocks.load();
+
+    out << "\n=== REGISTRO DE NODOS ===" << endl;
+    out << "Nodos vivos: " << live << endl;
+    out << "Bloques reservados: " << blocks << " (" << (allocatedBytes.load() >> 10) << " KiB)" << endl;
+    if (blocks > static_cast<long long>(live)) {
+        out << "Bloques de nodos ya liberados retenidos por weak_ptr: "
+            << blocks - static_cast<long long>(live) << endl;
+    }
+    out << "Huecos del registro: " << slotCount << " (" << freeCount << " libres, "
+        << ((slotCount * sizeof(TreeNode*) + freeCount * sizeof(uint32_t)) >> 10) << " KiB)" << endl;
+}
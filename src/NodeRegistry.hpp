@@ -0,0 +1,131 @@
+#ifndef NODEREGISTRY_HPP
+#define NODEREGISTRY_HPP
+
+#include "TreeNode.hpp"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+using namespace std;
+
+// Registro de todos los nodos vivos del proceso, sean del árbol, de la
+// papelera o de ninguno. Cada nodo ocupa un hueco fijo desde su constructor
+// hasta su destructor, y su bloque de memoria se reserva con NodeAllocator,
+// de modo que se puede saber qué memoria sigue retenida aunque ningún árbol
+// la alcance: subárboles que solo mantiene vivos una referencia suelta (una
+// sesión remota situada en una carpeta borrada, un árbol a medio construir)
+// y bloques de nodos ya destruidos que aún sujeta un weak_ptr.
+class NodeRegistry {
+public:
+    // Estado de conexión de un nodo vivo
+    enum class State {
+        TREE,       // Alcanzable desde la raíz del árbol
+        TRASH,      // Alcanzable desde un elemento residente de la papelera
+        DETACHED    // Vivo pero inalcanzable: memoria retenida
+    };
+
+    // Raíz de un subárbol desconectado
+    struct Orphan {
+        shared_ptr<TreeNode> node;
+        long long nodes;     // Nodos vivos que retiene
+        long long bytes;     // Memoria aproximada (TreeNode::footprint)
+        long holders;        // Referencias fuertes que lo mantienen vivo
+    };
+
+    struct Census {
+        size_t live;                 // Nodos vivos registrados
+        size_t counts[3];            // Nodos por State
+        long long bytes[3];          // Memoria aproximada por State
+        size_t blocks;               // Bloques reservados por NodeAllocator
+        long long blockBytes;
+        size_t zombieBlocks;         // Bloques de nodos ya destruidos (weak_ptr)
+        long long zombieBytes;
+        vector<Orphan> orphans;      // Raíces desconectadas, de mayor a menor
+        double seconds;
+
+        size_t count(State state) const { return counts[static_cast<int>(state)]; }
+    };
+
+private:
+    vector<TreeNode*> slots;      // Nulo = hueco libre
+    vector<uint32_t> freeSlots;
+    size_t liveNodes;
+    mutable mutex registryMutex;
+
+    // Contadores del asignador (sin bloqueo)
+    atomic<long long> allocatedBlocks;
+    atomic<long long> allocatedBytes;
+
+    NodeRegistry();
+
+    static uint32_t slotOf(const TreeNode* node) { return node->registrySlot; }
+
+    // Helper: marcar los nodos aún sin estado alcanzables desde roots
+    static void markReachable(const vector<shared_ptr<TreeNode>>& roots, vector<uint8_t>& states,
+                              uint8_t mark, size_t& nodes, long long& bytes);
+
+public:
+    NodeRegistry(const NodeRegistry&) = delete;
+    NodeRegistry& operator=(const NodeRegistry&) = delete;
+
+    // Instancia única del proceso
+    static NodeRegistry& instance();
+
+    // 1. Alta y baja de un nodo (constructor y destructor de TreeNode)
+    uint32_t add(TreeNode* node);
+    void remove(uint32_t slot);
+
+    // 2. Reserva y liberación de bloques (NodeAllocator)
+    void blockAllocated(size_t bytes);
+    void blockReleased(size_t bytes);
+
+    // 3. Clasificar todos los nodos vivos según los alcancen treeRoots,
+    //    trashRoots o ninguno. Los nodos que se estén liberando en otro
+    //    hilo no se cuentan; conviene vaciar antes NodeReclaimer. Ningún
+    //    otro hilo debe estar añadiendo hijos a un árbol (trabajos en curso)
+    Census census(const vector<shared_ptr<TreeNode>>& treeRoots,
+                  const vector<shared_ptr<TreeNode>>& trashRoots);
+
+    // 4. Entregar al recolector diferido los hijos de los subárboles
+    //    desconectados. La raíz la sujeta otra referencia y queda vacía;
+    //    los descendientes con otras referencias no se tocan. Devuelve
+    //    los nodos entregados
+    static long long reclaim(const Census& census);
+
+    // 5. Estadísticas
+    size_t liveCount() const;
+    void printStats(ostream& out = cout) const;
+};
+
+// Asignador de los bloques de nodo (allocate_shared en TreeNode::create):
+// cuenta los bloques reservados. Un bloque sobrevive a su nodo mientras
+// quede algún weak_ptr que lo apunte
+template <typename T>
+struct NodeAllocator {
+    using value_type = T;
+
+    NodeAllocator() = default;
+    template <typename U>
+    NodeAllocator(const NodeAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        T* block = static_cast<T*>(::operator new(n * sizeof(T)));
+        NodeRegistry::instance().blockAllocated(n * sizeof(T));
+        return block;
+    }
+
+    void deallocate(T* block, size_t n) {
+        NodeRegistry::instance().blockReleased(n * sizeof(T));
+        ::operator delete(block);
+    }
+
+    template <typename U>
+    bool operator==(const NodeAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const NodeAllocator<U>&) const { return false; }
+};
+
+#endif // NODEREGISTRY_HPP
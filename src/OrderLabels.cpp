@@ -0,0 +1,240 @@
+#include "OrderLabels.hpp"
+#include <vector>
+#include <atomic>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    // Universo de etiquetas: [0, 2^62) deja margen para sumar sin desbordar
+    const int LABEL_BITS = 62;
+    const uint64_t LABEL_UNIVERSE = uint64_t(1) << LABEL_BITS;
+
+    // Umbral de densidad: un bloque de 2^i etiquetas admite 2^i / T^i marcas
+    const double DENSITY_BASE = 1.4;
+
+    atomic<long long> relabeled(0);
+}
+
+// Helper: encadenar en preorden las marcas de un subárbol sin etiquetar.
+// Devuelve el número de marcas encadenadas.
+size_t OrderLabels::linkSubtree(shared_ptr<TreeNode> node, OrderTag*& first, OrderTag*& last) {
+    size_t count = 0;
+    first = last = nullptr;
+
+    auto append = [&](OrderTag* tag) {
+        tag->prev = last;
+        tag->next = nullptr;
+        if (last) {
+            last->next = tag;
+        } else {
+            first = tag;
+        }
+        last = tag;
+        count++;
+    };
+
+    // Pila explícita (nodo, siguiente hijo): admite árboles muy profundos
+    vector<pair<TreeNode*, size_t>> pending = {{node.get(), 0}};
+    append(&node->enter);
+
+    while (!pending.empty()) {
+        auto& top = pending.back();
+        TreeNode* current = top.first;
+
+        if (top.second < current->getChildren().size()) {
+            TreeNode* child = current->getChildren()[top.second++].get();
+            append(&child->enter);
+            pending.push_back({child, 0});
+        } else {
+            append(&current->exit);
+            pending.pop_back();
+        }
+    }
+
+    return count;
+}
+
+// Helper: etiquetar las count marcas que siguen a after
+void OrderLabels::assignLabels(OrderTag* after, size_t count) {
+    OrderTag* before = after;
+    for (size_t i = 0; i <= count && before; i++) {
+        before = before->next;
+    }
+
+    uint64_t low = after->label;
+    uint64_t high = before ? before->label : LABEL_UNIVERSE;
+
+    // Camino rápido: el hueco admite las marcas con separación uniforme
+    if (high > low && high - low > count) {
+        uint64_t spacing = (high - low) / (count + 1);
+        OrderTag* tag = after->next;
+        for (size_t i = 1; i <= count; i++, tag = tag->next) {
+            tag->label = low + spacing * i;
+        }
+        return;
+    }
+
+    relabelBlock(after, count);
+}
+
+// Helper: reetiquetar el bloque alineado más pequeño alrededor de after
+// cuya densidad (contando las count marcas nuevas) quede bajo el umbral
+void OrderLabels::relabelBlock(OrderTag* after, size_t count) {
+    uint64_t anchor = after->label;
+    OrderTag* first = after;
+    size_t inside = 1 + count;
+
+    OrderTag* last = after;
+    for (size_t i = 0; i < count; i++) {
+        last = last->next;
+    }
+
+    for (int bits = 1; bits <= LABEL_BITS; bits++) {
+        uint64_t size = uint64_t(1) << bits;
+        uint64_t base = anchor & ~(size - 1);
+
+        // Ampliar el bloque hacia ambos lados con las marcas que caen dentro
+        while (first->prev && first->prev->label >= base) {
+            first = first->prev;
+            inside++;
+        }
+        while (last->next && last->next->label < base + size) {
+            last = last->next;
+            inside++;
+        }
+
+        bool lastBlock = bits == LABEL_BITS;
+        if (!lastBlock && inside * pow(DENSITY_BASE, bits) > static_cast<double>(size)) {
+            continue;
+        }
+
+        // En el último bloque se reparte la lista completa
+        if (lastBlock) {
+            while (first->prev) {
+                first = first->prev;
+                inside++;
+            }
+            while (last->next) {
+                last = last->next;
+                inside++;
+            }
+            base = 0;
+        }
+
+        uint64_t spacing = size / (inside + 1);
+        OrderTag* tag = first;
+        for (size_t i = 1; i <= inside; i++, tag = tag->next) {
+            tag->label = base + spacing * i;
+        }
+        relabeled += inside;
+        return;
+    }
+}
+
+// Helper: colocar entre sus vecinas las marcas first..last ya etiquetadas
+// sin contarlas ni repartirlas de nuevo. Si su intervalo ya cae en el hueco
+// no se escribe nada; si no, se trasladan al centro del hueco dividiendo
+// las distancias internas por la menor potencia de dos que lo haga caber.
+// false si así dos marcas quedan con la misma etiqueta
+bool OrderLabels::placeInGap(OrderTag* first, OrderTag* last) {
+    uint64_t low = first->prev->label;
+    uint64_t high = last->next ? last->next->label : LABEL_UNIVERSE;
+    if (high <= low + 2 || last->label < first->label) return false;
+    if (first->label > low && last->label < high) return true;
+
+    uint64_t oldFirst = first->label;
+    uint64_t span = last->label - oldFirst;
+    int shift = 0;
+    while ((span >> shift) > high - low - 2) shift++;
+
+    // Si dos marcas quedan con la misma etiqueta se abandona: el llamador
+    // reparte de nuevo todo el intervalo y sobrescribe lo ya escrito
+    uint64_t newFirst = low + 1 + ((high - low - 2) - (span >> shift)) / 2;
+    uint64_t previous = newFirst;
+    first->label = newFirst;
+    for (OrderTag* tag = first->next;; tag = tag->next) {
+        if (tag->label < oldFirst) return false;
+        uint64_t label = newFirst + ((tag->label - oldFirst) >> shift);
+        if (label <= previous) return false;
+        tag->label = previous = label;
+        if (tag == last) break;
+    }
+    return true;
+}
+
+// 1. Etiquetar un árbol completo
+void OrderLabels::labelTree(shared_ptr<TreeNode> root) {
+    if (!root) return;
+
+    OrderTag* first;
+    OrderTag* last;
+    size_t count = linkSubtree(root, first, last);
+
+    uint64_t spacing = LABEL_UNIVERSE / (count + 1);
+    uint64_t label = 0;
+    for (OrderTag* tag = first; tag; tag = tag->next) {
+        label += spacing;
+        tag->label = label;
+    }
+}
+
+// 2. Enlazar un subárbol como último hijo de parent
+void OrderLabels::attach(shared_ptr<TreeNode> parent, shared_ptr<TreeNode> node) {
+    if (!parent || !node) return;
+
+    // Un subárbol ya etiquetado conserva su cadena interna
+    OrderTag* first = &node->enter;
+    OrderTag* last = &node->exit;
+    bool labeled = node->enter.next != nullptr;
+    size_t count = labeled ? 0 : linkSubtree(node, first, last);
+
+    // Insertar antes de la marca de salida del padre
+    OrderTag* before = &parent->exit;
+    OrderTag* after = before->prev;
+    if (!after) {
+        // Padre sin etiquetar: enlazar su propia entrada y salida primero
+        parent->enter.next = before;
+        before->prev = &parent->enter;
+        after = &parent->enter;
+    }
+
+    after->next = first;
+    first->prev = after;
+    last->next = before;
+    before->prev = last;
+
+    // Un subárbol movido cabe casi siempre en el hueco con su separación
+    // interna; solo si no cabe se cuentan sus marcas y se reetiqueta
+    if (labeled) {
+        if (placeInGap(first, last)) return;
+        for (OrderTag* tag = first; tag != last; tag = tag->next) {
+            count++;
+        }
+        count++;
+    }
+    assignLabels(after, count);
+}
+
+// 3. Sacar un subárbol de la lista
+void OrderLabels::detach(shared_ptr<TreeNode> node) {
+    if (!node) return;
+
+    OrderTag* before = node->enter.prev;
+    OrderTag* after = node->exit.next;
+    if (before) before->next = after;
+    if (after) after->prev = before;
+
+    node->enter.prev = nullptr;
+    node->exit.next = nullptr;
+}
+
+// 4. Contención de intervalos
+bool OrderLabels::contains(const TreeNode& ancestor, const TreeNode& node) {
+    return ancestor.enter.label <= node.enter.label && node.exit.label <= ancestor.exit.label;
+}
+
+// 5. Estadísticas
+long long OrderLabels::relabeledTags() {
+    return relabeled.load();
+}
@@ -0,0 +1,43 @@
+#ifndef ORDERLABELS_HPP
+#define ORDERLABELS_HPP
+
+#include "TreeNode.hpp"
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+// Etiquetas de orden (order-maintenance) del recorrido en preorden.
+// Cada nodo tiene una marca de entrada y otra de salida; las marcas de un
+// árbol forman una lista enlazada con etiquetas crecientes, así que
+// "a contiene a b" se decide comparando etiquetas en O(1).
+// Al insertar en un hueco sin espacio se reetiqueta solo el bloque alineado
+// más pequeño que quede por debajo del umbral de densidad (amortizado O(log n)).
+// Un subárbol movido se traslada al hueco conservando su orden interno.
+class OrderLabels {
+private:
+    // Helpers
+    static size_t linkSubtree(shared_ptr<TreeNode> node, OrderTag*& first, OrderTag*& last);
+    static void assignLabels(OrderTag* after, size_t count);
+    static void relabelBlock(OrderTag* after, size_t count);
+    static bool placeInGap(OrderTag* first, OrderTag* last);
+
+public:
+    // 1. Etiquetar un árbol completo (raíz nueva, cargada o generada)
+    static void labelTree(shared_ptr<TreeNode> root);
+
+    // 2. Enlazar el subárbol de node como último hijo de parent.
+    //    Si el subárbol no tiene marcas (recién leído) se enlazan aquí.
+    static void attach(shared_ptr<TreeNode> parent, shared_ptr<TreeNode> node);
+
+    // 3. Sacar de la lista las marcas del subárbol de node en O(1)
+    static void detach(shared_ptr<TreeNode> node);
+
+    // 4. ¿ancestor contiene a node (o es el mismo)? Ambos en la misma lista
+    static bool contains(const TreeNode& ancestor, const TreeNode& node);
+
+    // 5. Marcas reetiquetadas desde el inicio (estadísticas)
+    static long long relabeledTags();
+};
+
+#endif // ORDERLABELS_HPP
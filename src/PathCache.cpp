@@ -0,0 +1,131 @@
+#include "PathCache.hpp"
+#include <iostream>
+#include <string_view>
+
+using namespace std;
+
+PathCache::PathCache(size_t maxEntries)
+    : capacity(maxEntries), hits(0), prefixHits(0), misses(0),
+      invalidated(0), evictions(0) {}
+
+// Helper: mover una entrada al frente del LRU
+void PathCache::touch(Entry& entry) {
+    lru.splice(lru.begin(), lru, entry.lruPosition);
+}
+
+// 1. Buscar una ruta canónica completa
+shared_ptr<TreeNode> PathCache::lookup(const string& canonicalPath) {
+    auto it = entries.find(canonicalPath);
+    if (it != entries.end()) {
+        auto node = it->second.node.lock();
+        if (node) {
+            touch(it->second);
+            hits++;
+            return node;
+        }
+        // El nodo ya fue liberado: descartar la entrada
+        lru.erase(it->second.lruPosition);
+        entries.erase(it);
+    }
+    return nullptr;
+}
+
+// 2. Buscar el prefijo más largo que esté en caché
+int PathCache::lookupLongestPrefix(const string& canonicalPath, const vector<size_t>& prefixEnds,
+                                   shared_ptr<TreeNode>& node) {
+    for (int i = static_cast<int>(prefixEnds.size()) - 1; i >= 0; i--) {
+        string_view prefix(canonicalPath.data(), prefixEnds[i]);
+        auto it = entries.find(prefix);
+        if (it == entries.end()) continue;
+
+        auto candidate = it->second.node.lock();
+        if (candidate) {
+            touch(it->second);
+            prefixHits++;
+            node = candidate;
+            return i;
+        }
+    }
+
+    misses++;
+    return -1;
+}
+
+// 3. Insertar o actualizar una ruta
+void PathCache::insert(const string& canonicalPath, shared_ptr<TreeNode> node) {
+    if (capacity == 0 || !node) return;
+
+    auto it = entries.find(canonicalPath);
+    if (it != entries.end()) {
+        it->second.node = node;
+        touch(it->second);
+        return;
+    }
+
+    // Expulsar la entrada menos usada si la caché está llena
+    if (entries.size() >= capacity) {
+        const string* oldest = lru.back();
+        lru.pop_back();
+        entries.erase(entries.find(*oldest));
+        evictions++;
+    }
+
+    auto inserted = entries.emplace(canonicalPath, Entry()).first;
+    lru.push_front(&inserted->first);
+    inserted->second.node = node;
+    inserted->second.lruPosition = lru.begin();
+}
+
+// 4. Invalidar una ruta y todas las que cuelgan de ella
+void PathCache::invalidate(const string& canonicalPath) {
+    auto it = entries.lower_bound(canonicalPath);
+
+    // Las claves con el mismo prefijo son contiguas; entre ellas puede haber
+    // hermanos como "/root/ab" al invalidar "/root/a", que se conservan
+    while (it != entries.end() && it->first.compare(0, canonicalPath.size(), canonicalPath) == 0) {
+        const string& key = it->first;
+        if (key.size() == canonicalPath.size() || key[canonicalPath.size()] == '/') {
+            lru.erase(it->second.lruPosition);
+            it = entries.erase(it);
+            invalidated++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+// 5. Vaciar la caché
+void PathCache::clear() {
+    invalidated += entries.size();
+    entries.clear();
+    lru.clear();
+}
+
+// 6. Contadores
+size_t PathCache::size() const {
+    return entries.size();
+}
+
+long long PathCache::getHits() const {
+    return hits;
+}
+
+long long PathCache::getMisses() const {
+    return misses;
+}
+
+double PathCache::hitRate() const {
+    long long total = hits + prefixHits + misses;
+    return total > 0 ? static_cast<double>(hits) / total : 0.0;
+}
+
+void PathCache::printStats() const {
+    cout << "=== CACHÉ DE RUTAS ===" << endl;
+    cout << "Entradas: " << entries.size() << " / " << capacity << endl;
+    cout << "Aciertos completos: " << hits << endl;
+    cout << "Aciertos por prefijo: " << prefixHits << endl;
+    cout << "Fallos: " << misses << endl;
+    cout << "Tasa de aciertos: " << hitRate() * 100 << "%" << endl;
+    cout << "Entradas invalidadas: " << invalidated << endl;
+    cout << "Expulsiones (LRU): " << evictions << endl;
+}
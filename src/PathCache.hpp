@@ -0,0 +1,65 @@
+#ifndef PATHCACHE_HPP
+#define PATHCACHE_HPP
+
+#include "TreeNode.hpp"
+#include <map>
+#include <list>
+#include <string>
+#include <memory>
+
+using namespace std;
+
+// Caché acotada ruta -> nodo para FileSystemTree::findNodeByPath.
+// Las claves son rutas canónicas ("/root/a/b"). Se guardan ordenadas para
+// poder invalidar con precisión una ruta y todos sus descendientes.
+class PathCache {
+private:
+    struct Entry {
+        weak_ptr<TreeNode> node;
+        list<const string*>::iterator lruPosition;
+    };
+
+    map<string, Entry, less<>> entries;
+    list<const string*> lru;  // Más reciente al frente
+    size_t capacity;
+
+    // Contadores de uso
+    long long hits;
+    long long prefixHits;
+    long long misses;
+    long long invalidated;
+    long long evictions;
+
+    // Helper: mover una entrada al frente del LRU
+    void touch(Entry& entry);
+
+public:
+    PathCache(size_t maxEntries = 4096);
+
+    // 1. Buscar una ruta canónica completa
+    shared_ptr<TreeNode> lookup(const string& canonicalPath);
+
+    // 2. Buscar el prefijo (directorio) más largo que esté en caché.
+    //    prefixEnds contiene el fin de cada prefijo dentro de canonicalPath;
+    //    devuelve el índice del prefijo encontrado o -1.
+    int lookupLongestPrefix(const string& canonicalPath, const vector<size_t>& prefixEnds,
+                            shared_ptr<TreeNode>& node);
+
+    // 3. Insertar o actualizar una ruta
+    void insert(const string& canonicalPath, shared_ptr<TreeNode> node);
+
+    // 4. Invalidar una ruta y todas las que cuelgan de ella
+    void invalidate(const string& canonicalPath);
+
+    // 5. Vaciar la caché (cambio de raíz)
+    void clear();
+
+    // 6. Contadores
+    size_t size() const;
+    long long getHits() const;
+    long long getMisses() const;
+    double hitRate() const;
+    void printStats() const;
+};
+
+#endif // PATHCACHE_HPP
@@ -0,0 +1,268 @@
+#include "PathImporter.hpp"
+#include "JobManager.hpp"
+#include <string_view>
+#include <unordered_map>
+#include <stdexcept>
+#include <chrono>
+
+using namespace std;
+
+namespace {
+    // Líneas entre dos puntos de cancelación y progreso
+    const long long CHECK_INTERVAL = 4096;
+
+    // Carpeta de la pila: la ruta de la línea anterior
+    struct Level {
+        FolderNode* folder;
+        bool ordered;             // Creada en esta línea y con los hijos en orden creciente
+        const string* lastChild;  // Último hijo creado (texto en NamePool)
+    };
+
+    // Componentes de una línea. "." y las barras repetidas se ignoran, una
+    // barra final marca una carpeta. Devuelve false si la ruta tiene ".."
+    bool splitLine(const string& line, vector<string_view>& parts, bool& folder) {
+        parts.clear();
+        size_t length = line.size();
+        if (length > 0 && line[length - 1] == '\r') length--;
+        folder = length > 0 && line[length - 1] == '/';
+
+        string_view text(line.data(), length);
+        size_t start = 0;
+        while (start < length) {
+            size_t end = text.find('/', start);
+            if (end == string_view::npos) end = length;
+            string_view part = text.substr(start, end - start);
+            if (part == "..") return false;
+            if (!part.empty() && part != ".") parts.push_back(part);
+            start = end + 1;
+        }
+        return true;
+    }
+
+    // a va antes que b comparando componente a componente
+    bool precedes(const vector<string_view>& a, const vector<string_view>& b) {
+        size_t common = min(a.size(), b.size());
+        for (size_t i = 0; i < common; i++) {
+            int order = a[i].compare(b[i]);
+            if (order != 0) return order < 0;
+        }
+        return a.size() < b.size();
+    }
+
+    // b cuelga de a
+    bool isPrefix(const vector<string_view>& a, const vector<string_view>& b) {
+        if (a.size() >= b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    // Hijo por nombre sin copiar el componente (el primero si se repite)
+    TreeNode* findChild(FolderNode* folder, string_view name) {
+        if (folder->childIndex) {
+            auto it = folder->childIndex->find(name);
+            return it != folder->childIndex->end() ? it->second : nullptr;
+        }
+        for (const auto& child : folder->children) {
+            if (child->getName() == name) return child.get();
+        }
+        return nullptr;
+    }
+
+    // Sustituir un archivo por una carpeta con el mismo ID y nombre en la
+    // misma posición. El archivo se creó en esta importación, así que aún
+    // no tiene etiquetas de orden que desenlazar
+    shared_ptr<TreeNode> promote(FolderNode* parent, TreeNode* file) {
+        auto& children = parent->children;
+        for (auto& slot : children) {
+            if (slot.get() != file) continue;
+
+            auto folder = TreeNode::create(file->id, file->getName(), NodeType::FOLDER);
+            folder->parent = file->parent;
+            if (parent->childIndex) {
+                auto it = parent->childIndex->find(file->getName());
+                if (it != parent->childIndex->end() && it->second == file) it->second = folder.get();
+            }
+            file->parent.reset();
+            slot = folder;
+            return folder;
+        }
+        return nullptr;
+    }
+}
+
+// 1. Importar una lista de rutas
+PathImporter::Stats PathImporter::import(FileSystemTree& tree, shared_ptr<TreeNode> base, istream& input,
+                                         JobControl* control) {
+    auto start = chrono::high_resolution_clock::now();
+    Stats stats = {};
+
+    if (!base || !base->isFolder()) {
+        throw invalid_argument("La base de la importación debe ser una carpeta");
+    }
+
+    // Con un flujo de tamaño conocido el progreso se mide en bytes
+    if (control) {
+        control->setPhase("importando");
+        streampos begin = input.tellg();
+        if (begin != streampos(-1)) {
+            input.seekg(0, ios::end);
+            streampos end = input.tellg();
+            input.seekg(begin);
+            if (end != streampos(-1)) control->setTotal(static_cast<long long>(end - begin));
+        }
+    }
+
+    const int firstId = tree.getNextId();
+    int nextId = firstId;
+    vector<Level> stack = {{base->asFolder(), false, nullptr}};
+
+    // Archivos promovidos que ya figuraban en createdRoots
+    unordered_map<TreeNode*, shared_ptr<TreeNode>> promotedRoots;
+
+    // Colocar una ruta: reutilizar el prefijo común con la pila y crear o
+    // buscar el resto
+    auto place = [&](const vector<string_view>& parts, bool folder) {
+        size_t depth = 0;
+        size_t limit = min(parts.size(), stack.size() - 1);
+        while (depth < limit && stack[depth + 1].folder->getName() == parts[depth]) depth++;
+        stats.reusedComponents += static_cast<long long>(depth);
+        stack.resize(depth + 1);
+
+        if (depth == parts.size()) {
+            stats.existing++;
+            return;
+        }
+
+        for (size_t i = depth; i < parts.size(); i++) {
+            Level& level = stack.back();
+            FolderNode* parent = level.folder;
+            string_view name = parts[i];
+            bool last = i + 1 == parts.size();
+            bool wantFolder = !last || folder;
+
+            // En una carpeta nueva con los hijos en orden, un nombre mayor
+            // que el último no puede estar repetido
+            bool unchecked = level.ordered && (!level.lastChild || name > *level.lastChild);
+            TreeNode* child = unchecked ? nullptr : findChild(parent, name);
+
+            if (child) {
+                if (child->isFile() && wantFolder) {
+                    if (child->id < firstId || !child->getContent().empty()) {
+                        stats.rejected++;
+                        return;
+                    }
+                    shared_ptr<TreeNode> folderNode = promote(parent, child);
+                    if (parent->id < firstId) promotedRoots[child] = folderNode;
+                    child = folderNode.get();
+                    stats.promoted++;
+                    stats.files--;
+                    stats.folders++;
+                }
+                if (last) stats.existing++;
+                if (child->isFolder()) stack.push_back({child->asFolder(), false, nullptr});
+                continue;
+            }
+
+            auto node = TreeNode::create(nextId++, string(name), wantFolder ? NodeType::FOLDER : NodeType::FILE);
+            parent->addChild(node);
+            if (unchecked) stats.uncheckedCreates++;
+            if (level.lastChild && !(name > *level.lastChild)) level.ordered = false;
+            level.lastChild = &node->getName();
+            if (parent->id < firstId) stats.createdRoots.push_back(node);
+
+            if (wantFolder) {
+                stats.folders++;
+                stack.push_back({node->asFolder(), true, nullptr});
+            } else {
+                stats.files++;
+            }
+        }
+    };
+
+    // Recalcular etiquetas, caché y ID siguiente, también si se cancela
+    auto finish = [&]() {
+        for (auto& root : stats.createdRoots) {
+            auto it = promotedRoots.find(root.get());
+            if (it != promotedRoots.end()) root = it->second;
+        }
+        tree.rebuildTree(tree.getRoot(), nextId);
+    };
+
+    // Se lee una línea por delante: una ruta es carpeta si la siguiente
+    // cuelga de ella
+    string lines[2];
+    vector<string_view> parts[2];
+    bool folders[2] = {false, false};
+    long long pendingBytes = 0;
+    long long sinceCheck = 0;
+
+    auto readPath = [&](int slot) -> bool {
+        while (getline(input, lines[slot])) {
+            pendingBytes += static_cast<long long>(lines[slot].size()) + 1;
+            if (!splitLine(lines[slot], parts[slot], folders[slot])) {
+                stats.lines++;
+                stats.rejected++;
+                continue;
+            }
+            if (!parts[slot].empty()) return true;
+        }
+        return false;
+    };
+
+    try {
+        int current = 0;
+        bool haveCurrent = readPath(current);
+        while (haveCurrent) {
+            int next = 1 - current;
+            bool haveNext = readPath(next);
+
+            stats.lines++;
+            bool folder = folders[current] || (haveNext && isPrefix(parts[current], parts[next]));
+            if (haveNext && precedes(parts[current], parts[next])) stats.sortedLines++;
+            place(parts[current], folder);
+
+            if (control && ++sinceCheck == CHECK_INTERVAL) {
+                control->checkpoint();
+                control->advance(pendingBytes);
+                pendingBytes = 0;
+                sinceCheck = 0;
+            }
+
+            current = next;
+            haveCurrent = haveNext;
+        }
+    } catch (...) {
+        finish();
+        throw;
+    }
+
+    if (control) control->advance(pendingBytes);
+    finish();
+
+    auto end = chrono::high_resolution_clock::now();
+    stats.seconds = chrono::duration<double>(end - start).count();
+    return stats;
+}
+
+// 2. Resumen de una importación
+void PathImporter::printStats(const Stats& stats, ostream& out) {
+    out << "\n=== IMPORTACIÓN DE RUTAS ===" << endl;
+    out << "Líneas: " << stats.lines << endl;
+    out << "Carpetas creadas: " << stats.folders << endl;
+    out << "Archivos creados: " << stats.files << endl;
+    out << "Rutas ya existentes: " << stats.existing << endl;
+    if (stats.rejected > 0) {
+        out << "Rutas rechazadas (\"..\" o a través de un archivo): " << stats.rejected << endl;
+    }
+    if (stats.promoted > 0) {
+        out << "Archivos convertidos en carpeta: " << stats.promoted << endl;
+    }
+    if (stats.lines > 1) {
+        out << "Líneas en orden: " << stats.sortedLines << " de " << stats.lines - 1 << endl;
+    }
+    out << "Componentes reutilizados de la línea anterior: " << stats.reusedComponents << endl;
+    out << "Nodos creados sin buscar duplicados: " << stats.uncheckedCreates << endl;
+    out << "Tiempo: " << stats.seconds << " s" << endl;
+}
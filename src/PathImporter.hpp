@@ -0,0 +1,53 @@
+#ifndef PATHIMPORTER_HPP
+#define PATHIMPORTER_HPP
+
+#include "FileSystemTree.hpp"
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+class JobControl;
+
+// Importación masiva de listas de rutas (salida de find, manifiestos): una
+// ruta por línea, relativa a la carpeta base; las carpetas intermedias que
+// falten se crean y una ruta que termina en '/' es una carpeta. La lista se
+// lee en streaming con una pila de carpetas que es la ruta de la línea
+// anterior: cada línea solo resuelve los componentes en que difiere, y en
+// las carpetas creadas por la importación que reciben sus hijos en orden
+// creciente (lista ordenada) no hace falta buscar duplicados. Si el orden
+// se rompe se busca cada componente en los hijos, como createNode.
+// Una línea es carpeta si la siguiente cuelga de ella; si se sabe más tarde
+// (lista desordenada), el archivo vacío creado por la importación se
+// convierte en carpeta. Las etiquetas de orden se recalculan una sola vez
+// al final; el índice de búsqueda lo construye quien llama.
+class PathImporter {
+public:
+    struct Stats {
+        long long lines;             // Líneas con una ruta
+        long long folders;           // Carpetas creadas
+        long long files;             // Archivos creados
+        long long existing;          // Rutas que ya existían
+        long long rejected;          // Rutas con ".." o que atraviesan un archivo
+        long long sortedLines;       // Líneas posteriores a la anterior (por componentes)
+        long long reusedComponents;  // Componentes resueltos con la pila de la línea anterior
+        long long uncheckedCreates;  // Nodos creados sin buscar duplicados
+        long long promoted;          // Archivos convertidos en carpeta
+        vector<shared_ptr<TreeNode>> createdRoots;  // Nodos nuevos colgados de carpetas que ya existían
+        double seconds;
+
+        long long created() const { return folders + files; }
+    };
+
+    // 1. Importar las rutas de input bajo base (una carpeta de tree). Con
+    //    control se informa el progreso en líneas y se puede cancelar; lo
+    //    ya importado se queda en el árbol, con las etiquetas al día
+    static Stats import(FileSystemTree& tree, shared_ptr<TreeNode> base, istream& input,
+                        JobControl* control = nullptr);
+
+    // 2. Resumen de una importación
+    static void printStats(const Stats& stats, ostream& out = cout);
+};
+
+#endif // PATHIMPORTER_HPP
@@ -1,49 +1,232 @@
 #include "SearchEngine.hpp"
+#include "NodeReclaimer.hpp"
+#include "OrderLabels.hpp"
+#include "FuzzyMatcher.hpp"
+#include "GlobMatcher.hpp"
 #include <iostream>
+#include <fstream>
 #include <algorithm>
 
 using namespace std;
 
-// Helper recursivo para indexar
-void SearchEngine::indexNodeRecursive(shared_ptr<TreeNode> node) {
+namespace {
+    // Términos del índice de contenido que se purgan sin soltar el mutex
+    const size_t CONTENT_PURGE_TERMS = 256;
+
+    // IDs de un nombre que se ordenan de una vez en la búsqueda paginada
+    const size_t PAGE_SORT_BATCH = 64;
+
+    string reversedName(const string& name) {
+        return string(name.rbegin(), name.rend());
+    }
+
+    // Huella FNV-1a de un archivo: liga el índice guardado a su instantánea
+    bool fileFingerprint(const string& filename, uint64_t& hash) {
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) return false;
+
+        hash = 1469598103934665603ULL;
+        char buffer[1 << 16];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+            for (streamsize i = 0; i < file.gcount(); i++) {
+                hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
+            }
+        }
+        return true;
+    }
+
+    string contentIndexFile(const string& snapshotFile) {
+        return snapshotFile + ".cidx";
+    }
+}
+
+// Helper para indexar (pila explícita: admite árboles muy profundos)
+void SearchEngine::indexNodeRecursive(shared_ptr<TreeNode> node, bool withContent, bool newIds) {
     if (!node) return;
-    
-    // Indexar el nombre del nodo actual
-    nameIndex.insert(node->name, node->id);
-    
-    // Indexar hijos recursivamente
-    for (auto& child : node->children) {
-        indexNodeRecursive(child);
+
+    vector<shared_ptr<TreeNode>> pending = {node};
+    vector<TreeNode*> files;
+    while (!pending.empty()) {
+        auto current = std::move(pending.back());
+        pending.pop_back();
+
+        // Indexar el nombre del nodo actual
+        nameIndex.insert(current->getName(), current->id, newIds);
+        suffixIndex.insert(reversedName(current->getName()), current->id, newIds);
+        nameBuffer.set(current->id, current->getName());
+        registerHandle(current);
+        if (withContent && current->isFile()) {
+            files.push_back(current.get());
+        }
+
+        // Indexar hijos
+        for (auto& child : current->getChildren()) {
+            pending.push_back(child);
+        }
+    }
+
+    addContents(files);
+}
+
+// Helper: añadir contenidos en orden de ID (las listas crecen por el final
+// y no hace falta fusionarlas después)
+void SearchEngine::addContents(vector<TreeNode*>& files) {
+    sort(files.begin(), files.end(), [](const TreeNode* a, const TreeNode* b) {
+        return a->id < b->id;
+    });
+    for (TreeNode* file : files) {
+        contentIndex.addDocument(file->id, file->getContent());
     }
 }
 
-// Helper recursivo para desindexar
+// Helper para desindexar un subárbol
 void SearchEngine::removeIndexRecursive(shared_ptr<TreeNode> node) {
     if (!node) return;
-    
-    // Remover el nombre del nodo actual
-    nameIndex.remove(node->name, node->id);
-    
-    // Remover hijos recursivamente
-    for (auto& child : node->children) {
-        removeIndexRecursive(child);
+
+    // Pila explícita, como indexNodeRecursive: admite árboles muy profundos
+    vector<TreeNode*> pending = {node.get()};
+    while (!pending.empty()) {
+        TreeNode* current = pending.back();
+        pending.pop_back();
+
+        nameIndex.remove(current->getName(), current->id);
+        suffixIndex.remove(reversedName(current->getName()), current->id);
+        nameBuffer.remove(current->id);
+        contentIndex.removeDocument(current->id);
+
+        for (const auto& child : current->getChildren()) {
+            pending.push_back(child.get());
+        }
     }
 }
 
-SearchEngine::SearchEngine(shared_ptr<FileSystemTree> fs) : fileSystem(fs) {
+SearchEngine::SearchEngine(shared_ptr<FileSystemTree> fs, bool indexContents)
+    : fileSystem(fs), tombstoneCount(0), compactionPending(false), compacting(false), stopping(false),
+      compactions(0), purgedEntries(0) {
     // Indexar árbol existente
-    rebuildIndex();
+    rebuildIndex(indexContents);
+}
+
+SearchEngine::~SearchEngine() {
+    {
+        lock_guard<mutex> lock(indexMutex);
+        stopping = true;
+    }
+    compactionRequested.notify_all();
+    compactionFinished.notify_all();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+// Helper: registrar la referencia id -> nodo
+void SearchEngine::registerHandle(const shared_ptr<TreeNode>& node) {
+    if (node->id < 0) return;
+    if (static_cast<size_t>(node->id) >= handles.size()) {
+        handles.resize(max(static_cast<size_t>(node->id) + 1, handles.size() * 2));
+    }
+    handles[node->id] = node;
+}
+
+// Helpers del mapa de bits de lápidas
+bool SearchEngine::isTombstoned(int id) const {
+    size_t word = static_cast<size_t>(id) / 64;
+    return id >= 0 && word < tombstones.size() && (tombstones[word] >> (id % 64)) & 1;
+}
+
+void SearchEngine::setTombstone(int id, bool value) {
+    if (id < 0) return;
+    size_t word = static_cast<size_t>(id) / 64;
+    if (word >= tombstones.size()) {
+        if (!value) return;
+        tombstones.resize(max(word + 1, tombstones.size() * 2));
+    }
+
+    uint64_t mask = uint64_t(1) << (id % 64);
+    bool current = tombstones[word] & mask;
+    if (current == value) return;
+
+    if (value) {
+        tombstones[word] |= mask;
+        tombstoneCount++;
+    } else {
+        tombstones[word] &= ~mask;
+        tombstoneCount--;
+    }
+}
+
+// Un nodo es visible si sigue conectado a la raíz y no cuelga de una raíz
+// con lápida. La conexión se comprueba con la época de FileSystemTree
+// (O(1) amortizado entre eliminaciones) y las lápidas conectadas por
+// contención de etiquetas de orden, en O(1) cada una. Sin lápidas todo
+// lo indexado es visible.
+bool SearchEngine::isVisible(const shared_ptr<TreeNode>& node, Visibility& visibility) const {
+    if (tombstoneCount == 0) {
+        return true;
+    }
+    if (!fileSystem->isAttached(node)) {
+        return false;
+    }
+
+    if (!visibility.ready) {
+        visibility.ready = true;
+        long long remaining = tombstoneCount;
+        for (size_t word = 0; word < tombstones.size() && remaining > 0; word++) {
+            for (uint64_t bits = tombstones[word]; bits; bits &= bits - 1, remaining--) {
+                size_t id = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                auto root = id < handles.size() ? handles[id].lock() : nullptr;
+                if (root && fileSystem->isAttached(root)) {
+                    visibility.attachedTombstones.push_back(root);
+                }
+            }
+        }
+    }
+
+    for (const auto& root : visibility.attachedTombstones) {
+        if (OrderLabels::contains(*root, *node)) return false;
+    }
+    return true;
+}
+
+// Helper: resolver un ID del Trie si el nodo es visible (y está dentro de
+// scope, comprobado en O(1) con las etiquetas de orden)
+shared_ptr<TreeNode> SearchEngine::resolveVisible(int id, Visibility& visibility,
+                                                  const TreeNode* scope) const {
+    if (id < 0 || static_cast<size_t>(id) >= handles.size()) return nullptr;
+
+    auto node = handles[id].lock();
+    if (!node || (scope && !OrderLabels::contains(*scope, *node))) return nullptr;
+
+    return isVisible(node, visibility) ? node : nullptr;
+}
+
+// Helper: convertir IDs del Trie en nodos visibles
+void SearchEngine::collectVisible(const vector<int>& nodeIds, vector<shared_ptr<TreeNode>>& results,
+                                  Visibility& visibility, const TreeNode* scope) const {
+    for (int id : nodeIds) {
+        if (auto node = resolveVisible(id, visibility, scope)) {
+            results.push_back(node);
+        }
+    }
 }
 
 // 1. Reconstruir índice completo
-void SearchEngine::rebuildIndex() {
+void SearchEngine::rebuildIndex(bool includeContents) {
+    lock_guard<mutex> lock(indexMutex);
     nameIndex = Trie();  // Reiniciar índice
-    indexNodeRecursive(fileSystem->getRoot());
+    suffixIndex = Trie();
+    nameBuffer.clear();
+    contentIndex.clear();
+    handles.clear();
+    tombstones.clear();
+    tombstoneCount = 0;
+    indexNodeRecursive(fileSystem->getRoot(), includeContents, true);
 }
 
 // 2. Indexar un nodo específico (y sus hijos)
 void SearchEngine::indexNode(shared_ptr<TreeNode> node) {
     if (node) {
+        lock_guard<mutex> lock(indexMutex);
         indexNodeRecursive(node);
     }
 }
@@ -51,78 +234,145 @@ void SearchEngine::indexNode(shared_ptr<TreeNode> node) {
 // 3. Remover nodo del índice
 void SearchEngine::removeNodeFromIndex(shared_ptr<TreeNode> node) {
     if (node) {
+        lock_guard<mutex> lock(indexMutex);
         removeIndexRecursive(node);
     }
 }
 
 // 4. Búsqueda exacta por nombre
 vector<shared_ptr<TreeNode>> SearchEngine::searchExact(const string& name) {
+    lock_guard<mutex> lock(indexMutex);
     vector<shared_ptr<TreeNode>> results;
-    vector<int> nodeIds = nameIndex.searchExact(name);
-    
-    for (int id : nodeIds) {
-        auto node = fileSystem->findNodeById(id);
-        if (node) {
-            results.push_back(node);
-        }
-    }
-    
+    Visibility visibility;
+
+    collectVisible(nameIndex.searchExact(name), results, visibility);
+
     return results;
 }
 
 // 5. Búsqueda por prefijo
-vector<shared_ptr<TreeNode>> SearchEngine::searchByPrefix(const string& prefix) {
+vector<shared_ptr<TreeNode>> SearchEngine::searchByPrefix(const string& prefix, shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
     vector<shared_ptr<TreeNode>> results;
-    vector<string> names = nameIndex.searchByPrefix(prefix);
-    
-    for (const string& name : names) {
-        vector<int> nodeIds = nameIndex.searchExact(name);
-        for (int id : nodeIds) {
-            auto node = fileSystem->findNodeById(id);
-            if (node) {
-                results.push_back(node);
+    Visibility visibility;
+
+    // Una sola pasada por el subárbol del prefijo; los IDs se resuelven
+    // con la tabla de referencias, sin volver a bajar por el Trie
+    vector<int> ids;
+    nameIndex.collectPostings(prefix, ids);
+    results.reserve(ids.size());
+    collectVisible(ids, results, visibility, scope.get());
+
+    return results;
+}
+
+// 5b. Página de la búsqueda por prefijo
+vector<shared_ptr<TreeNode>> SearchEngine::searchByPrefixPage(const string& prefix, size_t limit, Cursor& cursor,
+                                                              size_t offset, shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
+    vector<shared_ptr<TreeNode>> results;
+    Visibility visibility;
+    if (cursor.exhausted) return results;
+
+    // Se reanuda tras la clave del cursor; la página se cierra al encontrar
+    // un resultado más de los que caben. Los IDs de cada nombre se ordenan
+    // por tramos, solo hasta donde llega la página
+    bool pageFull = false;
+    string lastName = cursor.name;
+    int lastId = cursor.lastId;
+    vector<int> pending;
+    nameIndex.forEachWord(prefix, [&](const string& name, const vector<int>& ids) {
+        int after = name == cursor.name ? cursor.lastId : -1;
+        pending.clear();
+        for (int id : ids) {
+            if (id > after) pending.push_back(id);
+        }
+
+        size_t begin = 0;
+        while (begin < pending.size()) {
+            size_t wanted = offset + (limit - results.size()) + 1;
+            size_t end = min(pending.size(), begin + max(wanted, PAGE_SORT_BATCH));
+            partial_sort(pending.begin() + begin, pending.begin() + end, pending.end());
+
+            for (size_t i = begin; i < end; i++) {
+                auto node = resolveVisible(pending[i], visibility, scope.get());
+                if (!node) continue;
+
+                if (results.size() == limit && offset == 0) {
+                    pageFull = true;
+                    return false;
+                }
+                if (offset > 0) {
+                    offset--;
+                } else {
+                    results.push_back(node);
+                }
+                lastName = name;
+                lastId = pending[i];
             }
+            begin = end;
         }
-    }
-    
+        return true;
+    }, cursor.name);
+
+    cursor.name = lastName;
+    cursor.lastId = lastId;
+    cursor.exhausted = !pageFull;
     return results;
 }
 
 // 6. Autocompletado
 vector<string> SearchEngine::autocomplete(const string& prefix, int maxSuggestions) {
-    return nameIndex.autocomplete(prefix, maxSuggestions);
+    lock_guard<mutex> lock(indexMutex);
+    vector<string> suggestions;
+    Visibility visibility;
+    if (maxSuggestions <= 0) return suggestions;
+
+    // Con lápidas, sugerir solo nombres que tengan algún nodo visible;
+    // el recorrido se detiene al llegar al máximo
+    nameIndex.forEachWord(prefix, [&](const string& name, const vector<int>& ids) {
+        bool visible = tombstoneCount == 0;
+        if (!visible) {
+            vector<shared_ptr<TreeNode>> nodes;
+            collectVisible(ids, nodes, visibility);
+            visible = !nodes.empty();
+        }
+        if (visible) {
+            suggestions.push_back(name);
+        }
+        return static_cast<int>(suggestions.size()) < maxSuggestions;
+    });
+    return suggestions;
 }
 
 // 7. Búsqueda avanzada: nombres que contienen un substring
-vector<shared_ptr<TreeNode>> SearchEngine::searchContains(const string& substring) {
+vector<shared_ptr<TreeNode>> SearchEngine::searchContains(const string& substring, bool ignoreCase,
+                                                          shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
     vector<shared_ptr<TreeNode>> results;
-    vector<string> allNames = nameIndex.getAllWords();
-    
-    for (const string& name : allNames) {
-        if (name.find(substring) != string::npos) {
-            vector<int> nodeIds = nameIndex.searchExact(name);
-            for (int id : nodeIds) {
-                auto node = fileSystem->findNodeById(id);
-                if (node) {
-                    results.push_back(node);
-                }
-            }
-        }
-    }
-    
+    Visibility visibility;
+
+    collectVisible(nameBuffer.searchContains(substring, ignoreCase), results, visibility, scope.get());
     return results;
 }
 
 // 8. Estadísticas del índice
 void SearchEngine::printIndexStats() {
+    lock_guard<mutex> lock(indexMutex);
     cout << "=== ESTADÍSTICAS DEL ÍNDICE ===" << endl;
     cout << "Palabras indexadas: " << nameIndex.countWords() << endl;
     cout << "Nodos en el sistema: " << fileSystem->calculateSize() << endl;
-    
+    cout << "Lápidas activas: " << tombstoneCount << endl;
+    cout << "Compactaciones: " << compactions << " (entradas purgadas: " << purgedEntries << ")" << endl;
+    cout << "Nombres empaquetados: " << nameBuffer.entries() << " entradas, "
+         << nameBuffer.byteSize() / 1024 << " KB" << endl;
+    cout << "Contenido: " << contentIndex.documents() << " archivos, " << contentIndex.termCount()
+         << " términos, " << contentIndex.compressedBytes() / 1024 << " KB en listas comprimidas" << endl;
+
     // Mostrar algunas palabras indexadas
     vector<string> sampleWords = nameIndex.getAllWords();
     int sampleSize = min(10, static_cast<int>(sampleWords.size()));
-    
+
     if (sampleSize > 0) {
         cout << "\nMuestra de palabras indexadas (" << sampleSize << " de " << sampleWords.size() << "):" << endl;
         for (int i = 0; i < sampleSize; i++) {
@@ -133,25 +383,309 @@ void SearchEngine::printIndexStats() {
 
 // 9. Verificar integridad del índice
 bool SearchEngine::verifyIndexIntegrity() {
+    lock_guard<mutex> lock(indexMutex);
     // Verificar que todos los nodos del árbol están indexados
     return verifyIntegrityRecursive(fileSystem->getRoot());
 }
 
 bool SearchEngine::verifyIntegrityRecursive(shared_ptr<TreeNode> node) {
     if (!node) return true;
-    
-    // Verificar que el nodo está indexado
-    vector<int> ids = nameIndex.searchExact(node->name);
-    if (find(ids.begin(), ids.end(), node->id) == ids.end()) {
+
+    // Verificar que el nodo está indexado y no oculto por una lápida
+    vector<int> ids = nameIndex.searchExact(node->getName());
+    if (find(ids.begin(), ids.end(), node->id) == ids.end() || isTombstoned(node->id)) {
         return false;
     }
-    
+
     // Verificar hijos recursivamente
-    for (auto& child : node->children) {
+    for (auto& child : node->getChildren()) {
         if (!verifyIntegrityRecursive(child)) {
             return false;
         }
     }
-    
+
     return true;
-}
\ No newline at end of file
+}
+
+// 10. Borrado perezoso: una lápida en la raíz del subárbol
+void SearchEngine::markDeleted(shared_ptr<TreeNode> node) {
+    if (!node) return;
+    lock_guard<mutex> lock(indexMutex);
+    setTombstone(node->id, true);
+}
+
+// 11. Restaurar un subárbol
+void SearchEngine::restoreNode(shared_ptr<TreeNode> node) {
+    if (!node) return;
+    lock_guard<mutex> lock(indexMutex);
+
+    setTombstone(node->id, false);
+
+    // Si el subárbol se reconstruyó (volcado a disco) o ya se compactó,
+    // las referencias antiguas no sirven: indexarlo de nuevo
+    bool sameNode = node->id >= 0 && static_cast<size_t>(node->id) < handles.size() &&
+                    handles[node->id].lock() == node;
+    if (!sameNode) {
+        indexNodeRecursive(node);
+    }
+}
+
+// 12. Cambiar el nombre indexado de un único nodo
+void SearchEngine::renameNode(shared_ptr<TreeNode> node, const string& oldName) {
+    if (!node) return;
+    lock_guard<mutex> lock(indexMutex);
+    nameIndex.remove(oldName, node->id);
+    nameIndex.insert(node->getName(), node->id);
+    suffixIndex.remove(reversedName(oldName), node->id);
+    suffixIndex.insert(reversedName(node->getName()), node->id);
+    nameBuffer.set(node->id, node->getName());
+    registerHandle(node);
+}
+
+// 13. Pedir una compactación en segundo plano
+void SearchEngine::scheduleCompaction() {
+    {
+        lock_guard<mutex> lock(indexMutex);
+        if (!compactor.joinable()) {
+            compactor = thread(&SearchEngine::compactorLoop, this);
+        }
+        compactionPending = true;
+    }
+    compactionRequested.notify_one();
+}
+
+// 14. Búsqueda tolerante a errores
+vector<SearchEngine::FuzzyMatch> SearchEngine::searchFuzzy(const string& name, int maxDistance,
+                                                           shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
+    vector<FuzzyMatch> results;
+    Visibility visibility;
+
+    FuzzyMatcher matcher(name, min(max(maxDistance, 0), 2));
+    nameIndex.walkAutomaton(matcher, [&](const string&, const vector<int>& ids, int distance) {
+        for (int id : ids) {
+            if (auto node = resolveVisible(id, visibility, scope.get())) {
+                results.push_back({node, distance});
+            }
+        }
+    });
+
+    // El recorrido ya va en orden alfabético: basta un orden estable
+    stable_sort(results.begin(), results.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+        return a.distance < b.distance;
+    });
+    return results;
+}
+
+// 15. Búsqueda con comodines
+vector<shared_ptr<TreeNode>> SearchEngine::searchGlob(const string& pattern, shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
+    vector<shared_ptr<TreeNode>> results;
+    Visibility visibility;
+
+    // "*texto*": una sola pasada por el bloque de nombres
+    string literal;
+    if (GlobMatcher::containsLiteral(pattern, literal)) {
+        collectVisible(nameBuffer.searchContains(literal), results, visibility, scope.get());
+        return results;
+    }
+
+    string prefix = GlobMatcher::literalPrefix(pattern);
+    if (!GlobMatcher::hasWildcards(pattern)) {
+        collectVisible(nameIndex.searchExact(prefix), results, visibility, scope.get());
+        return results;
+    }
+
+    string suffix = GlobMatcher::literalSuffix(pattern);
+    if (suffix.size() <= prefix.size()) {
+        // El texto fijo inicial guía el recorrido del índice de nombres
+        GlobMatcher matcher(pattern);
+        nameIndex.walkAutomaton(matcher, [&](const string&, const vector<int>& ids, int) {
+            collectVisible(ids, results, visibility, scope.get());
+        });
+        return results;
+    }
+
+    // Patrones como "*.docx": solo se visita la rama del sufijo invertido
+    GlobMatcher matcher(pattern, true);
+    vector<pair<string, const vector<int>*>> matches;
+    suffixIndex.walkAutomaton(matcher, [&](const string& name, const vector<int>& ids, int) {
+        matches.push_back({reversedName(name), &ids});
+    });
+
+    // Mismo orden que el Trie (por char), como el resto de búsquedas
+    sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+        return lexicographical_compare(a.first.begin(), a.first.end(), b.first.begin(), b.first.end());
+    });
+    for (const auto& match : matches) {
+        collectVisible(*match.second, results, visibility, scope.get());
+    }
+    return results;
+}
+
+// 16. Búsqueda en el contenido
+vector<shared_ptr<TreeNode>> SearchEngine::searchContent(const string& query, shared_ptr<TreeNode> scope) {
+    lock_guard<mutex> lock(indexMutex);
+    vector<shared_ptr<TreeNode>> results;
+    Visibility visibility;
+
+    collectVisible(contentIndex.search(ContentIndex::parseQuery(query)), results, visibility, scope.get());
+    return results;
+}
+
+// 17. Guardar el índice de contenido junto a la instantánea
+bool SearchEngine::saveContentIndex(const string& snapshotFile) {
+    uint64_t fingerprint;
+    if (!fileFingerprint(snapshotFile, fingerprint)) return false;
+
+    ofstream out(contentIndexFile(snapshotFile), ios::binary);
+    if (!out.is_open()) return false;
+
+    lock_guard<mutex> lock(indexMutex);
+    contentIndex.save(out, fingerprint);
+    return static_cast<bool>(out);
+}
+
+// 18. Leer el índice de contenido (o reconstruirlo)
+bool SearchEngine::loadContentIndex(const string& snapshotFile) {
+    uint64_t fingerprint;
+    ifstream in(contentIndexFile(snapshotFile), ios::binary);
+
+    lock_guard<mutex> lock(indexMutex);
+    if (in.is_open() && fileFingerprint(snapshotFile, fingerprint) && contentIndex.load(in, fingerprint)) {
+        return true;
+    }
+
+    // Sin índice válido: tokenizar el contenido de todos los archivos
+    contentIndex.clear();
+    vector<shared_ptr<TreeNode>> pending = {fileSystem->getRoot()};
+    vector<TreeNode*> files;
+    while (!pending.empty()) {
+        auto current = std::move(pending.back());
+        pending.pop_back();
+        if (!current) continue;
+
+        if (current->isFile()) {
+            files.push_back(current.get());
+        }
+        for (auto& child : current->getChildren()) {
+            pending.push_back(child);
+        }
+    }
+    addContents(files);
+    return false;
+}
+
+// Compactador: quita del Trie los IDs cuyos nodos ya se liberaron.
+// Trabaja rama a rama soltando el mutex entre ramas para no bloquear búsquedas.
+void SearchEngine::compactorLoop() {
+    unique_lock<mutex> lock(indexMutex);
+
+    while (true) {
+        compactionRequested.wait(lock, [this]() { return stopping || compactionPending; });
+        if (stopping) break;
+        compactionPending = false;
+        compacting = true;
+
+        // Esperar a que el recolector termine de liberar lo purgado
+        lock.unlock();
+        NodeReclaimer::instance().drain();
+        lock.lock();
+
+        auto isDead = [this](int id) {
+            return id >= 0 && static_cast<size_t>(id) < handles.size() && handles[id].expired();
+        };
+
+        vector<int> purged;
+        for (char c : nameIndex.firstCharacters()) {
+            if (stopping) break;
+            nameIndex.purgeBranch(c, isDead, &purged);
+
+            lock.unlock();
+            this_thread::yield();
+            lock.lock();
+        }
+
+        // El índice de sufijos guarda los mismos IDs (ya contados)
+        for (char c : suffixIndex.firstCharacters()) {
+            if (stopping) break;
+            suffixIndex.purgeBranch(c, isDead);
+
+            lock.unlock();
+            this_thread::yield();
+            lock.lock();
+        }
+
+        // Listas de contenido sin los archivos liberados, unos pocos
+        // términos por tramo
+        size_t purgedDocuments = stopping ? 0 : contentIndex.beginPurge(isDead);
+        if (purgedDocuments > 0) {
+            while (!stopping && !contentIndex.purgeStep(CONTENT_PURGE_TERMS)) {
+                lock.unlock();
+                this_thread::yield();
+                lock.lock();
+            }
+            if (!stopping) purgedEntries += purgedDocuments;
+        }
+
+        // Las lápidas y referencias de nodos liberados ya no hacen falta
+        for (int id : purged) {
+            if (isDead(id)) {
+                nameBuffer.remove(id);
+                handles[id].reset();
+                setTombstone(id, false);
+            }
+        }
+
+        compactions++;
+        purgedEntries += purged.size();
+        compacting = false;
+        compactionFinished.notify_all();
+    }
+}
+
+// 19. Reflejar una transacción
+void SearchEngine::applyBatch(const FileSystemTree::BatchResult& batch) {
+    lock_guard<mutex> lock(indexMutex);
+
+    // Cada nodo nuevo aparece en created: se indexa solo, sin sus hijos
+    vector<TreeNode*> files;
+    for (const auto& node : batch.created) {
+        nameIndex.insert(node->getName(), node->id, true);
+        suffixIndex.insert(reversedName(node->getName()), node->id, true);
+        nameBuffer.set(node->id, node->getName());
+        registerHandle(node);
+        if (node->isFile()) {
+            files.push_back(node.get());
+        }
+    }
+    addContents(files);
+
+    for (const auto& entry : batch.renamed) {
+        const auto& node = entry.first;
+        nameIndex.remove(entry.second, node->id);
+        nameIndex.insert(node->getName(), node->id);
+        suffixIndex.remove(reversedName(entry.second), node->id);
+        suffixIndex.insert(reversedName(node->getName()), node->id);
+        nameBuffer.set(node->id, node->getName());
+    }
+
+    for (const auto& removal : batch.removed) {
+        setTombstone(removal.node->id, true);
+    }
+}
+
+// 20. Indexar subárboles nuevos
+void SearchEngine::indexNewNodes(const vector<shared_ptr<TreeNode>>& roots) {
+    lock_guard<mutex> lock(indexMutex);
+    for (const auto& root : roots) {
+        indexNodeRecursive(root, true, true);
+    }
+}
+
+// 21. Esperar a la compactación
+void SearchEngine::drainCompaction() {
+    unique_lock<mutex> lock(indexMutex);
+    if (!compactor.joinable()) return;
+    compactionFinished.wait(lock, [this]() { return stopping || (!compactionPending && !compacting); });
+}
@@ -3,9 +3,16 @@
 
 #include "FileSystemTree.hpp"
 #include "Trie.hpp"
+#include "ContentIndex.hpp"
+#include "NameBuffer.hpp"
 #include <memory>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
@@ -13,45 +20,169 @@ class SearchEngine {
 private:
     shared_ptr<FileSystemTree> fileSystem;
     Trie nameIndex;
-    
-    // Helper para indexar recursivamente
-    void indexNodeRecursive(shared_ptr<TreeNode> node);
-    
-    // Helper para desindexar recursivamente
+
+    // Índice de sufijos: los mismos nombres escritos al revés ("*.docx")
+    Trie suffixIndex;
+
+    // Índice invertido del contenido de los archivos
+    ContentIndex contentIndex;
+
+    // Todos los nombres en un bloque contiguo para buscar subcadenas
+    NameBuffer nameBuffer;
+
+    // Referencia directa id -> nodo (los ids son densos)
+    vector<weak_ptr<TreeNode>> handles;
+
+    // Lápidas: raíces de subárboles eliminados, ocultas sin tocar el Trie
+    vector<uint64_t> tombstones;
+    long long tombstoneCount;
+
+    // Compactación en segundo plano (se arranca al primer uso)
+    mutable mutex indexMutex;
+    condition_variable compactionRequested;
+    thread compactor;
+    condition_variable compactionFinished;
+    bool compactionPending;
+    bool compacting;
+    bool stopping;
+    long long compactions;
+    long long purgedEntries;
+
+    // Helper para indexar recursivamente (newIds: ningún nodo del subárbol
+    // está ya en el índice)
+    void indexNodeRecursive(shared_ptr<TreeNode> node, bool withContent = true, bool newIds = false);
+    void addContents(vector<TreeNode*>& files);
+
+    // Helper para desindexar un subárbol (iterativo)
     void removeIndexRecursive(shared_ptr<TreeNode> node);
-    
+
     // Helper para verificar integridad recursivamente
     bool verifyIntegrityRecursive(shared_ptr<TreeNode> node);
 
+    // Helpers de lápidas y referencias (con indexMutex tomado)
+    void registerHandle(const shared_ptr<TreeNode>& node);
+    bool isTombstoned(int id) const;
+    void setTombstone(int id, bool value);
+
+    // Estado de visibilidad de una consulta: las raíces con lápida que
+    // sigan conectadas al árbol (normalmente ninguna: rm las desconecta)
+    // se buscan una sola vez, al resolver el primer resultado
+    struct Visibility {
+        bool ready = false;
+        vector<shared_ptr<TreeNode>> attachedTombstones;
+    };
+    bool isVisible(const shared_ptr<TreeNode>& node, Visibility& visibility) const;
+    shared_ptr<TreeNode> resolveVisible(int id, Visibility& visibility, const TreeNode* scope) const;
+    void collectVisible(const vector<int>& nodeIds, vector<shared_ptr<TreeNode>>& results,
+                        Visibility& visibility, const TreeNode* scope = nullptr) const;
+
+    // Bucle del compactador
+    void compactorLoop();
+
 public:
-    SearchEngine(shared_ptr<FileSystemTree> fs);
-    
+    // Posición para reanudar una búsqueda paginada: la clave (nombre, ID)
+    // del último resultado consumido. No depende de posiciones dentro de
+    // las listas de IDs, que cambian al purgarlas el compactador
+    struct Cursor {
+        string name;      // Nombre del último resultado ("" = desde el principio)
+        int lastId;       // Su ID; en cada nombre los IDs se recorren de menor a mayor
+        bool exhausted;   // No quedan más resultados
+        
+        Cursor() : lastId(-1), exhausted(false) {}
+    };
+
+    // Resultado de la búsqueda aproximada
+    struct FuzzyMatch {
+        shared_ptr<TreeNode> node;
+        int distance;  // Ediciones respecto a la consulta
+    };
+
+    // Sin indexContents el contenido se indexa después (loadContentIndex)
+    SearchEngine(shared_ptr<FileSystemTree> fs, bool indexContents = true);
+    ~SearchEngine();
+
     // 1. Reconstruir índice completo
-    void rebuildIndex();
-    
+    void rebuildIndex(bool includeContents = true);
+
     // 2. Indexar un nodo específico (y sus hijos)
     void indexNode(shared_ptr<TreeNode> node);
-    
+
     // 3. Remover nodo del índice
     void removeNodeFromIndex(shared_ptr<TreeNode> node);
-    
+
     // 4. Búsqueda exacta por nombre
     vector<shared_ptr<TreeNode>> searchExact(const string& name);
-    
-    // 5. Búsqueda por prefijo
-    vector<shared_ptr<TreeNode>> searchByPrefix(const string& prefix);
-    
+
+    // 5. Búsqueda por prefijo (scope limita los resultados a ese subárbol)
+    vector<shared_ptr<TreeNode>> searchByPrefix(const string& prefix, shared_ptr<TreeNode> scope = nullptr);
+
+    // 5b. Página de la búsqueda por prefijo: salta offset resultados desde el
+    //     cursor, devuelve como mucho limit y deja el cursor tras ellos.
+    //     El recorrido del Trie se detiene en cuanto la página está completa.
+    vector<shared_ptr<TreeNode>> searchByPrefixPage(const string& prefix, size_t limit, Cursor& cursor,
+                                                    size_t offset = 0, shared_ptr<TreeNode> scope = nullptr);
+
     // 6. Autocompletado
     vector<string> autocomplete(const string& prefix, int maxSuggestions = 5);
-    
-    // 7. Búsqueda avanzada: nombres que contienen un substring
-    vector<shared_ptr<TreeNode>> searchContains(const string& substring);
-    
+
+    // 7. Búsqueda avanzada: nombres que contienen un substring (recorrido
+    //    SIMD del bloque de nombres; ignoreCase iguala mayúsculas ASCII)
+    vector<shared_ptr<TreeNode>> searchContains(const string& substring, bool ignoreCase = false,
+                                                shared_ptr<TreeNode> scope = nullptr);
+
     // 8. Estadísticas del índice
     void printIndexStats();
-    
+
     // 9. Verificar integridad del índice
     bool verifyIndexIntegrity();
+
+    // 10. Borrado perezoso: ocultar un subárbol eliminado en O(1)
+    void markDeleted(shared_ptr<TreeNode> node);
+
+    // 11. Restaurar un subárbol: quitar la lápida (o reindexarlo si sus
+    //     nodos se reconstruyeron, por ejemplo al leerlos de disco)
+    void restoreNode(shared_ptr<TreeNode> node);
+
+    // 12. Cambiar el nombre indexado de un único nodo
+    void renameNode(shared_ptr<TreeNode> node, const string& oldName);
+
+    // 13. Purgar en segundo plano las entradas de nodos ya liberados
+    void scheduleCompaction();
+
+    // 14. Búsqueda tolerante a errores: nombres a distancia de edición
+    //     <= maxDistance (1 o 2), ordenados por distancia y luego por nombre.
+    //     El autómata recorre el Trie y poda las ramas imposibles.
+    vector<FuzzyMatch> searchFuzzy(const string& name, int maxDistance = 2,
+                                   shared_ptr<TreeNode> scope = nullptr);
+
+    // 15. Búsqueda con comodines ('*', '?'), ordenada por nombre. Se recorre
+    //     el índice de nombres o el de sufijos según qué extremo del patrón
+    //     tenga más texto fijo, podando las ramas que no pueden coincidir.
+    vector<shared_ptr<TreeNode>> searchGlob(const string& pattern, shared_ptr<TreeNode> scope = nullptr);
+
+    // 16. Búsqueda en el contenido de los archivos: palabras (AND),
+    //     "frases exactas" y OR. Resultados en orden de ID.
+    vector<shared_ptr<TreeNode>> searchContent(const string& query, shared_ptr<TreeNode> scope = nullptr);
+
+    // 17. Guardar el índice de contenido junto a una instantánea JSON
+    //     (<archivo>.cidx, ligado al contenido exacto de la instantánea)
+    bool saveContentIndex(const string& snapshotFile);
+
+    // 18. Leer el índice de contenido de una instantánea; si falta o no
+    //     corresponde, se reconstruye desde el árbol. true si se leyó.
+    bool loadContentIndex(const string& snapshotFile);
+
+    // 19. Reflejar una transacción ya aplicada con un solo bloqueo: indexar
+    //     los nodos nuevos, cambiar los nombres y poner las lápidas
+    void applyBatch(const FileSystemTree::BatchResult& batch);
+
+    // 20. Indexar con un solo bloqueo subárboles recién creados (ninguno de
+    //     sus IDs puede estar ya en el índice), p. ej. tras PathImporter
+    void indexNewNodes(const vector<shared_ptr<TreeNode>>& roots);
+
+    // 21. Esperar a que termine la compactación pedida (pruebas), como
+    //     NodeReclaimer::drain
+    void drainCompaction();
 };
 
-#endif // SEARCHENGINE_HPP
\ No newline at end of file
+#endif // SEARCHENGINE_HPP
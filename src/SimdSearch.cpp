@@ -0,0 +1,312 @@
+#include "SimdSearch.hpp"
+#include <cstring>
+#include <cstdint>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SIMDSEARCH_X86 1
+#endif
+
+using namespace std;
+
+namespace {
+    const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    inline bool isAsciiLetter(unsigned char c) {
+        return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+    }
+
+    // Bit que se activa para comparar sin distinguir mayúsculas: solo en
+    // letras ASCII ('A' | 0x20 == 'a'); el resto de bytes se compara tal cual
+    inline unsigned char caseFold(unsigned char c, bool ignoreCase) {
+        return ignoreCase && isAsciiLetter(c) ? 0x20 : 0;
+    }
+
+    // Comparar los bytes intermedios del patrón en pos
+    inline bool middleMatches(const char* text, size_t pos, const string& pattern, bool ignoreCase) {
+        size_t m = pattern.size();
+        if (m <= 2) return true;
+        if (!ignoreCase) {
+            return memcmp(text + pos + 1, pattern.data() + 1, m - 2) == 0;
+        }
+        for (size_t k = 1; k + 1 < m; k++) {
+            unsigned char c = static_cast<unsigned char>(text[pos + k]);
+            if (static_cast<char>(c | caseFold(c, true)) != pattern[k]) return false;
+        }
+        return true;
+    }
+
+    // Las rutinas de búsqueda devuelven la primera aparición; con count
+    // siguen hasta el final y suman todas las apariciones (solapadas incluidas)
+
+    // Posiciones desde from, byte a byte
+    size_t findTail(const char* text, size_t n, size_t from, const string& pattern, bool ignoreCase,
+                    size_t* count) {
+        size_t m = pattern.size(), found = NOT_FOUND;
+        if (n < m) return found;
+        unsigned char first = pattern[0], last = pattern[m - 1];
+        unsigned char foldFirst = caseFold(first, ignoreCase), foldLast = caseFold(last, ignoreCase);
+        for (size_t i = from; i + m <= n; i++) {
+            if ((static_cast<unsigned char>(text[i]) | foldFirst) == first &&
+                (static_cast<unsigned char>(text[i + m - 1]) | foldLast) == last &&
+                middleMatches(text, i, pattern, ignoreCase)) {
+                if (!count) return i;
+                if (found == NOT_FOUND) found = i;
+                (*count)++;
+            }
+        }
+        return found;
+    }
+
+    size_t findAnyByteScalar(const char* text, size_t n, size_t from, const string& bytes) {
+        if (bytes.size() == 1) {
+            const void* hit = memchr(text + from, bytes[0], n - from);
+            return hit ? static_cast<const char*>(hit) - text : n;
+        }
+        for (size_t i = from; i < n; i++) {
+            if (bytes.find(text[i]) != string::npos) return i;
+        }
+        return n;
+    }
+
+    size_t findAnyPairScalar(const char* text, size_t n, size_t from, const string& pairs) {
+        for (size_t i = from; i + 1 < n; i++) {
+            for (size_t k = 0; k < pairs.size(); k += 2) {
+                if (text[i] == pairs[k] && text[i + 1] == pairs[k + 1]) return i;
+            }
+        }
+        return n;
+    }
+
+#ifdef SIMDSEARCH_X86
+    // Posiciones de la máscara donde coincide el patrón completo
+    // (fuera de línea: así el bucle vectorial conserva sus registros)
+    __attribute__((noinline))
+    size_t verifyMask(const char* text, size_t base, uint64_t mask, const string& pattern, bool ignoreCase,
+                      size_t* count) {
+        size_t found = NOT_FOUND;
+        while (mask) {
+            size_t pos = base + __builtin_ctzll(mask);
+            if (middleMatches(text, pos, pattern, ignoreCase)) {
+                if (!count) return pos;
+                if (found == NOT_FOUND) found = pos;
+                (*count)++;
+            }
+            mask &= mask - 1;
+        }
+        return found;
+    }
+
+    size_t findSse2(const char* text, size_t n, size_t from, const string& pattern, bool ignoreCase,
+                    size_t* count) {
+        size_t m = pattern.size(), i = from, found = NOT_FOUND;
+        if (n < m) return found;
+        const __m128i first = _mm_set1_epi8(pattern[0]);
+        const __m128i last = _mm_set1_epi8(pattern[m - 1]);
+        const __m128i foldFirst = _mm_set1_epi8(static_cast<char>(caseFold(pattern[0], ignoreCase)));
+        const __m128i foldLast = _mm_set1_epi8(static_cast<char>(caseFold(pattern[m - 1], ignoreCase)));
+        const char* tail = text + m - 1;
+        size_t positions = n - m + 1;
+        for (; i + 32 <= positions; i += 32) {
+            __m128i low = _mm_and_si128(
+                _mm_cmpeq_epi8(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), foldFirst), first),
+                _mm_cmpeq_epi8(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail + i)), foldLast), last));
+            __m128i high = _mm_and_si128(
+                _mm_cmpeq_epi8(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 16)), foldFirst), first),
+                _mm_cmpeq_epi8(_mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail + i + 16)), foldLast), last));
+            if (_mm_movemask_epi8(_mm_or_si128(low, high))) {
+                uint64_t mask = static_cast<uint32_t>(_mm_movemask_epi8(low)) |
+                                static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(high))) << 16;
+                size_t pos = verifyMask(text, i, mask, pattern, ignoreCase, count);
+                if (pos != NOT_FOUND) {
+                    if (!count) return pos;
+                    if (found == NOT_FOUND) found = pos;
+                }
+            }
+        }
+        size_t pos = findTail(text, n, i, pattern, ignoreCase, count);
+        return found != NOT_FOUND ? found : pos;
+    }
+
+    __attribute__((target("avx2")))
+    size_t findAvx2(const char* text, size_t n, size_t from, const string& pattern, bool ignoreCase,
+                    size_t* count) {
+        size_t m = pattern.size(), i = from, found = NOT_FOUND;
+        if (n < m) return found;
+        const __m256i first = _mm256_set1_epi8(pattern[0]);
+        const __m256i last = _mm256_set1_epi8(pattern[m - 1]);
+        const __m256i foldFirst = _mm256_set1_epi8(static_cast<char>(caseFold(pattern[0], ignoreCase)));
+        const __m256i foldLast = _mm256_set1_epi8(static_cast<char>(caseFold(pattern[m - 1], ignoreCase)));
+        const char* tail = text + m - 1;
+        size_t positions = n - m + 1;
+        for (; i + 64 <= positions; i += 64) {
+            __m256i low = _mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)), foldFirst), first),
+                _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail + i)), foldLast), last));
+            __m256i high = _mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 32)), foldFirst), first),
+                _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail + i + 32)), foldLast), last));
+            __m256i any = _mm256_or_si256(low, high);
+            if (!_mm256_testz_si256(any, any)) {
+                uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(low)) |
+                                static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32;
+                size_t pos = verifyMask(text, i, mask, pattern, ignoreCase, count);
+                if (pos != NOT_FOUND) {
+                    if (!count) return pos;
+                    if (found == NOT_FOUND) found = pos;
+                }
+            }
+        }
+        size_t pos = findTail(text, n, i, pattern, ignoreCase, count);
+        return found != NOT_FOUND ? found : pos;
+    }
+
+    size_t findAnyByteSse2(const char* text, size_t n, size_t from, const string& bytes) {
+        __m128i needles[SimdSearch::MAX_BYTES];
+        for (size_t k = 0; k < bytes.size(); k++) needles[k] = _mm_set1_epi8(bytes[k]);
+        size_t i = from;
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+            for (size_t k = 1; k < bytes.size(); k++) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[k]));
+            }
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        return findAnyByteScalar(text, n, i, bytes);
+    }
+
+    __attribute__((target("avx2")))
+    size_t findAnyByteAvx2(const char* text, size_t n, size_t from, const string& bytes) {
+        __m256i needles[SimdSearch::MAX_BYTES];
+        for (size_t k = 0; k < bytes.size(); k++) needles[k] = _mm256_set1_epi8(bytes[k]);
+        size_t i = from;
+        for (; i + 32 <= n; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i hits = _mm256_cmpeq_epi8(block, needles[0]);
+            for (size_t k = 1; k < bytes.size(); k++) {
+                hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, needles[k]));
+            }
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        return findAnyByteScalar(text, n, i, bytes);
+    }
+
+    size_t findAnyPairSse2(const char* text, size_t n, size_t from, const string& pairs) {
+        __m128i firsts[SimdSearch::MAX_PAIRS], seconds[SimdSearch::MAX_PAIRS];
+        size_t count = pairs.size() / 2;
+        for (size_t k = 0; k < count; k++) {
+            firsts[k] = _mm_set1_epi8(pairs[2 * k]);
+            seconds[k] = _mm_set1_epi8(pairs[2 * k + 1]);
+        }
+        size_t i = from;
+        for (; i + 17 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 1));
+            __m128i hits = _mm_setzero_si128();
+            for (size_t k = 0; k < count; k++) {
+                hits = _mm_or_si128(hits, _mm_and_si128(_mm_cmpeq_epi8(block, firsts[k]),
+                                                        _mm_cmpeq_epi8(next, seconds[k])));
+            }
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        return findAnyPairScalar(text, n, i, pairs);
+    }
+
+    __attribute__((target("avx2")))
+    size_t findAnyPairAvx2(const char* text, size_t n, size_t from, const string& pairs) {
+        __m256i firsts[SimdSearch::MAX_PAIRS], seconds[SimdSearch::MAX_PAIRS];
+        size_t count = pairs.size() / 2;
+        for (size_t k = 0; k < count; k++) {
+            firsts[k] = _mm256_set1_epi8(pairs[2 * k]);
+            seconds[k] = _mm256_set1_epi8(pairs[2 * k + 1]);
+        }
+        size_t i = from;
+        for (; i + 33 <= n; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 1));
+            __m256i hits = _mm256_setzero_si256();
+            for (size_t k = 0; k < count; k++) {
+                hits = _mm256_or_si256(hits, _mm256_and_si256(_mm256_cmpeq_epi8(block, firsts[k]),
+                                                              _mm256_cmpeq_epi8(next, seconds[k])));
+            }
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        return findAnyPairScalar(text, n, i, pairs);
+    }
+#endif
+
+    // Selección de las rutinas según la CPU (una sola vez)
+    struct Kernels {
+        size_t (*find)(const char*, size_t, size_t, const string&, bool, size_t*);
+        size_t (*findAnyByte)(const char*, size_t, size_t, const string&);
+        size_t (*findAnyPair)(const char*, size_t, size_t, const string&);
+        const char* name;
+    };
+
+    Kernels selectKernels() {
+#ifdef SIMDSEARCH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {findAvx2, findAnyByteAvx2, findAnyPairAvx2, "AVX2"};
+        }
+        return {findSse2, findAnyByteSse2, findAnyPairSse2, "SSE2"};
+#else
+        return {findTail, findAnyByteScalar, findAnyPairScalar, "escalar"};
+#endif
+    }
+
+    const Kernels& kernels() {
+        static const Kernels selected = selectKernels();
+        return selected;
+    }
+}
+
+// 1. Primera aparición de un patrón
+size_t SimdSearch::find(const char* text, size_t n, size_t from, const string& pattern, bool ignoreCase) {
+    if (pattern.empty()) return from < n ? from : n;
+    if (from >= n) return n;
+    size_t pos = kernels().find(text, n, from, pattern, ignoreCase, nullptr);
+    return pos == NOT_FOUND ? n : pos;
+}
+
+// 2. Contar todas las apariciones
+size_t SimdSearch::count(const char* text, size_t n, const string& pattern, size_t& firstOffset,
+                         bool ignoreCase) {
+    size_t total = 0;
+    if (pattern.empty()) return 0;
+    size_t pos = kernels().find(text, n, 0, pattern, ignoreCase, &total);
+    if (total > 0) firstOffset = pos;
+    return total;
+}
+
+// 3. Siguiente byte de un conjunto
+size_t SimdSearch::findAnyByte(const char* text, size_t n, size_t from, const string& bytes) {
+    if (from >= n || bytes.empty()) return n;
+    if (bytes.size() > MAX_BYTES) return findAnyByteScalar(text, n, from, bytes);
+    return kernels().findAnyByte(text, n, from, bytes);
+}
+
+// 4. Siguiente comienzo de un par de bytes
+size_t SimdSearch::findAnyPair(const char* text, size_t n, size_t from, const string& pairs) {
+    if (from >= n || pairs.size() < 2) return n;
+    if (pairs.size() / 2 > MAX_PAIRS) return findAnyPairScalar(text, n, from, pairs);
+    return kernels().findAnyPair(text, n, from, pairs);
+}
+
+// 5. Utilidades
+string SimdSearch::toLowerAscii(const string& text) {
+    string lowered = text;
+    for (char& c : lowered) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c | 0x20);
+    }
+    return lowered;
+}
+
+const char* SimdSearch::instructionSet() {
+    return kernels().name;
+}
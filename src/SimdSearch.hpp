@@ -0,0 +1,42 @@
+#ifndef SIMDSEARCH_HPP
+#define SIMDSEARCH_HPP
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// Búsqueda de bytes y subcadenas con instrucciones SIMD, compartida por el
+// escaneo de contenido y el de nombres. Las posiciones candidatas se filtran
+// comparando a la vez su primer y su último byte (AVX2, o SSE2 si la CPU no
+// lo tiene; la variante se elige una sola vez al primer uso) y solo donde
+// coinciden los dos se compara el resto del patrón.
+class SimdSearch {
+public:
+    static const size_t MAX_BYTES = 4;   // Bytes distintos en findAnyByte
+    static const size_t MAX_PAIRS = 8;   // Pares distintos en findAnyPair
+
+    // 1. Primera aparición de pattern en text[from, n), o n si no hay.
+    //    Con ignoreCase se igualan mayúsculas y minúsculas ASCII; el patrón
+    //    debe venir en minúsculas (toLowerAscii)
+    static size_t find(const char* text, size_t n, size_t from, const string& pattern,
+                       bool ignoreCase = false);
+
+    // 2. Número de apariciones (solapadas incluidas) y posición de la primera
+    static size_t count(const char* text, size_t n, const string& pattern, size_t& firstOffset,
+                        bool ignoreCase = false);
+
+    // 3. Siguiente posición desde from con alguno de los bytes dados (con
+    //    más de MAX_BYTES, o de MAX_PAIRS en findAnyPair, se recorre byte a byte)
+    static size_t findAnyByte(const char* text, size_t n, size_t from, const string& bytes);
+
+    // 4. Siguiente posición donde empieza alguno de los pares de bytes
+    //    (pairs los guarda seguidos: "ab" "cd" ...)
+    static size_t findAnyPair(const char* text, size_t n, size_t from, const string& pairs);
+
+    // 5. Utilidades
+    static string toLowerAscii(const string& text);
+    static const char* instructionSet();  // "AVX2", "SSE2" o "escalar"
+};
+
+#endif // SIMDSEARCH_HPP
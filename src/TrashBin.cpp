@@ -0,0 +1,677 @@
+#include "TrashBin.hpp"
+#include "NodeReclaimer.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace std;
+using namespace chrono;
+
+namespace {
+
+const char SPILL_MAGIC[] = {'P', 'A', 'P', '2'};
+
+void writeVarint(ostream& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+bool readVarint(istream& in, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void writeString(ostream& out, const string& text) {
+    writeVarint(out, text.size());
+    out.write(text.data(), text.size());
+}
+
+bool readString(istream& in, string& text) {
+    unsigned long long length;
+    if (!readVarint(in, length)) return false;
+    text.resize(length);
+    return length == 0 || static_cast<bool>(in.read(&text[0], length));
+}
+
+}  // namespace
+
+TrashBin::TrashBin()
+    : maxItems(1000), maxResidentBytes(256LL << 20), spillThreshold(0),
+      ttl(0), residentBytes(0),
+      addedItems(0), restoredItems(0), purgedItems(0), expiredItems(0),
+      evictedItems(0), spilledItems(0), spilledBytes(0),
+      stopping(false), workPending(false) {
+    purger = thread(&TrashBin::purgerLoop, this);
+}
+
+TrashBin::~TrashBin() {
+    {
+        lock_guard<mutex> lock(trashMutex);
+        stopping = true;
+        for (auto& entry : entries) {
+            entry.second.abort->store(true);
+        }
+    }
+    workAvailable.notify_all();
+    if (purger.joinable()) {
+        purger.join();
+    }
+
+    // Lo que quede en la papelera se pierde al salir
+    vector<shared_ptr<TreeNode>> released;
+    vector<string> files;
+    while (!entries.empty()) {
+        unlinkEntry(entries.begin(), released, files);
+    }
+    discard(released, files);
+
+    if (!spillDirectory.empty()) {
+        error_code ignored;
+        filesystem::remove(spillDirectory, ignored);
+    }
+}
+
+// Helper: mover un elemento al frente del LRU
+void TrashBin::touch(Entry& entry) {
+    lru.splice(lru.begin(), lru, entry.lruPosition);
+}
+
+// Helper: quitar un elemento de todos los índices
+void TrashBin::unlinkEntry(map<int, Entry>::iterator it, vector<shared_ptr<TreeNode>>& released,
+                           vector<string>& files) {
+    Entry& entry = it->second;
+
+    auto named = byName.find(entry.name);
+    if (named != byName.end()) {
+        auto& ids = named->second;
+        ids.erase(remove(ids.begin(), ids.end(), entry.id), ids.end());
+        if (ids.empty()) byName.erase(named);
+    }
+    lru.erase(entry.lruPosition);
+
+    if (entry.node) {
+        if (entry.measured) residentBytes -= entry.bytes;
+        released.push_back(std::move(entry.node));
+    }
+    if (!entry.spillFile.empty()) {
+        files.push_back(entry.spillFile);
+    }
+    entries.erase(it);
+}
+
+// Helper: expulsar los elementos menos usados por encima del límite de elementos
+size_t TrashBin::evictOverItemQuota(vector<shared_ptr<TreeNode>>& released, vector<string>& files) {
+    size_t evicted = 0;
+    auto position = lru.end();
+    while (entries.size() > maxItems && position != lru.begin()) {
+        --position;
+        auto it = entries.find(*position);
+        if (it->second.busy) continue;
+
+        position = next(position);
+        unlinkEntry(it, released, files);
+        evictedItems++;
+        purgedItems++;
+        evicted++;
+    }
+    return evicted;
+}
+
+// Helper: liberar nodos y borrar volcados fuera del mutex
+void TrashBin::discard(vector<shared_ptr<TreeNode>>& released, vector<string>& files) {
+    for (auto& node : released) {
+        NodeReclaimer::instance().retire(std::move(node));
+    }
+    released.clear();
+
+    for (const auto& file : files) {
+        error_code ignored;
+        filesystem::remove(file, ignored);
+    }
+    files.clear();
+}
+
+// Helper: archivo de volcado para un elemento (directorio temporal por proceso)
+string TrashBin::nextSpillPath(int id) {
+    if (spillDirectory.empty()) {
+        error_code ignored;
+        auto directory = filesystem::temp_directory_path(ignored) /
+                         ("arboles_papelera_" + to_string(getpid()));
+        filesystem::create_directories(directory, ignored);
+        spillDirectory = directory.string();
+    }
+    return spillDirectory + "/" + to_string(id) + ".bin";
+}
+
+// 1. Enviar un subárbol a la papelera
+void TrashBin::add(shared_ptr<TreeNode> node, shared_ptr<TreeNode> parent, const string& originalPath) {
+    if (!node) return;
+
+    vector<shared_ptr<TreeNode>> released;
+    vector<string> files;
+    size_t evicted;
+    PurgeListener listener;
+    {
+        lock_guard<mutex> lock(trashMutex);
+
+        auto existing = entries.find(node->id);
+        if (existing != entries.end() && !existing->second.busy) {
+            unlinkEntry(existing, released, files);
+        }
+
+        Entry entry;
+        entry.id = node->id;
+        entry.name = node->getName();
+        entry.originalPath = originalPath;
+        entry.folder = node->isFolder();
+        entry.parent = parent;
+        entry.node = std::move(node);
+        entry.nodeCount = 0;
+        entry.bytes = 0;
+        entry.measured = false;
+        entry.busy = false;
+        entry.spillFailed = false;
+        entry.abort = make_shared<atomic<bool>>(false);
+        entry.deletedAt = steady_clock::now();
+
+        lru.push_front(entry.id);
+        entry.lruPosition = lru.begin();
+        byName[entry.name].push_back(entry.id);
+        entries.emplace(entry.id, std::move(entry));
+        addedItems++;
+
+        evicted = evictOverItemQuota(released, files);
+        listener = purgeListener;
+        workPending = true;
+    }
+    workAvailable.notify_one();
+
+    discard(released, files);
+    if (evicted > 0 && listener) {
+        listener(evicted);
+    }
+}
+
+// 2. Buscar por nombre (el más reciente) o por "#id"
+bool TrashBin::lookup(const string& key, ItemInfo& info, shared_ptr<TreeNode>& parent) {
+    lock_guard<mutex> lock(trashMutex);
+
+    map<int, Entry>::iterator it = entries.end();
+    if (key.size() > 1 && key[0] == '#') {
+        try {
+            it = entries.find(stoi(key.substr(1)));
+        } catch (const exception&) {
+            return false;
+        }
+    } else {
+        auto named = byName.find(key);
+        if (named != byName.end()) {
+            it = entries.find(named->second.back());
+        }
+    }
+    if (it == entries.end()) {
+        return false;
+    }
+
+    Entry& entry = it->second;
+    touch(entry);
+
+    info.id = entry.id;
+    info.name = entry.name;
+    info.originalPath = entry.originalPath;
+    info.folder = entry.folder;
+    info.spilled = !entry.node;
+    info.nodeCount = entry.nodeCount;
+    info.bytes = entry.bytes;
+    info.ageSeconds = duration_cast<seconds>(steady_clock::now() - entry.deletedAt).count();
+    parent = entry.parent.lock();
+    return true;
+}
+
+// 3. Sacar un elemento de la papelera
+shared_ptr<TreeNode> TrashBin::take(int id) {
+    shared_ptr<TreeNode> node;
+    string file;
+    {
+        unique_lock<mutex> lock(trashMutex);
+
+        // Si el hilo de fondo lo está midiendo o volcando, se le pide abandonar
+        map<int, Entry>::iterator it;
+        while (true) {
+            it = entries.find(id);
+            if (it == entries.end()) return nullptr;
+            if (!it->second.busy) break;
+            it->second.abort->store(true);
+            entryReleased.wait(lock);
+        }
+
+        Entry& entry = it->second;
+        if (entry.node && entry.measured) {
+            residentBytes -= entry.bytes;
+        }
+        node = std::move(entry.node);
+        file = entry.spillFile;
+        entry.spillFile.clear();
+
+        vector<shared_ptr<TreeNode>> released;
+        vector<string> files;
+        unlinkEntry(it, released, files);
+        restoredItems++;
+    }
+
+    if (!node && !file.empty()) {
+        node = readSubtree(file);
+        error_code ignored;
+        filesystem::remove(file, ignored);
+        if (!node) {
+            throw runtime_error("No se pudo leer el elemento volcado a disco: " + file);
+        }
+    }
+    return node;
+}
+
+// 4. Listado en orden de borrado
+vector<TrashBin::ItemInfo> TrashBin::items() const {
+    lock_guard<mutex> lock(trashMutex);
+
+    vector<pair<steady_clock::time_point, ItemInfo>> ordered;
+    auto now = steady_clock::now();
+    for (const auto& pair : entries) {
+        const Entry& entry = pair.second;
+        ItemInfo info;
+        info.id = entry.id;
+        info.name = entry.name;
+        info.originalPath = entry.originalPath;
+        info.folder = entry.folder;
+        info.spilled = !entry.node;
+        info.nodeCount = entry.nodeCount;
+        info.bytes = entry.bytes;
+        info.ageSeconds = duration_cast<seconds>(now - entry.deletedAt).count();
+        ordered.push_back({entry.deletedAt, info});
+    }
+    stable_sort(ordered.begin(), ordered.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    vector<ItemInfo> result;
+    for (auto& pair : ordered) {
+        result.push_back(std::move(pair.second));
+    }
+    return result;
+}
+
+vector<shared_ptr<TreeNode>> TrashBin::residentRoots() const {
+    lock_guard<mutex> lock(trashMutex);
+
+    vector<shared_ptr<TreeNode>> roots;
+    for (const auto& pair : entries) {
+        if (pair.second.node) roots.push_back(pair.second.node);
+    }
+    return roots;
+}
+
+size_t TrashBin::size() const {
+    lock_guard<mutex> lock(trashMutex);
+    return entries.size();
+}
+
+bool TrashBin::empty() const {
+    return size() == 0;
+}
+
+// 5. Vaciar la papelera
+void TrashBin::clear() {
+    vector<shared_ptr<TreeNode>> released;
+    vector<string> files;
+    size_t purged;
+    PurgeListener listener;
+    {
+        unique_lock<mutex> lock(trashMutex);
+        for (auto& entry : entries) {
+            entry.second.abort->store(true);
+        }
+        entryReleased.wait(lock, [this]() {
+            for (const auto& entry : entries) {
+                if (entry.second.busy) return false;
+            }
+            return true;
+        });
+
+        purged = entries.size();
+        while (!entries.empty()) {
+            unlinkEntry(entries.begin(), released, files);
+        }
+        purgedItems += purged;
+        listener = purgeListener;
+    }
+
+    discard(released, files);
+    if (purged > 0 && listener) {
+        listener(purged);
+    }
+}
+
+// 6. Configuración
+void TrashBin::setTtl(long long secondsToLive) {
+    {
+        lock_guard<mutex> lock(trashMutex);
+        ttl = seconds(max(0LL, secondsToLive));
+        workPending = true;
+    }
+    workAvailable.notify_one();
+}
+
+void TrashBin::setQuota(size_t items, long long bytes) {
+    {
+        lock_guard<mutex> lock(trashMutex);
+        maxItems = items;
+        maxResidentBytes = bytes;
+        workPending = true;
+    }
+    workAvailable.notify_one();
+}
+
+void TrashBin::setSpillThreshold(long long nodes) {
+    {
+        lock_guard<mutex> lock(trashMutex);
+        spillThreshold = max(0LL, nodes);
+        workPending = true;
+    }
+    workAvailable.notify_one();
+}
+
+void TrashBin::setPurgeListener(PurgeListener listener) {
+    lock_guard<mutex> lock(trashMutex);
+    purgeListener = std::move(listener);
+}
+
+// Bucle del hilo de fondo: revisa caducidad y cuotas cada segundo o al recibir trabajo
+void TrashBin::purgerLoop() {
+    unique_lock<mutex> lock(trashMutex);
+    while (!stopping) {
+        workAvailable.wait_for(lock, seconds(1), [this]() { return stopping || workPending; });
+        if (stopping) break;
+        workPending = false;
+
+        while (!stopping && maintenanceStep(lock)) {
+        }
+    }
+}
+
+// Un paso de mantenimiento; devuelve true si hizo algo
+bool TrashBin::maintenanceStep(unique_lock<mutex>& lock) {
+    vector<shared_ptr<TreeNode>> released;
+    vector<string> files;
+    size_t purged = 0;
+
+    // 1. Caducidad por TTL
+    if (ttl.count() > 0) {
+        auto now = steady_clock::now();
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto current = it++;
+            if (!current->second.busy && now - current->second.deletedAt >= ttl) {
+                unlinkEntry(current, released, files);
+                expiredItems++;
+                purgedItems++;
+                purged++;
+            }
+        }
+    }
+
+    // 2. Límite de elementos
+    purged += evictOverItemQuota(released, files);
+
+    // 3. Límite de memoria sin volcado a disco: expulsar residentes LRU
+    if (spillThreshold == 0) {
+        auto position = lru.end();
+        while (residentBytes > maxResidentBytes && position != lru.begin()) {
+            --position;
+            auto it = entries.find(*position);
+            if (it->second.busy || !it->second.node || !it->second.measured) continue;
+            position = next(position);
+            unlinkEntry(it, released, files);
+            evictedItems++;
+            purgedItems++;
+            purged++;
+        }
+    }
+
+    if (purged > 0) {
+        PurgeListener listener = purgeListener;
+        lock.unlock();
+        discard(released, files);
+        if (listener) listener(purged);
+        lock.lock();
+        return true;
+    }
+
+    // 4. Medir el primer subárbol residente pendiente
+    for (auto& pair : entries) {
+        Entry& entry = pair.second;
+        if (!entry.node || entry.measured || entry.busy) continue;
+
+        int id = entry.id;
+        auto node = entry.node;
+        auto abort = entry.abort;
+        entry.busy = true;
+        lock.unlock();
+
+        long long nodes = 0, bytes = 0;
+        bool completed = measureSubtree(node, *abort, nodes, bytes);
+        node.reset();
+
+        lock.lock();
+        auto it = entries.find(id);
+        if (it != entries.end()) {
+            it->second.busy = false;
+            if (completed) {
+                it->second.nodeCount = nodes;
+                it->second.bytes = bytes;
+                it->second.measured = true;
+                if (it->second.node) residentBytes += bytes;
+            }
+        }
+        entryReleased.notify_all();
+        return true;
+    }
+
+    // 5. Volcar a disco: subárboles grandes y, por encima de la cuota, los residentes LRU
+    if (spillThreshold == 0) {
+        return false;
+    }
+    for (auto position = lru.rbegin(); position != lru.rend(); ++position) {
+        Entry& entry = entries.find(*position)->second;
+        if (!entry.node || !entry.measured || entry.busy || entry.spillFailed) continue;
+        if (entry.nodeCount < spillThreshold && residentBytes <= maxResidentBytes) continue;
+
+        int id = entry.id;
+        auto node = entry.node;
+        auto abort = entry.abort;
+        string path = nextSpillPath(id);
+        entry.busy = true;
+        lock.unlock();
+
+        bool written = writeSubtree(node, path, *abort);
+        node.reset();
+
+        lock.lock();
+        auto it = entries.find(id);
+        bool kept = false;
+        if (it != entries.end()) {
+            it->second.busy = false;
+            if (written && !it->second.abort->load()) {
+                residentBytes -= it->second.bytes;
+                spilledItems++;
+                spilledBytes += it->second.bytes;
+                it->second.spillFile = path;
+                released.push_back(std::move(it->second.node));
+                kept = true;
+            } else if (!written && !it->second.abort->load()) {
+                it->second.spillFailed = true;
+            }
+        }
+        if (!kept) {
+            files.push_back(path);
+        }
+        entryReleased.notify_all();
+
+        lock.unlock();
+        discard(released, files);
+        lock.lock();
+        return true;
+    }
+
+    return false;
+}
+
+// Recorrer el subárbol contando nodos y memoria estimada
+bool TrashBin::measureSubtree(shared_ptr<TreeNode> root, const atomic<bool>& abort,
+                              long long& nodes, long long& bytes) {
+    vector<TreeNode*> pending = {root.get()};
+    nodes = 0;
+    bytes = 0;
+
+    while (!pending.empty()) {
+        if ((nodes & 4095) == 0 && abort.load()) return false;
+
+        TreeNode* node = pending.back();
+        pending.pop_back();
+
+        nodes++;
+        bytes += node->footprint();
+
+        for (auto& child : node->getChildren()) {
+            pending.push_back(child.get());
+        }
+    }
+    return true;
+}
+
+// Volcado en preorden: id, tipo, nombre, contenido y número de hijos.
+// Los nombres forman una tabla: la primera aparición se escribe como 0 y
+// el texto; las siguientes, como su posición en la tabla más uno
+bool TrashBin::writeSubtree(shared_ptr<TreeNode> root, const string& path,
+                           const atomic<bool>& abort) {
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) return false;
+
+    out.write(SPILL_MAGIC, sizeof(SPILL_MAGIC));
+
+    unordered_map<NamePool::Id, unsigned long long> nameTable;
+    vector<TreeNode*> pending = {root.get()};
+    long long written = 0;
+    while (!pending.empty()) {
+        if ((written++ & 4095) == 0 && abort.load()) return false;
+
+        TreeNode* node = pending.back();
+        pending.pop_back();
+
+        writeVarint(out, static_cast<unsigned long long>(node->id));
+        out.put(node->isFolder() ? 'D' : 'F');
+        auto known = nameTable.find(node->getNameId());
+        if (known != nameTable.end()) {
+            writeVarint(out, known->second + 1);
+        } else {
+            size_t position = nameTable.size();
+            nameTable.emplace(node->getNameId(), position);
+            writeVarint(out, 0);
+            writeString(out, node->getName());
+        }
+        writeString(out, node->getContent());
+        writeVarint(out, node->getChildren().size());
+
+        for (auto it = node->getChildren().rbegin(); it != node->getChildren().rend(); ++it) {
+            pending.push_back(it->get());
+        }
+    }
+
+    return static_cast<bool>(out.flush());
+}
+
+// Reconstruir un subárbol volcado (iterativo, admite árboles muy profundos)
+shared_ptr<TreeNode> TrashBin::readSubtree(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(SPILL_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), SPILL_MAGIC)) {
+        return nullptr;
+    }
+
+    vector<string> nameTable;
+    auto readName = [&in, &nameTable]() -> const string* {
+        unsigned long long position;
+        if (!readVarint(in, position)) return nullptr;
+        if (position > 0) {
+            return position <= nameTable.size() ? &nameTable[position - 1] : nullptr;
+        }
+        nameTable.emplace_back();
+        return readString(in, nameTable.back()) ? &nameTable.back() : nullptr;
+    };
+
+    auto readNode = [&in, &readName](unsigned long long& childCount) -> shared_ptr<TreeNode> {
+        unsigned long long id;
+        const string* name;
+        string content;
+        int type;
+        if (!readVarint(in, id) || (type = in.get()) == EOF || !(name = readName()) ||
+            !readString(in, content) || !readVarint(in, childCount)) {
+            return nullptr;
+        }
+        return TreeNode::create(static_cast<int>(id), *name,
+                                     type == 'D' ? NodeType::FOLDER : NodeType::FILE, content);
+    };
+
+    unsigned long long childCount;
+    auto root = readNode(childCount);
+    if (!root) return nullptr;
+
+    vector<pair<shared_ptr<TreeNode>, unsigned long long>> pending;
+    pending.push_back({root, childCount});
+    while (!pending.empty()) {
+        auto& top = pending.back();
+        if (top.second == 0) {
+            pending.pop_back();
+            continue;
+        }
+        top.second--;
+
+        auto child = readNode(childCount);
+        if (!child) return nullptr;
+        top.first->addChild(child);
+        pending.push_back({child, childCount});
+    }
+    return root;
+}
+
+// 7. Estadísticas
+void TrashBin::printStats(ostream& out) const {
+    lock_guard<mutex> lock(trashMutex);
+
+    size_t spilledNow = 0;
+    for (const auto& pair : entries) {
+        if (!pair.second.node) spilledNow++;
+    }
+
+    out << "=== PAPELERA ===" << endl;
+    out << "Elementos: " << entries.size() << " / " << maxItems
+        << " (" << spilledNow << " en disco)" << endl;
+    out << "Memoria residente estimada: " << residentBytes / 1024 << " KiB / "
+        << maxResidentBytes / 1024 << " KiB" << endl;
+    out << "Caducidad: " << (ttl.count() > 0 ? to_string(ttl.count()) + " s" : "desactivada") << endl;
+    out << "Volcado a disco: "
+        << (spillThreshold > 0 ? "desde " + to_string(spillThreshold) + " nodos" : "desactivado") << endl;
+    out << "Enviados: " << addedItems << ", restaurados: " << restoredItems
+        << ", purgados: " << purgedItems << " (caducados: " << expiredItems
+        << ", expulsados: " << evictedItems << ")" << endl;
+    out << "Volcados a disco: " << spilledItems << " (" << spilledBytes / 1024 << " KiB liberados)" << endl;
+}
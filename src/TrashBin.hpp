@@ -0,0 +1,144 @@
+#ifndef TRASHBIN_HPP
+#define TRASHBIN_HPP
+
+#include "TreeNode.hpp"
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+using namespace std;
+
+// Papelera de subárboles eliminados.
+// Indexa los elementos por id y por nombre (admite nombres repetidos),
+// limita el número de elementos y la memoria residente con expulsión LRU,
+// caduca los elementos tras un TTL y vuelca a disco los subárboles grandes.
+// Un hilo de fondo mide, vuelca y purga; rm sigue siendo O(1).
+class TrashBin {
+public:
+    struct ItemInfo {
+        int id;
+        string name;
+        string originalPath;
+        bool folder;
+        bool spilled;        // Guardado en disco, no residente
+        long long nodeCount; // 0 mientras no se haya medido
+        long long bytes;     // Memoria estimada cuando es residente
+        long long ageSeconds;
+    };
+
+    // Se invoca (desde cualquier hilo) cuando se purgan elementos
+    using PurgeListener = function<void(size_t purgedItems)>;
+
+private:
+    struct Entry {
+        int id;
+        string name;
+        string originalPath;
+        bool folder;
+        weak_ptr<TreeNode> parent;  // No mantiene vivo al padre original
+        shared_ptr<TreeNode> node;  // Nulo si el subárbol está en disco
+        string spillFile;
+        long long nodeCount;
+        long long bytes;
+        bool measured;
+        bool busy;                  // El hilo de fondo está recorriendo el subárbol
+        bool spillFailed;           // No reintentar un volcado que ya falló
+        shared_ptr<atomic<bool>> abort;
+        chrono::steady_clock::time_point deletedAt;
+        list<int>::iterator lruPosition;
+    };
+
+    map<int, Entry> entries;
+    map<string, vector<int>> byName;  // Ids en orden de borrado
+    list<int> lru;                    // Más reciente al frente
+
+    // Límites
+    size_t maxItems;
+    long long maxResidentBytes;
+    long long spillThreshold;         // Nodos; 0 = sin volcado a disco
+    chrono::seconds ttl;              // 0 = sin caducidad
+    long long residentBytes;
+
+    // Contadores
+    long long addedItems;
+    long long restoredItems;
+    long long purgedItems;
+    long long expiredItems;
+    long long evictedItems;
+    long long spilledItems;
+    long long spilledBytes;
+
+    string spillDirectory;
+    PurgeListener purgeListener;
+
+    mutable mutex trashMutex;
+    condition_variable workAvailable;
+    condition_variable entryReleased;
+    thread purger;
+    bool stopping;
+    bool workPending;
+
+    // Helpers (con trashMutex tomado salvo que se indique)
+    void touch(Entry& entry);
+    void unlinkEntry(map<int, Entry>::iterator it, vector<shared_ptr<TreeNode>>& released,
+                     vector<string>& files);
+    size_t evictOverItemQuota(vector<shared_ptr<TreeNode>>& released, vector<string>& files);
+    static void discard(vector<shared_ptr<TreeNode>>& released, vector<string>& files);
+    string nextSpillPath(int id);
+
+    // Trabajo del hilo de fondo
+    void purgerLoop();
+    bool maintenanceStep(unique_lock<mutex>& lock);
+
+    // Volcado compacto: preorden con enteros de longitud variable
+    static bool measureSubtree(shared_ptr<TreeNode> root, const atomic<bool>& abort,
+                               long long& nodes, long long& bytes);
+    static bool writeSubtree(shared_ptr<TreeNode> root, const string& path,
+                             const atomic<bool>& abort);
+    static shared_ptr<TreeNode> readSubtree(const string& path);
+
+public:
+    TrashBin();
+    ~TrashBin();
+
+    TrashBin(const TrashBin&) = delete;
+    TrashBin& operator=(const TrashBin&) = delete;
+
+    // 1. Enviar un subárbol (ya desconectado) a la papelera
+    void add(shared_ptr<TreeNode> node, shared_ptr<TreeNode> parent, const string& originalPath);
+
+    // 2. Buscar un elemento por nombre (el más reciente) o por "#id".
+    //    parent recibe el padre original si sigue vivo.
+    bool lookup(const string& key, ItemInfo& info, shared_ptr<TreeNode>& parent);
+
+    // 3. Sacar un elemento de la papelera (lo lee de disco si hace falta)
+    shared_ptr<TreeNode> take(int id);
+
+    // 4. Listado en orden de borrado
+    vector<ItemInfo> items() const;
+    vector<shared_ptr<TreeNode>> residentRoots() const;  // Subárboles en memoria
+    size_t size() const;
+    bool empty() const;
+
+    // 5. Vaciar la papelera (los nodos van al recolector diferido)
+    void clear();
+
+    // 6. Configuración
+    void setTtl(long long seconds);
+    void setQuota(size_t items, long long bytes);
+    void setSpillThreshold(long long nodes);
+    void setPurgeListener(PurgeListener listener);
+
+    // 7. Estadísticas
+    void printStats(ostream& out = cout) const;
+};
+
+#endif // TRASHBIN_HPP
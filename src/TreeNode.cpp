@@ -1,31 +1,150 @@
 #include "TreeNode.hpp"
+#include "NodeRegistry.hpp"
 #include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Pila de la liberación en curso en este hilo: mientras exista, los
+    // destructores de carpeta dejan en ella sus hijos en vez de liberarlos
+    // de forma recursiva
+    thread_local vector<shared_ptr<TreeNode>>* releasing = nullptr;
+    thread_local long long releasedHere = 0;
+}
 
 // Constructor
-TreeNode::TreeNode(int nodeId, const string& nodeName, NodeType nodeType, 
-                   const string& nodeContent)
-    : id(nodeId), name(nodeName), type(nodeType), content(nodeContent) {}
+TreeNode::TreeNode(int nodeId, const string& nodeName, NodeType nodeType)
+    : id(nodeId),
+      nameAndType(NamePool::instance().intern(nodeName) | (nodeType == NodeType::FOLDER ? FOLDER_BIT : 0)),
+      registrySlot(NodeRegistry::instance().add(this)),
+      attachedEpoch(0) {}
+
+// Destructor: lo común a carpetas y archivos
+TreeNode::~TreeNode() {
+    // Primero, antes de que se destruya enable_shared_from_this. La parte
+    // de carpeta o archivo ya no existe, pero el censo solo lee hijos y
+    // contenido de los nodos que consigue fijar, y este (contador a cero)
+    // ya no se deja fijar
+    NodeRegistry::instance().remove(registrySlot);
+    
+    // Las marcas de orden no deben quedar enlazadas a un nodo liberado
+    enter.unlink();
+    exit.unlink();
+    
+    NamePool::instance().release(getNameId());
+    if (releasing) releasedHere++;
+}
+
+FolderNode::FolderNode(int nodeId, const string& nodeName)
+    : TreeNode(nodeId, nodeName, NodeType::FOLDER) {}
+
+// Destructor: desmontar los hijos sin recursión
+FolderNode::~FolderNode() {
+    if (children.empty()) return;
+    
+    // Dentro de una liberación, el bucle de releaseIteratively se encarga
+    if (releasing) {
+        for (auto& child : children) {
+            releasing->push_back(std::move(child));
+        }
+        children.clear();
+        return;
+    }
+    
+    vector<shared_ptr<TreeNode>> pending;
+    pending.swap(children);
+    releaseIteratively(pending);
+}
 
-// Método para verificar si es carpeta
-bool TreeNode::isFolder() const {
-    return type == NodeType::FOLDER;
+FileNode::FileNode(int nodeId, const string& nodeName, const string& nodeContent)
+    : TreeNode(nodeId, nodeName, NodeType::FILE), content(nodeContent) {}
+
+// Crear el nodo con la disposición de su tipo. El bloque (nodo y contador
+// de referencias juntos, como make_shared) se reserva con NodeAllocator
+shared_ptr<TreeNode> TreeNode::create(int nodeId, const string& nodeName, NodeType nodeType,
+                                      const string& nodeContent) {
+    if (nodeType == NodeType::FOLDER) {
+        return allocate_shared<FolderNode>(NodeAllocator<FolderNode>(), nodeId, nodeName);
+    }
+    return allocate_shared<FileNode>(NodeAllocator<FileNode>(), nodeId, nodeName, nodeContent);
 }
 
-// Método para verificar si es archivo
-bool TreeNode::isFile() const {
-    return type == NodeType::FILE;
+// Memoria aproximada del nodo
+size_t TreeNode::footprint() const {
+    // Nodo y bloque de control de allocate_shared
+    if (const FolderNode* folder = asFolder()) {
+        return sizeof(FolderNode) + 16 + folder->children.capacity() * sizeof(shared_ptr<TreeNode>);
+    }
+    return sizeof(FileNode) + 16 + getContent().capacity();
+}
+
+// Liberar nodos con una pila explícita en lugar de la pila de llamadas.
+// Cada nodo solo se desmonta en su propio destructor, cuando el contador ya
+// llegó a cero: un weak_ptr (referencias del buscador, PathCache, el padre
+// de un hijo que sigue vivo) no puede recuperar un nodo a medio desmontar,
+// y un nodo con otras referencias (papelera, sesión) queda intacto
+long long TreeNode::releaseIteratively(vector<shared_ptr<TreeNode>>& pending) {
+    if (releasing) {
+        for (auto& node : pending) {
+            releasing->push_back(std::move(node));
+        }
+        pending.clear();
+        return 0;
+    }
+    
+    releasing = &pending;
+    releasedHere = 0;
+    while (!pending.empty()) {
+        shared_ptr<TreeNode> node = std::move(pending.back());
+        pending.pop_back();
+        
+        // Si era la última referencia, ~FolderNode apila aquí los hijos
+        node.reset();
+    }
+    releasing = nullptr;
+    
+    return releasedHere;
 }
 
 // Método para agregar hijo
 void TreeNode::addChild(shared_ptr<TreeNode> child) {
+    FolderNode* folder = asFolder();
+    if (!folder) {
+        throw invalid_argument("Un archivo no puede tener hijos");
+    }
+    
     child->parent = weak_ptr<TreeNode>(shared_from_this());
-    children.push_back(child);
+    folder->children.push_back(child);
+    
+    auto& childIndex = folder->childIndex;
+    if (childIndex) {
+        childIndex->emplace(child->getName(), child.get());
+    } else if (folder->children.size() >= CHILD_INDEX_THRESHOLD) {
+        // Con pocos hijos basta la búsqueda lineal; a partir del umbral se
+        // indexan todos (ante nombres repetidos gana el primero, como antes)
+        childIndex.reset(new unordered_map<string_view, TreeNode*>());
+        childIndex->reserve(folder->children.size() * 2);
+        for (auto& existing : folder->children) {
+            childIndex->emplace(existing->getName(), existing.get());
+        }
+    }
 }
 
 // Método para encontrar hijo por nombre
 shared_ptr<TreeNode> TreeNode::findChild(const string& childName) {
-    for (auto& child : children) {
-        if (child->name == childName) {
+    FolderNode* folder = asFolder();
+    if (!folder) return nullptr;
+    
+    if (folder->childIndex) {
+        auto it = folder->childIndex->find(childName);
+        return it != folder->childIndex->end() ? it->second->shared_from_this() : nullptr;
+    }
+    
+    // Sin índice se comparan identificadores; un nombre que no está en el
+    // pool no puede ser el de ningún hijo
+    NamePool::Id wanted = NamePool::instance().find(childName);
+    if (wanted == NamePool::NO_NAME) return nullptr;
+    for (auto& child : folder->children) {
+        if (child->getNameId() == wanted) {
             return child;
         }
     }
@@ -34,14 +153,42 @@ shared_ptr<TreeNode> TreeNode::findChild(const string& childName) {
 
 // Método para eliminar hijo por nombre
 bool TreeNode::removeChild(const string& childName) {
+    FolderNode* folder = asFolder();
+    if (!folder) return false;
+    
+    NamePool::Id wanted = NamePool::instance().find(childName);
+    if (wanted == NamePool::NO_NAME) return false;
+    
+    auto& children = folder->children;
     auto it = remove_if(children.begin(), children.end(),
-        [&childName](const shared_ptr<TreeNode>& child) {
-            return child->name == childName;
+        [wanted](const shared_ptr<TreeNode>& child) {
+            return child->getNameId() == wanted;
         });
     
     if (it != children.end()) {
         children.erase(it, children.end());
+        if (folder->childIndex) {
+            folder->childIndex->erase(childName);
+        }
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+// Cambiar el nombre manteniendo el índice del padre
+void TreeNode::setName(const string& newName) {
+    auto parentNode = parent.lock();
+    FolderNode* parentFolder = parentNode ? parentNode->asFolder() : nullptr;
+    NamePool& pool = NamePool::instance();
+    NamePool::Id newId = pool.intern(newName);
+    if (parentFolder && parentFolder->childIndex) {
+        auto& childIndex = parentFolder->childIndex;
+        auto it = childIndex->find(getName());
+        if (it != childIndex->end() && it->second == this) {
+            childIndex->erase(it);
+        }
+        childIndex->emplace(pool.get(newId), this);
+    }
+    pool.release(getNameId());
+    nameAndType = newId | (nameAndType & FOLDER_BIT);
+}
@@ -5,6 +5,10 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <string_view>
+#include "NamePool.hpp"
 
 using namespace std;
 
@@ -14,26 +18,89 @@ enum class NodeType {
     FILE
 };
 
-// Estructura base de un nodo - hereda de enable_shared_from_this
+// Marca de orden: entrada o salida de un nodo en el recorrido en preorden.
+// Las marcas de un árbol forman una lista con etiquetas crecientes
+// (ver OrderLabels); un nodo contiene a otro si su intervalo lo abarca.
+struct OrderTag {
+    uint64_t label;
+    OrderTag* prev;
+    OrderTag* next;
+    
+    OrderTag() : label(0), prev(nullptr), next(nullptr) {}
+    
+    // Sacar la marca de la lista uniendo a sus vecinas
+    void unlink() {
+        if (prev) prev->next = next;
+        if (next) next->prev = prev;
+        prev = next = nullptr;
+    }
+};
+
+struct FolderNode;
+struct FileNode;
+
+// Estructura base de un nodo - hereda de enable_shared_from_this.
+// Solo guarda lo común; las carpetas (FolderNode) añaden los hijos y los
+// archivos (FileNode) el contenido, de modo que ningún nodo paga por los
+// campos del otro tipo. El tipo va en el bit alto del nombre internado.
+// Los nodos se crean con TreeNode::create; el destructor no es virtual
+// (ahorra el puntero a la vtable) porque solo los destruye el shared_ptr,
+// que conoce el tipo real. Todo nodo vivo figura en NodeRegistry.
 struct TreeNode : public enable_shared_from_this<TreeNode> {
     int id;
-    string name;
-    NodeType type;
-    string content;  // Solo para archivos
-    vector<shared_ptr<TreeNode>> children;
+private:
+    friend class NodeRegistry;
+    static const uint32_t FOLDER_BIT = 1u << 31;  // NamePool no llega a este bit
+    uint32_t nameAndType;       // Id del nombre en NamePool | FOLDER_BIT
+    uint32_t registrySlot;      // Hueco en NodeRegistry (fijo mientras viva)
+public:
     weak_ptr<TreeNode> parent;  // Referencia al padre
+    OrderTag enter;             // Intervalo del subárbol en preorden
+    OrderTag exit;
+    uint64_t attachedEpoch;     // Última época en que se comprobó conectado a la raíz
+    
+    static const size_t CHILD_INDEX_THRESHOLD = 16;
+    
+protected:
+    TreeNode(int nodeId, const string& nodeName, NodeType nodeType);
+    ~TreeNode();
     
-    // Constructor
-    TreeNode(int nodeId, const string& nodeName, NodeType nodeType, 
-             const string& nodeContent = "");
+public:
+    // Crear una carpeta o un archivo (el contenido solo se guarda en archivos)
+    static shared_ptr<TreeNode> create(int nodeId, const string& nodeName, NodeType nodeType,
+                                       const string& nodeContent = "");
+    
+    // Soltar las referencias de la pila y liberar de forma iterativa los
+    // nodos que no tengan otras. Devuelve el número de nodos liberados.
+    static long long releaseIteratively(vector<shared_ptr<TreeNode>>& pending);
     
     // Método para verificar si es carpeta
-    bool isFolder() const;
+    bool isFolder() const { return (nameAndType & FOLDER_BIT) != 0; }
     
     // Método para verificar si es archivo
-    bool isFile() const;
+    bool isFile() const { return !isFolder(); }
+    
+    NodeType getType() const { return isFolder() ? NodeType::FOLDER : NodeType::FILE; }
+    
+    // Memoria aproximada del nodo: bloque de control, hijos y contenido
+    // (el nombre vive en NamePool)
+    size_t footprint() const;
+    
+    // Vista como carpeta o archivo (nulo si el nodo es del otro tipo)
+    FolderNode* asFolder();
+    const FolderNode* asFolder() const;
+    FileNode* asFile();
+    const FileNode* asFile() const;
     
-    // Método para agregar hijo
+    // Hijos (vacío en archivos) y contenido (vacío en carpetas)
+    const vector<shared_ptr<TreeNode>>& getChildren() const;
+    const string& getContent() const;
+    
+    // Nombre del nodo (texto compartido en NamePool)
+    NamePool::Id getNameId() const { return nameAndType & ~FOLDER_BIT; }
+    const string& getName() const { return NamePool::instance().get(getNameId()); }
+    
+    // Método para agregar hijo (lanza invalid_argument si es un archivo)
     void addChild(shared_ptr<TreeNode> child);
     
     // Método para encontrar hijo por nombre
@@ -41,6 +108,57 @@ struct TreeNode : public enable_shared_from_this<TreeNode> {
     
     // Método para eliminar hijo por nombre
     bool removeChild(const string& childName);
+    
+    // Cambiar el nombre manteniendo el índice del padre
+    void setName(const string& newName);
 };
 
+// Carpeta: hijos y, con muchos, un índice nombre -> hijo
+struct FolderNode : public TreeNode {
+    vector<shared_ptr<TreeNode>> children;
+    
+    // Índice nombre -> hijo; solo en directorios con muchos hijos
+    // (se crea al llegar a CHILD_INDEX_THRESHOLD)
+    // Las claves apuntan al texto del pool, que no se mueve
+    unique_ptr<unordered_map<string_view, TreeNode*>> childIndex;
+    
+    FolderNode(int nodeId, const string& nodeName);
+    
+    // Destructor iterativo: evita la cascada recursiva de shared_ptr
+    ~FolderNode();
+};
+
+// Archivo: solo el contenido
+struct FileNode : public TreeNode {
+    string content;
+    
+    FileNode(int nodeId, const string& nodeName, const string& nodeContent);
+};
+
+inline FolderNode* TreeNode::asFolder() {
+    return isFolder() ? static_cast<FolderNode*>(this) : nullptr;
+}
+
+inline const FolderNode* TreeNode::asFolder() const {
+    return isFolder() ? static_cast<const FolderNode*>(this) : nullptr;
+}
+
+inline FileNode* TreeNode::asFile() {
+    return isFile() ? static_cast<FileNode*>(this) : nullptr;
+}
+
+inline const FileNode* TreeNode::asFile() const {
+    return isFile() ? static_cast<const FileNode*>(this) : nullptr;
+}
+
+inline const vector<shared_ptr<TreeNode>>& TreeNode::getChildren() const {
+    static const vector<shared_ptr<TreeNode>> none;
+    return isFolder() ? static_cast<const FolderNode*>(this)->children : none;
+}
+
+inline const string& TreeNode::getContent() const {
+    static const string none;
+    return isFile() ? static_cast<const FileNode*>(this)->content : none;
+}
+
 #endif // TREENODE_HPP
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "TreeSnapshot.hpp"
+#include <algorithm>
+
+// Con GCC/Clang en x86-64 cada reducción se compila también para AVX2 y
+// se elige la variante al cargar el programa (SSE2 no tiene máximo de
+// enteros de 32 bits)
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SNAPSHOT_REDUCTION __attribute__((target_clones("avx2", "default")))
+#else
+#define SNAPSHOT_REDUCTION
+#endif
+
+namespace {
+    // Las reducciones llevan LANES acumuladores independientes para que el
+    // compilador las convierta en operaciones vectoriales
+    const size_t LANES = 8;
+
+    SNAPSHOT_REDUCTION
+    uint32_t maxOf(const uint32_t* data, size_t n) {
+        uint32_t lanes[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            for (size_t k = 0; k < LANES; k++) {
+                lanes[k] = max(lanes[k], data[i + k]);
+            }
+        }
+        uint32_t result = *max_element(lanes, lanes + LANES);
+        for (; i < n; i++) {
+            result = max(result, data[i]);
+        }
+        return result;
+    }
+
+    SNAPSHOT_REDUCTION
+    size_t sumOf(const uint8_t* data, size_t n) {
+        uint32_t lanes[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            for (size_t k = 0; k < LANES; k++) {
+                lanes[k] += data[i + k];
+            }
+        }
+        size_t result = 0;
+        for (size_t k = 0; k < LANES; k++) {
+            result += lanes[k];
+        }
+        for (; i < n; i++) {
+            result += data[i];
+        }
+        return result;
+    }
+
+    // Una hoja es un nodo cuyo subárbol es solo él mismo
+    SNAPSHOT_REDUCTION
+    void sumLeaves(const uint32_t* sizes, const uint32_t* depths, size_t n,
+                   size_t& leaves, uint32_t& minDepth, uint64_t& totalDepth) {
+        uint32_t leafLanes[LANES] = {};
+        uint32_t minLanes[LANES];
+        uint64_t totalLanes[LANES] = {};
+        fill(minLanes, minLanes + LANES, UINT32_MAX);
+
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            for (size_t k = 0; k < LANES; k++) {
+                uint32_t leaf = sizes[i + k] == 1;
+                leafLanes[k] += leaf;
+                minLanes[k] = min(minLanes[k], leaf ? depths[i + k] : UINT32_MAX);
+                totalLanes[k] += leaf * depths[i + k];
+            }
+        }
+
+        leaves = 0;
+        minDepth = UINT32_MAX;
+        totalDepth = 0;
+        for (size_t k = 0; k < LANES; k++) {
+            leaves += leafLanes[k];
+            minDepth = min(minDepth, minLanes[k]);
+            totalDepth += totalLanes[k];
+        }
+        for (; i < n; i++) {
+            if (sizes[i] != 1) continue;
+            leaves++;
+            minDepth = min(minDepth, depths[i]);
+            totalDepth += depths[i];
+        }
+    }
+}
+
+// 1. Construir en preorden con una pila explícita
+shared_ptr<const TreeSnapshot> TreeSnapshot::build(const TreeNode* root) {
+    auto snapshot = make_shared<TreeSnapshot>();
+    if (!root) return snapshot;
+
+    // (nodo, posición del padre); los hijos se apilan al revés
+    vector<pair<const TreeNode*, int32_t>> pending = {{root, -1}};
+    while (!pending.empty()) {
+        const TreeNode* node = pending.back().first;
+        int32_t parent = pending.back().second;
+        pending.pop_back();
+
+        int32_t position = static_cast<int32_t>(snapshot->ids.size());
+        snapshot->parents.push_back(parent);
+        snapshot->subtreeSizes.push_back(1);
+        snapshot->depths.push_back(parent < 0 ? 0 : snapshot->depths[parent] + 1);
+        snapshot->folders.push_back(node->isFolder() ? 1 : 0);
+        snapshot->nameIds.push_back(node->getNameId());
+        snapshot->ids.push_back(node->id);
+
+        const auto& children = node->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            pending.push_back({it->get(), position});
+        }
+    }
+
+    // Tamaños de subárbol: en preorden inverso cada nodo ya tiene el suyo
+    // completo cuando se suma al padre
+    for (size_t i = snapshot->ids.size(); i-- > 1;) {
+        snapshot->subtreeSizes[snapshot->parents[i]] += snapshot->subtreeSizes[i];
+    }
+
+    // La instantánea puede vivir mucho: no guardar la holgura del crecimiento
+    snapshot->parents.shrink_to_fit();
+    snapshot->subtreeSizes.shrink_to_fit();
+    snapshot->depths.shrink_to_fit();
+    snapshot->folders.shrink_to_fit();
+    snapshot->nameIds.shrink_to_fit();
+    snapshot->ids.shrink_to_fit();
+    return snapshot;
+}
+
+// 3. Reducciones
+uint32_t TreeSnapshot::maxDepth() const {
+    return maxOf(depths.data(), depths.size());
+}
+
+size_t TreeSnapshot::folderCount() const {
+    return sumOf(folders.data(), folders.size());
+}
+
+TreeSnapshot::LeafDepths TreeSnapshot::leafDepths() const {
+    LeafDepths result;
+    sumLeaves(subtreeSizes.data(), depths.data(), depths.size(),
+              result.leaves, result.minDepth, result.totalDepth);
+    if (result.leaves == 0) result.minDepth = 0;
+    return result;
+}
+
+// 4. Memoria
+size_t TreeSnapshot::byteSize() const {
+    return parents.capacity() * sizeof(int32_t) + subtreeSizes.capacity() * sizeof(uint32_t)
+         + depths.capacity() * sizeof(uint32_t) + folders.capacity() * sizeof(uint8_t)
+         + nameIds.capacity() * sizeof(uint32_t) + ids.capacity() * sizeof(int);
+}
@@ -0,0 +1,59 @@
+#ifndef TREESNAPSHOT_HPP
+#define TREESNAPSHOT_HPP
+
+#include "TreeNode.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+// Copia plana y de solo lectura del árbol para análisis: una posición por
+// nodo en preorden y un arreglo por campo (padre, tamaño del subárbol,
+// profundidad, tipo, nombre e ID). Las estadísticas se calculan con
+// recorridos lineales sobre memoria contigua en lugar de saltar entre
+// shared_ptr repartidos por el montón.
+// Es inmutable; FileSystemTree::freeze la reconstruye solo cuando el árbol
+// ha cambiado. Los nombres (ids de NamePool) solo son válidos mientras el
+// árbol no cambie.
+class TreeSnapshot {
+public:
+    // Hojas (nodos sin hijos) y sus profundidades
+    struct LeafDepths {
+        size_t leaves;
+        uint32_t minDepth;      // 0 si no hay hojas
+        uint64_t totalDepth;
+    };
+
+private:
+    vector<int32_t> parents;        // Posición del padre (-1 en la raíz)
+    vector<uint32_t> subtreeSizes;  // Nodos del subárbol, el propio incluido
+    vector<uint32_t> depths;
+    vector<uint8_t> folders;        // 1 = carpeta
+    vector<uint32_t> nameIds;
+    vector<int> ids;
+
+public:
+    // 1. Construir desde una raíz (recorrido iterativo; nula = vacía)
+    static shared_ptr<const TreeSnapshot> build(const TreeNode* root);
+
+    // 2. Arreglos en preorden: los descendientes de i ocupan
+    //    [i + 1, i + subtreeSizes[i])
+    size_t size() const { return ids.size(); }
+    const vector<int32_t>& getParents() const { return parents; }
+    const vector<uint32_t>& getSubtreeSizes() const { return subtreeSizes; }
+    const vector<uint32_t>& getDepths() const { return depths; }
+    const vector<uint8_t>& getFolders() const { return folders; }
+    const vector<uint32_t>& getNameIds() const { return nameIds; }
+    const vector<int>& getIds() const { return ids; }
+
+    // 3. Reducciones lineales
+    uint32_t maxDepth() const;
+    size_t folderCount() const;
+    LeafDepths leafDepths() const;
+
+    // 4. Memoria ocupada por los arreglos
+    size_t byteSize() const;
+};
+
+#endif // TREESNAPSHOT_HPP
@@ -0,0 +1,339 @@
+#include "TreeValidator.hpp"
+#include "OrderLabels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <unordered_set>
+
+const size_t TreeValidator::MAX_ISSUES;
+
+namespace {
+    const size_t ISSUE_TYPES = 8;
+
+    // Subárboles por hilo que se preparan antes del reparto
+    const size_t TASKS_PER_THREAD = 16;
+
+    // Conjunto de IDs vistos: un bit por ID bajo idLimit (atómico, lo
+    // comparten los hilos) y un conjunto aparte para los que se salgan
+    class IdSet {
+    private:
+        unique_ptr<atomic<uint64_t>[]> words;
+        size_t limit;
+        mutex overflowMutex;
+        unordered_set<int> overflow;
+
+    public:
+        explicit IdSet(int idLimit) : limit(idLimit > 0 ? static_cast<size_t>(idLimit) : 0) {
+            size_t count = (limit + 63) / 64;
+            words.reset(new atomic<uint64_t>[count]);
+            for (size_t i = 0; i < count; i++) {
+                words[i].store(0, memory_order_relaxed);
+            }
+        }
+
+        // true si el ID no se había visto
+        bool insert(int id) {
+            if (id >= 0 && static_cast<size_t>(id) < limit) {
+                uint64_t bit = uint64_t(1) << (id & 63);
+                return (words[id >> 6].fetch_or(bit, memory_order_relaxed) & bit) == 0;
+            }
+            lock_guard<mutex> lock(overflowMutex);
+            return overflow.insert(id).second;
+        }
+    };
+
+    // Nodo de los primeros niveles, comprobado antes del reparto. Los
+    // punteros señalan al shared_ptr que guarda el padre (o a la raíz)
+    struct UpperNode {
+        const shared_ptr<TreeNode>* node;
+        int32_t parent;     // Posición en la lista (-1 en la raíz)
+    };
+
+    // Marco de la pila de un hilo: nodo y siguiente hijo por visitar
+    struct Frame {
+        const shared_ptr<TreeNode>* node;
+        size_t next;
+    };
+
+    // ¿El enlace débil al padre señala exactamente a parent? (sin tocar
+    // los contadores atómicos)
+    bool linkedTo(const weak_ptr<TreeNode>& link, const shared_ptr<TreeNode>& parent) {
+        return !link.owner_before(parent) && !parent.owner_before(link);
+    }
+
+    // Resultados de un hilo o de un subárbol
+    struct Findings {
+        size_t nodes = 0;
+        size_t folders = 0;
+        size_t counts[ISSUE_TYPES] = {};
+        vector<TreeValidator::Issue> issues;
+
+        void add(TreeValidator::IssueType type, int id, const string& message) {
+            counts[static_cast<int>(type)]++;
+            if (issues.size() < TreeValidator::MAX_ISSUES) {
+                issues.push_back({type, id, message});
+            }
+        }
+
+        void merge(const Findings& other) {
+            nodes += other.nodes;
+            folders += other.folders;
+            for (size_t i = 0; i < ISSUE_TYPES; i++) counts[i] += other.counts[i];
+            for (const auto& issue : other.issues) {
+                if (issues.size() >= TreeValidator::MAX_ISSUES) break;
+                issues.push_back(issue);
+            }
+        }
+    };
+
+    // Comprobaciones compartidas por la fase inicial y por los hilos
+    class Checker {
+    private:
+        IdSet& ids;
+        vector<uint32_t> scratch;   // Nombres de los hijos de una carpeta
+
+    public:
+        explicit Checker(IdSet& idSet) : ids(idSet) {}
+
+        // Entrar en child desde parent. path devuelve el camino actual
+        // (de la raíz a parent) solo si hace falta describir un ciclo.
+        // Devuelve si hay que recorrer sus hijos.
+        template <typename PathContains, typename Path>
+        bool enter(const shared_ptr<TreeNode>& childRef, const shared_ptr<TreeNode>& parentRef,
+                   PathContains contains, Path path, Findings& out) {
+            const TreeNode* child = childRef.get();
+            const TreeNode* parent = parentRef.get();
+            out.nodes++;
+            if (child->isFolder()) out.folders++;
+
+            bool linked = linkedTo(child->parent, parentRef);
+            if (!linked) {
+                if (child->parent.expired()) {
+                    out.add(TreeValidator::IssueType::ORPHAN, child->id,
+                            "Nodo huérfano '" + child->getName() + "' (ID: " + to_string(child->id) +
+                            ") bajo '" + parent->getName() + "': su enlace al padre está vacío");
+                } else {
+                    out.add(TreeValidator::IssueType::PARENT_MISMATCH, child->id,
+                            "Inconsistencia padre-hijo en nodo '" + child->getName() +
+                            "' (ID: " + to_string(child->id) + ")");
+                }
+            }
+
+            if (!ids.insert(child->id)) {
+                if (contains(child)) {
+                    string cycle = "Ciclo encontrado: ";
+                    bool inCycle = false;
+                    for (const TreeNode* node : path()) {
+                        inCycle = inCycle || node == child;
+                        if (inCycle) cycle += node->getName() + " -> ";
+                    }
+                    out.add(TreeValidator::IssueType::CYCLE, child->id, cycle + child->getName());
+                    return false;
+                }
+                out.add(TreeValidator::IssueType::DUPLICATE_ID, child->id,
+                        "ID duplicado encontrado: " + to_string(child->id) +
+                        " (Nodo: " + child->getName() + ")");
+                // Un nodo compartido ya se recorre desde su padre verdadero
+                if (!linked) return false;
+            }
+
+            if (child->enter.label >= child->exit.label || child->enter.label <= parent->enter.label ||
+                !OrderLabels::contains(*parent, *child)) {
+                out.add(TreeValidator::IssueType::ORDER_LABELS, child->id,
+                        "Etiquetas de orden de '" + child->getName() + "' (ID: " + to_string(child->id) +
+                        ") fuera del intervalo de su padre");
+            }
+            return true;
+        }
+
+        // Comprobaciones de una carpeta sobre sus hijos (antes de recorrerlos)
+        void checkFolder(const TreeNode* node, Findings& out) {
+            const FolderNode* folder = node->asFolder();
+            if (!folder || folder->children.empty()) return;
+
+            if (folder->childIndex) {
+                for (const auto& child : folder->children) {
+                    if (folder->childIndex->count(child->getName()) == 0) {
+                        out.add(TreeValidator::IssueType::CHILD_INDEX, child->id,
+                                "El índice de hijos de '" + node->getName() + "' no encuentra '" +
+                                child->getName() + "'");
+                    }
+                }
+            }
+
+            if (folder->children.size() < 2) return;
+            scratch.clear();
+            for (const auto& child : folder->children) {
+                scratch.push_back(child->getNameId());
+            }
+            sort(scratch.begin(), scratch.end());
+            for (size_t i = 1; i < scratch.size(); i++) {
+                if (scratch[i] != scratch[i - 1]) continue;
+                out.add(TreeValidator::IssueType::DUPLICATE_NAME, node->id,
+                        "Nombre duplicado '" + NamePool::instance().get(scratch[i]) +
+                        "' en hijos de '" + node->getName() + "'");
+            }
+        }
+    };
+}
+
+// Válido si solo hay advertencias de nombres repetidos
+bool TreeValidator::Report::valid() const {
+    for (size_t i = 0; i < ISSUE_TYPES; i++) {
+        if (i != static_cast<size_t>(IssueType::DUPLICATE_NAME) && counts[i] > 0) return false;
+    }
+    return true;
+}
+
+// 1. Validar
+TreeValidator::Report TreeValidator::validate(const shared_ptr<TreeNode>& root, int idLimit, unsigned threads) {
+    auto start = chrono::steady_clock::now();
+    Report report;
+    report.nodes = 0;
+    report.folders = 0;
+    fill(report.counts, report.counts + ISSUE_TYPES, 0);
+    report.threads = 0;
+    report.seconds = 0.0;
+    if (!root) return report;
+
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+    IdSet ids(idLimit);
+    Checker checker(ids);
+    Findings upperFindings;
+
+    // Fase inicial: la raíz y los primeros niveles en anchura, hasta
+    // tener bastantes subárboles pendientes para repartir
+    upperFindings.nodes++;
+    if (root->isFolder()) upperFindings.folders++;
+    ids.insert(root->id);
+    if (!root->parent.expired()) {
+        upperFindings.add(IssueType::ROOT_HAS_PARENT, root->id, "La raíz tiene un padre asignado.");
+    }
+
+    vector<UpperNode> upper = {{&root, -1}};
+    size_t expanded = 0;
+    while (expanded < upper.size() && upper.size() - expanded < threads * TASKS_PER_THREAD) {
+        size_t index = expanded++;
+        const shared_ptr<TreeNode>& nodeRef = *upper[index].node;
+        checker.checkFolder(nodeRef.get(), upperFindings);
+
+        auto contains = [&](const TreeNode* target) {
+            for (int32_t i = static_cast<int32_t>(index); i >= 0; i = upper[i].parent) {
+                if (upper[i].node->get() == target) return true;
+            }
+            return false;
+        };
+        auto path = [&]() {
+            vector<const TreeNode*> nodes;
+            for (int32_t i = static_cast<int32_t>(index); i >= 0; i = upper[i].parent) {
+                nodes.push_back(upper[i].node->get());
+            }
+            reverse(nodes.begin(), nodes.end());
+            return nodes;
+        };
+
+        for (const auto& child : nodeRef->getChildren()) {
+            if (checker.enter(child, nodeRef, contains, path, upperFindings)) {
+                upper.push_back({&child, static_cast<int32_t>(index)});
+            }
+        }
+    }
+
+    // Reparto: cada subárbol pendiente es una tarea con sus propios resultados
+    size_t taskCount = upper.size() - expanded;
+    threads = static_cast<unsigned>(min<size_t>(threads, max<size_t>(taskCount, 1)));
+    vector<Findings> taskFindings(taskCount);
+    atomic<size_t> nextTask(0);
+
+    auto worker = [&]() {
+        Checker local(ids);
+        vector<Frame> frames;
+        while (true) {
+            size_t task = nextTask.fetch_add(1);
+            if (task >= taskCount) break;
+            size_t base = expanded + task;
+            Findings& out = taskFindings[task];
+
+            auto contains = [&](const TreeNode* target) {
+                for (const Frame& frame : frames) {
+                    if (frame.node->get() == target) return true;
+                }
+                for (int32_t i = upper[base].parent; i >= 0; i = upper[i].parent) {
+                    if (upper[i].node->get() == target) return true;
+                }
+                return false;
+            };
+            auto path = [&]() {
+                vector<const TreeNode*> nodes;
+                for (int32_t i = upper[base].parent; i >= 0; i = upper[i].parent) {
+                    nodes.push_back(upper[i].node->get());
+                }
+                reverse(nodes.begin(), nodes.end());
+                for (const Frame& frame : frames) {
+                    nodes.push_back(frame.node->get());
+                }
+                return nodes;
+            };
+
+            frames.clear();
+            frames.push_back({upper[base].node, 0});
+            local.checkFolder(upper[base].node->get(), out);
+            while (!frames.empty()) {
+                Frame& top = frames.back();
+                const auto& children = (*top.node)->getChildren();
+                if (top.next >= children.size()) {
+                    frames.pop_back();
+                    continue;
+                }
+                const shared_ptr<TreeNode>& parentRef = *top.node;
+                const shared_ptr<TreeNode>& child = children[top.next++];
+                if (local.enter(child, parentRef, contains, path, out)) {
+                    local.checkFolder(child.get(), out);
+                    frames.push_back({&child, 0});
+                }
+            }
+        }
+    };
+
+    if (threads <= 1) {
+        worker();
+    } else {
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) w.join();
+    }
+
+    // Resultados en orden: primeros niveles y después cada subárbol
+    Findings all = std::move(upperFindings);
+    for (const auto& findings : taskFindings) {
+        all.merge(findings);
+    }
+
+    report.nodes = all.nodes;
+    report.folders = all.folders;
+    copy(all.counts, all.counts + ISSUE_TYPES, report.counts);
+    report.issues = std::move(all.issues);
+    report.threads = max(threads, 1u);
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+// 2. Descripción
+const char* TreeValidator::describe(IssueType type) {
+    switch (type) {
+        case IssueType::ROOT_HAS_PARENT: return "Raíz con padre";
+        case IssueType::ORPHAN: return "Nodos huérfanos";
+        case IssueType::PARENT_MISMATCH: return "Inconsistencias padre-hijo";
+        case IssueType::DUPLICATE_ID: return "IDs duplicados";
+        case IssueType::CYCLE: return "Ciclos";
+        case IssueType::ORDER_LABELS: return "Etiquetas de orden";
+        case IssueType::CHILD_INDEX: return "Índices de hijos";
+        case IssueType::DUPLICATE_NAME: return "Nombres duplicados (advertencia)";
+    }
+    return "";
+}
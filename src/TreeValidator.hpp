@@ -0,0 +1,61 @@
+#ifndef TREEVALIDATOR_HPP
+#define TREEVALIDATOR_HPP
+
+#include "TreeNode.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Validación del árbol en una sola pasada: en cada nodo se comprueban a la
+// vez el enlace al padre, la unicidad del ID (un bit por ID), los ciclos,
+// las etiquetas de orden, el índice de hijos y los nombres repetidos entre
+// hermanos. Los subárboles de los primeros niveles se reparten entre hilos.
+// Cada hilo recorre en profundidad con una pila de marcos (nodo, siguiente
+// hijo), que es a la vez el camino actual: detectar un ciclo solo necesita
+// memoria proporcional a la profundidad.
+class TreeValidator {
+public:
+    enum class IssueType {
+        ROOT_HAS_PARENT,    // La raíz tiene padre
+        ORPHAN,             // Nodo alcanzable con el enlace al padre vacío o caducado
+        PARENT_MISMATCH,    // El enlace al padre apunta a otro nodo
+        DUPLICATE_ID,       // ID repetido (o nodo compartido por dos padres)
+        CYCLE,              // El nodo es antecesor de sí mismo
+        ORDER_LABELS,       // Intervalo de orden fuera del de su padre
+        CHILD_INDEX,        // El índice de hijos no encuentra a un hijo
+        DUPLICATE_NAME      // Hermanos con el mismo nombre (advertencia)
+    };
+
+    struct Issue {
+        IssueType type;
+        int id;
+        string message;
+    };
+
+    struct Report {
+        size_t nodes;
+        size_t folders;
+        size_t counts[8];        // Problemas por IssueType
+        vector<Issue> issues;    // Detalle (como mucho MAX_ISSUES)
+        unsigned threads;
+        double seconds;
+
+        size_t count(IssueType type) const { return counts[static_cast<int>(type)]; }
+
+        // Los nombres repetidos no invalidan el árbol
+        bool valid() const;
+    };
+
+    static const size_t MAX_ISSUES = 100;
+
+    // 1. Validar el árbol bajo root. idLimit es una cota de los IDs (los
+    //    que la superen se comprueban aparte); threads = 0, uno por núcleo
+    static Report validate(const shared_ptr<TreeNode>& root, int idLimit, unsigned threads = 0);
+
+    // 2. Nombre legible de un tipo de problema
+    static const char* describe(IssueType type);
+};
+
+#endif // TREEVALIDATOR_HPP
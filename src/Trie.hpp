@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <algorithm>
+#include <functional>
 
 using namespace std;
 
@@ -50,6 +51,80 @@ private:
         }
     }
     
+    // Helper: nodo del Trie correspondiente a un prefijo (o nulo)
+    const TrieNode* findNode(const string& prefix) const {
+        const TrieNode* current = root.get();
+        for (char c : prefix) {
+            auto it = current->children.find(c);
+            if (it == current->children.end()) {
+                return nullptr;
+            }
+            current = it->second.get();
+        }
+        return current;
+    }
+    
+    // Helper: recorrido en orden reutilizando un único búfer para el nombre
+    bool visitWords(const TrieNode* node, string& word,
+                    const function<bool(const string&, const vector<int>&)>& visit) const {
+        if (node->isEndOfWord && !visit(word, node->nodeIds)) {
+            return false;
+        }
+        
+        for (const auto& pair : node->children) {
+            word.push_back(pair.first);
+            bool keepGoing = visitWords(pair.second.get(), word, visit);
+            word.pop_back();
+            if (!keepGoing) return false;
+        }
+        return true;
+    }
+    
+    // Helper: como visitWords pero empezando por la primera palabra >= from.
+    //         word es un prefijo propio de from (camino hacia from).
+    bool visitWordsFrom(const TrieNode* node, string& word, const string& from,
+                        const function<bool(const string&, const vector<int>&)>& visit) const {
+        if (word.size() == from.size()) {
+            return visitWords(node, word, visit);
+        }
+        
+        // La palabra de este nodo es menor que from: solo se bajan las ramas >= from
+        char next = from[word.size()];
+        for (auto it = node->children.lower_bound(next); it != node->children.end(); ++it) {
+            word.push_back(it->first);
+            bool keepGoing = it->first == next
+                ? visitWordsFrom(it->second.get(), word, from, visit)
+                : visitWords(it->second.get(), word, visit);
+            word.pop_back();
+            if (!keepGoing) return false;
+        }
+        return true;
+    }
+    
+    // Helper: recorrido guiado por un autómata (ver walkAutomaton)
+    template<typename Automaton>
+    void walkAutomatonFrom(const TrieNode* node, string& word, const Automaton& automaton,
+                           const typename Automaton::State& state,
+                           const function<void(const string&, const vector<int>&, int)>& visit) const {
+        if (node->isEndOfWord) {
+            int distance = automaton.accepts(state);
+            if (distance >= 0) {
+                visit(word, node->nodeIds, distance);
+            }
+        }
+        
+        typename Automaton::State next;
+        for (const auto& pair : node->children) {
+            // Rama podada: ninguna palabra bajo ella puede coincidir
+            if (!automaton.step(state, static_cast<unsigned char>(pair.first), next)) {
+                continue;
+            }
+            word.push_back(pair.first);
+            walkAutomatonFrom(pair.second.get(), word, automaton, next, visit);
+            word.pop_back();
+        }
+    }
+    
     // Helper para búsqueda recursiva de prefijo
     void findWordsWithPrefix(shared_ptr<TrieNode> node, string currentPrefix, 
                             vector<string>& results) {
@@ -70,8 +145,11 @@ private:
 public:
     Trie() : root(make_shared<TrieNode>()) {}
     
-    // 1. Insertar una palabra con su ID de nodo
-    void insert(const string& word, int nodeId) {
+    // 1. Insertar una palabra con su ID de nodo. Con newId el llamador sabe
+    //    que el ID aún no figura (nodo recién creado, índice vacío) y no se
+    //    recorre la lista: con nombres muy repetidos esa comprobación hace
+    //    cuadrática la indexación en bloque
+    void insert(const string& word, int nodeId, bool newId = false) {
         shared_ptr<TrieNode> current = root;
         
         for (char c : word) {
@@ -83,7 +161,7 @@ public:
         
         current->isEndOfWord = true;
         // Agregar el ID del nodo a la lista
-        if (find(current->nodeIds.begin(), current->nodeIds.end(), nodeId) == current->nodeIds.end()) {
+        if (newId || find(current->nodeIds.begin(), current->nodeIds.end(), nodeId) == current->nodeIds.end()) {
             current->nodeIds.push_back(nodeId);
         }
     }
@@ -226,6 +304,97 @@ public:
         
         return count;
     }
+    
+    // 9. Primeros caracteres de las palabras (ramas de la raíz)
+    vector<char> firstCharacters() const {
+        vector<char> characters;
+        for (const auto& pair : root->children) {
+            characters.push_back(pair.first);
+        }
+        return characters;
+    }
+    
+    // 10. Purgar de una rama los IDs muertos; las ramas vacías se podan.
+    //     Los IDs eliminados se añaden a purged (si no es nulo).
+    void purgeBranch(char c, const function<bool(int)>& isDead, vector<int>* purged = nullptr) {
+        auto it = root->children.find(c);
+        if (it != root->children.end() && purgeRecursive(it->second, isDead, purged)) {
+            root->children.erase(it);
+        }
+    }
+    
+    // Devuelve true si el nodo quedó vacío (sin IDs ni hijos)
+    bool purgeRecursive(shared_ptr<TrieNode> node, const function<bool(int)>& isDead,
+                        vector<int>* purged) {
+        if (!node->nodeIds.empty()) {
+            auto alive = remove_if(node->nodeIds.begin(), node->nodeIds.end(), [&](int id) {
+                if (isDead(id)) {
+                    if (purged) purged->push_back(id);
+                    return true;
+                }
+                return false;
+            });
+            node->nodeIds.erase(alive, node->nodeIds.end());
+            node->isEndOfWord = !node->nodeIds.empty();
+        }
+        
+        for (auto it = node->children.begin(); it != node->children.end();) {
+            if (purgeRecursive(it->second, isDead, purged)) {
+                it = node->children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        
+        return !node->isEndOfWord && node->children.empty();
+    }
+    
+    // 11. IDs de todas las palabras con un prefijo en una sola pasada, en
+    //     orden alfabético y sin reconstruir los nombres
+    void collectPostings(const string& prefix, vector<int>& ids) const {
+        const TrieNode* start = findNode(prefix);
+        if (!start) return;
+        
+        vector<const TrieNode*> pending = {start};
+        while (!pending.empty()) {
+            const TrieNode* node = pending.back();
+            pending.pop_back();
+            
+            ids.insert(ids.end(), node->nodeIds.begin(), node->nodeIds.end());
+            
+            // Apilar en orden inverso para visitar los hijos en orden
+            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+                pending.push_back(it->second.get());
+            }
+        }
+    }
+    
+    // 12. Recorrer en orden las palabras con un prefijo junto con sus IDs.
+    //     visit devuelve false para detener el recorrido. Con from se
+    //     reanuda en la primera palabra >= from, bajando solo por su camino.
+    void forEachWord(const string& prefix,
+                     const function<bool(const string&, const vector<int>&)>& visit,
+                     const string& from = "") const {
+        const TrieNode* start = findNode(prefix);
+        if (!start) return;
+        
+        string word = prefix;
+        if (from.size() > prefix.size() && from.compare(0, prefix.size(), prefix) == 0) {
+            visitWordsFrom(start, word, from, visit);
+        } else {
+            visitWords(start, word, visit);
+        }
+    }
+    
+    // 13. Recorrer en orden las palabras aceptadas por un autómata que
+    //     avanza byte a byte junto al Trie (start, step, accepts). Las ramas
+    //     que el autómata rechaza no se visitan.
+    template<typename Automaton>
+    void walkAutomaton(const Automaton& automaton,
+                       const function<void(const string&, const vector<int>&, int)>& visit) const {
+        string word;
+        walkAutomatonFrom(root.get(), word, automaton, automaton.start(), visit);
+    }
 };
 
 #endif // TRIE_HPP
\ No newline at end of file
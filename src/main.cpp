@@ -1,10 +1,113 @@
 // main.cpp - Punto de entrada principal del proyecto
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
 #include "ConsoleInterface.hpp"
+#include "DaemonServer.hpp"
 
 using namespace std;
 
-int main() {
+void printUsage() {
+    cout << "Uso: arboles_archivados [opciones]" << endl;
+    cout << "  (sin opciones)        Modo interactivo" << endl;
+    cout << "  --script <archivo>    Ejecutar comandos desde un archivo ('-' = stdin)" << endl;
+    cout << "  --batch               Ejecutar comandos desde stdin" << endl;
+    cout << "  --quiet               Silenciar mensajes por operación en modo por lotes" << endl;
+    cout << "  --serve <socket>      Servidor: atender clientes por un socket Unix" << endl;
+    cout << "  --client <socket>     Cliente ligero: enviar comandos de stdin al servidor" << endl;
+    cout << "  --loadtest <socket>   Prueba de carga contra un servidor en marcha" << endl;
+    cout << "    --connections <n>   Máximo de conexiones simultáneas (por defecto 64)" << endl;
+    cout << "    --requests <n>      Peticiones por conexión (por defecto 1000)" << endl;
+    cout << "    --command <cmd>     Comando a enviar (por defecto \"pwd\")" << endl;
+    cout << "  --help                Mostrar esta ayuda" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string scriptFile;
+    bool batch = false;
+    bool quiet = false;
+    string serveSocket;
+    string clientSocket;
+    string loadTestSocket;
+    int connections = 64;
+    int requests = 1000;
+    string loadCommand = "pwd";
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--script" && i + 1 < argc) {
+            scriptFile = argv[++i];
+            batch = true;
+        } else if (arg == "--batch") {
+            scriptFile = "-";
+            batch = true;
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serveSocket = argv[++i];
+        } else if (arg == "--client" && i + 1 < argc) {
+            clientSocket = argv[++i];
+        } else if (arg == "--loadtest" && i + 1 < argc) {
+            loadTestSocket = argv[++i];
+        } else if (arg == "--connections" && i + 1 < argc) {
+            connections = atoi(argv[++i]);
+        } else if (arg == "--requests" && i + 1 < argc) {
+            requests = atoi(argv[++i]);
+        } else if (arg == "--command" && i + 1 < argc) {
+            loadCommand = argv[++i];
+        } else if (arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            cerr << "Opción no reconocida: " << arg << endl;
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (!clientSocket.empty()) {
+        return runDaemonClient(clientSocket);
+    }
+    if (!loadTestSocket.empty()) {
+        return runDaemonLoadTest(loadTestSocket, connections, requests, loadCommand);
+    }
+    
+    // Modo servidor: un único árbol compartido por todas las sesiones
+    if (!serveSocket.empty()) {
+        try {
+            ConsoleInterface console;
+            DaemonServer server(console, serveSocket);
+            return server.run() ? 0 : 1;
+        } catch (const exception& e) {
+            cerr << "Error crítico: " << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    // Modo por lotes: sin banner ni prompt
+    if (batch) {
+        ios::sync_with_stdio(false);
+        
+        try {
+            ConsoleInterface console;
+            if (scriptFile == "-") {
+                console.runScript(cin, quiet);
+            } else {
+                ifstream script(scriptFile);
+                if (!script.is_open()) {
+                    cerr << "Error: No se pudo abrir el script " << scriptFile << endl;
+                    return 1;
+                }
+                console.runScript(script, quiet);
+            }
+        } catch (const exception& e) {
+            cerr << "Error crítico: " << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+    
     cout << "=========================================" << endl;
     cout << "    SISTEMA DE ARCHIVOS JERÁRQUICO" << endl;
     cout << "      Proyecto 1 - Estructura de Datos" << endl;
@@ -26,4 +129,4 @@ int main() {
     
     cout << "\nGracias por usar el sistema de archivos jerárquico!" << endl;
     return 0;
-}
\ No newline at end of file
+}
@@ -112,7 +112,7 @@ void testSearchEngine() {
     auto prefixResults = searcher.searchByPrefix("rep");
     cout << "   Encontrados: " << prefixResults.size() << " nodos" << endl;
     for (auto node : prefixResults) {
-        cout << "   - ID: " << node->id << ", Nombre: " << node->name 
+        cout << "   - ID: " << node->id << ", Nombre: " << node->getName() 
              << ", Ruta: " << tree->getFullPath(node) << endl;
     }
     
@@ -129,7 +129,7 @@ void testSearchEngine() {
     auto containsResults = searcher.searchContains("musica");
     cout << "   Encontrados: " << containsResults.size() << " nodos" << endl;
     for (auto node : containsResults) {
-        cout << "   - Nombre: " << node->name 
+        cout << "   - Nombre: " << node->getName() 
              << ", Ruta: " << tree->getFullPath(node) << endl;
     }
     